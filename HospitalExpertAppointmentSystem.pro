@@ -1,4 +1,4 @@
-QT       += core gui network
+QT       += core gui network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -11,25 +11,65 @@ CONFIG += c++11
 SOURCES += \
     adminDialog.cpp \
     aiChatDialog.cpp \
+    aiContextBuilder.cpp \
+    aiResponseCache.cpp \
     appointment.cpp \
+    appointmentArchive.cpp \
     appointmentManager.cpp \
+    availabilityCalendar.cpp \
+    availabilityIndex.cpp \
+    bloomFilter.cpp \
+    bulkExport.cpp \
+    bulkImport.cpp \
+    campaignScheduler.cpp \
+    chatBubbleDelegate.cpp \
+    chatMessageModel.cpp \
+    conversationMemory.cpp \
+    departmentRecommender.cpp \
     expert.cpp \
     expertDialog.cpp \
     expertManager.cpp \
+    integrityChecker.cpp \
+    jsonImport.cpp \
+    localIntentMatcher.cpp \
     main.cpp \
     mainwindow.cpp \
     patientDialog.cpp \
+    retentionManager.cpp \
+    sseParser.cpp \
+    timeSlotIndex.cpp \
+    visitHistory.cpp \
 
 HEADERS += \
     adminDialog.h \
     aiChatDialog.h \
+    aiContextBuilder.h \
+    aiResponseCache.h \
     appointment.h \
+    appointmentArchive.h \
     appointmentManager.h \
+    availabilityCalendar.h \
+    availabilityIndex.h \
+    bloomFilter.h \
+    bulkExport.h \
+    bulkImport.h \
+    campaignScheduler.h \
+    chatBubbleDelegate.h \
+    chatMessageModel.h \
+    conversationMemory.h \
+    departmentRecommender.h \
     expert.h \
     expertDialog.h \
     expertManager.h \
+    integrityChecker.h \
+    jsonImport.h \
+    localIntentMatcher.h \
     mainwindow.h \
-    patientDialog.h
+    patientDialog.h \
+    retentionManager.h \
+    sseParser.h \
+    timeSlotIndex.h \
+    visitHistory.h
 
 FORMS += \
     adminDialog.ui \
@@ -40,6 +80,8 @@ FORMS += \
 
 RESOURCES += resources.qrc
 
+include(inputValidator.pri)
+
 LIBS += -L$$PWD/bin/ -llibcrypto-1_1-x64 -llibssl-1_1-x64
 
 # Default rules for deployment.
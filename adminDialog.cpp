@@ -1,27 +1,43 @@
 #include "adminDialog.h"
 
 #include <QAbstractItemView>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QCoreApplication>
+#include <QDateEdit>
 #include <QDebug>
+#include <QDialogButtonBox>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileDialog>
 #include <QFormLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QInputDialog>
+#include <QLabel>
 #include <QLineEdit>
+#include <QListWidget>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QSet>
+#include <QSettings>
 #include <QTableWidget>
 #include <QTableWidgetItem>
 #include <QTextStream>
 #include <QVBoxLayout>
 #include <algorithm>
 
+#include "appointmentArchive.h"
+#include "availabilityIndex.h"
+#include "bulkExport.h"
+#include "bulkImport.h"
+#include "campaignScheduler.h"
+#include "inputValidator.h"
+#include "integrityChecker.h"
 #include "mainwindow.h"
 #include "patientDialog.h"
+#include "timeSlotIndex.h"
 #include "ui_adminDialog.h"
 
 AdminDialog::AdminDialog(ExpertManager* expertMgr,
@@ -36,16 +52,20 @@ AdminDialog::AdminDialog(ExpertManager* expertMgr,
   setupTable();
   loadAppointments();
 
-  // 初始化验证对话框（不显示，仅用于验证）
-  validatorDialog = new PatientDialog(expertMgr, appointmentMgr, this);
-  validatorDialog->hide();
+  // 关键字查询只覆盖预约数据，已归档的历史预约需在就诊记录中查看
+  if (!archiveNote().isEmpty()) {
+    ui->searchLineEdit->setPlaceholderText("请输入查询内容（不含已归档预约）");
+    ui->searchLineEdit->setToolTip(archiveNote());
+  }
 }
 
-AdminDialog::~AdminDialog() {
-  delete validatorDialog;
-  delete ui;
+QString AdminDialog::archiveNote() const {
+  AppointmentArchive* archive = mainWindow ? mainWindow->getArchive() : nullptr;
+  return archive ? archive->exclusionNote() : QString();
 }
 
+AdminDialog::~AdminDialog() { delete ui; }
+
 void AdminDialog::setupUI() {
   QFile styleFile(":/styles/application.qss");
 
@@ -283,38 +303,10 @@ void AdminDialog::on_addAppointmentBtn_clicked() {
   }
 
   // 以管理员身份弹出患者预约对话框
-  PatientDialog dlg(expertManager, appointmentManager, this);
+  PatientDialog dlg(expertManager, appointmentManager, nullptr, this);
   dlg.setWindowTitle("管理员添加预约");
+  // 身份证号唯一性、出诊与容量由 addAppointments 在写入时统一校验
   if (dlg.exec() == QDialog::Accepted) {
-    // 检查身份证号是否出现重复（若出现，保留第一条，删除后续重复记录）
-    const auto& appts = appointmentManager->getAllAppointments();
-    QMap<QString, QList<int>> positions;
-    for (int i = 0; i < appts.size(); ++i) {
-      positions[appts[i].idNumber].append(i);
-    }
-
-    QList<int> toRemove;
-    for (auto it = positions.constBegin(); it != positions.constEnd(); ++it) {
-      const QList<int>& idxs = it.value();
-      if (idxs.size() > 1) {
-        for (int k = 1; k < idxs.size(); ++k)
-          toRemove.append(idxs[k]);  // 保留第一个，删除其余
-      }
-    }
-
-    if (!toRemove.isEmpty()) {
-      // 从大到小删除，避免下标错位
-      std::sort(toRemove.begin(), toRemove.end(), std::greater<int>());
-      for (int idx : toRemove) {
-        appointmentManager->removeAppointment(idx);
-      }
-      loadAppointments();
-      QMessageBox::warning(
-          this, "错误",
-          "检测到重复身份证号的预约记录，已移除重复项。请重新添加。");
-      return;
-    }
-
     loadAppointments();
     QMessageBox::information(this, "成功", "预约添加成功！");
   }
@@ -413,23 +405,39 @@ void AdminDialog::on_searchBtn_clicked() {
   }
 
   // 查询逻辑
+  auto matches = [&](const Appointment& appt) {
+    if (type == 0) {
+      return appt.expertName.contains(keyword, Qt::CaseInsensitive);
+    }
+    if (type == 1) {
+      return appt.patientName.contains(keyword, Qt::CaseInsensitive);
+    }
+    return type == 2 && appt.phone.contains(keyword, Qt::CaseInsensitive);
+  };
   const auto& appointments = appointmentManager->getAllAppointments();
   QVector<int> matchedRows;
   for (int i = 0; i < appointments.size(); ++i) {
-    const auto& appt = appointments[i];
-    bool match = false;
-    if (type == 0 && appt.expertName.contains(keyword, Qt::CaseInsensitive))
-      match = true;
-    if (type == 1 && appt.patientName.contains(keyword, Qt::CaseInsensitive))
-      match = true;
-    if (type == 2 && appt.phone.contains(keyword, Qt::CaseInsensitive))
-      match = true;
-    if (match) matchedRows.append(i);
-  }
-
-  ui->appointmentTable->setRowCount(matchedRows.size());
-  for (int row = 0; row < matchedRows.size(); ++row) {
-    const auto& appt = appointments[matchedRows[row]];
+    if (matches(appointments[i])) matchedRows.append(i);
+  }
+
+  // 关键字查询不限日期：未载入的历史分区逐个从磁盘读取匹配，不载入内存，
+  // 结果排在后面且只读
+  QList<Appointment> historyMatches;
+  for (const QString& month :
+       appointmentManager->unloadedMonths(QDate(), QDate())) {
+    for (const Appointment& appt :
+         appointmentManager->readUnloadedPartition(month)) {
+      if (matches(appt)) historyMatches.append(appt);
+    }
+  }
+
+  int rowCount = matchedRows.size() + historyMatches.size();
+  ui->appointmentTable->setRowCount(rowCount);
+  for (int row = 0; row < rowCount; ++row) {
+    bool history = row >= matchedRows.size();
+    const Appointment& appt = history
+                                  ? historyMatches[row - matchedRows.size()]
+                                  : appointments[matchedRows[row]];
     ui->appointmentTable->setItem(row, 0,
                                   new QTableWidgetItem(appt.patientName));
     ui->appointmentTable->setItem(row, 1, new QTableWidgetItem(appt.idNumber));
@@ -451,6 +459,17 @@ void AdminDialog::on_searchBtn_clicked() {
     ui->appointmentTable->setItem(
         row, 10, new QTableWidgetItem(QString::number(appt.queueNumber)));
 
+    // 历史分区中的预约不在内存中，只读显示，不提供删除
+    if (history) {
+      for (int column = 0; column <= 10; ++column) {
+        QTableWidgetItem* item = ui->appointmentTable->item(row, column);
+        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+        item->setToolTip("历史分区中的预约（只读）");
+      }
+      ui->appointmentTable->item(row, 0)->setData(Qt::UserRole, -1);
+      continue;
+    }
+
     // 存储原始预约索引到第一列项的用户数据中
     if (ui->appointmentTable->item(row, 0)) {
       ui->appointmentTable->item(row, 0)->setData(Qt::UserRole,
@@ -558,7 +577,7 @@ void AdminDialog::onItemChanged(QTableWidgetItem* item) {
     needUpdateAppointment = true;
 
   } else if (col == 1) {  // 修改身份证号
-    if (!validatorDialog->isValidIdNumber(newValue)) {
+    if (!InputValidator::isValidIdNumber(newValue)) {
       QMessageBox::warning(this, "错误", "身份证号无效！");
       // 恢复原值
       item->setText(originalAppointment.idNumber);
@@ -569,8 +588,8 @@ void AdminDialog::onItemChanged(QTableWidgetItem* item) {
     }
 
     // 自动更新性别和年龄
-    QString gender = validatorDialog->getGenderFromId(newValue);
-    int age = validatorDialog->getAgeFromId(newValue);
+    QString gender = InputValidator::genderFromIdNumber(newValue);
+    int age = InputValidator::ageFromIdNumber(newValue);
 
     ui->appointmentTable->item(row, 2)->setText(gender);
     ui->appointmentTable->item(row, 3)->setText(QString::number(age));
@@ -581,7 +600,7 @@ void AdminDialog::onItemChanged(QTableWidgetItem* item) {
     needUpdateAppointment = true;
 
   } else if (col == 5) {  // 修改电话号码
-    if (!validatorDialog->isValidPhoneNumber(newValue)) {
+    if (!InputValidator::isValidPhoneNumber(newValue)) {
       QMessageBox::warning(this, "错误", "请输入有效的电话号码！");
       item->setText(originalAppointment.phone);  // 恢复原值
       connect(ui->appointmentTable, &QTableWidget::itemChanged, this,
@@ -768,15 +787,97 @@ void AdminDialog::on_exportAppointmentBtn_clicked() {
   QString defaultDir = QDir::homePath();
   QString appointmentFilename = QFileDialog::getSaveFileName(
       this, "导出预约数据", defaultDir + "/appointments.json",
-      "JSON文件 (*.json);;所有文件 (*)");
-
-  if (!appointmentFilename.isEmpty()) {
-    if (appointmentManager->saveToFile(appointmentFilename)) {
-      QMessageBox::information(this, "成功", "预约数据导出成功！");
+      "JSON文件 (*.json);;CSV文件 (*.csv);;NDJSON文件 (*.ndjson);;"
+      "压缩CSV (*.csv.qz);;压缩NDJSON (*.ndjson.qz);;所有文件 (*)");
+
+  if (appointmentFilename.isEmpty()) return;
+
+  if (appointmentFilename.endsWith(".json", Qt::CaseInsensitive)) {
+    // JSON 导出全部预约（含历史分区，直接从磁盘读出，不载入内存）
+    BulkExporter exporter(appointmentManager);
+    int exported = 0;
+    QString error;
+    if (exporter.exportToFile(appointmentFilename,
+                              ExportOptions::fromFilename(appointmentFilename),
+                              &exported, &error)) {
+      QString note = archiveNote();
+      QMessageBox::information(
+          this, "成功",
+          note.isEmpty() ? QString("预约数据导出成功！")
+                         : "预约数据导出成功！\n" + note);
     } else {
-      QMessageBox::warning(this, "失败", "预约数据导出失败！");
+      QMessageBox::warning(this, "失败", "预约数据导出失败：" + error);
+    }
+    return;
+  }
+
+  // CSV / NDJSON 流式导出，可按日期范围与科室筛选
+  ExportOptions options = ExportOptions::fromFilename(appointmentFilename);
+
+  QDialog* filterDialog = new QDialog(this);
+  filterDialog->setWindowTitle("导出筛选");
+  filterDialog->setModal(true);
+
+  QFormLayout* form = new QFormLayout(filterDialog);
+  QDate today = QDate::currentDate();
+  QCheckBox* rangeCheck = new QCheckBox("仅导出以下日期范围");
+  QDateEdit* fromEdit = new QDateEdit(today);
+  fromEdit->setCalendarPopup(true);
+  fromEdit->setEnabled(false);
+  QDateEdit* toEdit = new QDateEdit(today);
+  toEdit->setCalendarPopup(true);
+  toEdit->setEnabled(false);
+  connect(rangeCheck, &QCheckBox::toggled, fromEdit, &QWidget::setEnabled);
+  connect(rangeCheck, &QCheckBox::toggled, toEdit, &QWidget::setEnabled);
+
+  QComboBox* departmentCombo = new QComboBox();
+  departmentCombo->addItem("全部科室", QString());
+  QStringList departments;
+  for (const auto& expert : expertManager->experts) {
+    if (!departments.contains(expert.subject)) {
+      departments.append(expert.subject);
     }
   }
+  for (const QString& dept : departments) {
+    departmentCombo->addItem(dept, dept);
+  }
+
+  QDialogButtonBox* buttons =
+      new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+  form->addRow(rangeCheck);
+  form->addRow("开始日期:", fromEdit);
+  form->addRow("结束日期:", toEdit);
+  form->addRow("科室:", departmentCombo);
+  form->addRow(buttons);
+  connect(buttons, &QDialogButtonBox::accepted, filterDialog,
+          &QDialog::accept);
+  connect(buttons, &QDialogButtonBox::rejected, filterDialog,
+          &QDialog::reject);
+
+  bool accepted = filterDialog->exec() == QDialog::Accepted;
+  if (accepted) {
+    if (rangeCheck->isChecked()) {
+      options.fromDate = fromEdit->date();
+      options.toDate = toEdit->date();
+    }
+    options.department = departmentCombo->currentData().toString();
+  }
+  delete filterDialog;
+  if (!accepted) return;
+
+  BulkExporter exporter(appointmentManager);
+  int exported = 0;
+  QString error;
+  if (exporter.exportToFile(appointmentFilename, options, &exported,
+                            &error)) {
+    QString note = archiveNote();
+    QMessageBox::information(
+        this, "成功",
+        QString("已导出 %1 条预约数据！").arg(exported) +
+            (note.isEmpty() ? QString() : "\n" + note));
+  } else {
+    QMessageBox::warning(this, "失败", "预约数据导出失败：" + error);
+  }
 }
 
 void AdminDialog::on_exportExpertBtn_clicked() {
@@ -796,14 +897,31 @@ void AdminDialog::on_exportExpertBtn_clicked() {
 
 // 导入数据
 void AdminDialog::on_importDataBtn_clicked() {
-  int result = QMessageBox::question(
-      this, "导入确认", "导入数据将覆盖当前所有数据，确定要继续吗？",
-      QMessageBox::Yes | QMessageBox::No);
-
-  if (result != QMessageBox::Yes) {
+  // 选择导入方式：合并保留现有数据，覆盖则整体替换
+  QMessageBox modeBox(QMessageBox::Question, "导入方式",
+                      "合并导入：按专家编号/预约信息新增或更新，保留现有数据\n"
+                      "覆盖导入：用文件内容替换当前所有数据",
+                      QMessageBox::Cancel, this);
+  QPushButton* mergeBtn =
+      modeBox.addButton("合并导入", QMessageBox::AcceptRole);
+  QPushButton* replaceBtn =
+      modeBox.addButton("覆盖导入", QMessageBox::DestructiveRole);
+  modeBox.exec();
+  bool merge = modeBox.clickedButton() == mergeBtn;
+  if (!merge && modeBox.clickedButton() != replaceBtn) {
     return;
   }
 
+  if (!merge) {
+    int result = QMessageBox::question(
+        this, "导入确认", "导入数据将覆盖当前所有数据，确定要继续吗？",
+        QMessageBox::Yes | QMessageBox::No);
+
+    if (result != QMessageBox::Yes) {
+      return;
+    }
+  }
+
   // 阻塞表格信号，防止导入过程中触发 itemChanged
   ui->appointmentTable->blockSignals(true);
 
@@ -812,8 +930,15 @@ void AdminDialog::on_importDataBtn_clicked() {
       this, "导入专家数据", defaultDir, "JSON文件 (*.json);;所有文件 (*)");
 
   if (!expertFilename.isEmpty()) {
-    if (expertManager->loadFromFile(expertFilename)) {
-      QMessageBox::information(this, "成功", "专家数据导入成功！");
+    MergeSummary summary;
+    bool imported =
+        merge ? expertManager->mergeFromFile(expertFilename, &summary)
+              : expertManager->loadFromFile(expertFilename);
+    if (imported) {
+      QMessageBox::information(
+          this, "成功",
+          merge ? "专家数据合并完成！\n" + summary.toText()
+                : QString("专家数据导入成功！"));
     } else {
       QMessageBox::warning(this, "失败", "专家数据导入失败！");
       ui->appointmentTable->blockSignals(false);
@@ -825,10 +950,18 @@ void AdminDialog::on_importDataBtn_clicked() {
       this, "导入预约数据", defaultDir, "JSON文件 (*.json);;所有文件 (*)");
 
   if (!appointmentFilename.isEmpty()) {
-    if (appointmentManager->loadFromFile(appointmentFilename)) {
+    MergeSummary summary;
+    bool imported =
+        merge ? appointmentManager->mergeFromFile(appointmentFilename,
+                                                  expertManager, &summary)
+              : appointmentManager->loadFromFile(appointmentFilename);
+    if (imported) {
       // 重新加载预约表格
       loadAppointments();
-      QMessageBox::information(this, "成功", "预约数据导入成功！");
+      QMessageBox::information(
+          this, "成功",
+          merge ? "预约数据合并完成！\n" + summary.toText()
+                : QString("预约数据导入成功！"));
     } else {
       QMessageBox::warning(this, "失败", "预约数据导入失败！");
     }
@@ -838,6 +971,601 @@ void AdminDialog::on_importDataBtn_clicked() {
   ui->appointmentTable->blockSignals(false);
 }
 
+// 空闲专家查询：按科室与日期查看仍有余号的专家
+void AdminDialog::on_freeExpertsBtn_clicked() {
+  AvailabilityIndex* index =
+      mainWindow ? mainWindow->getAvailabilityIndex() : nullptr;
+  if (!index) {
+    QMessageBox::warning(this, "错误", "余号索引未初始化！");
+    return;
+  }
+
+  QDialog* queryDialog = new QDialog(this);
+  queryDialog->setWindowTitle("空闲专家查询");
+  queryDialog->setModal(true);
+  queryDialog->resize(400, 480);
+
+  QVBoxLayout* layout = new QVBoxLayout(queryDialog);
+  QFormLayout* form = new QFormLayout();
+
+  QComboBox* departmentCombo = new QComboBox();
+  departmentCombo->addItem("全部科室", QString());
+  QStringList departments;
+  for (const auto& expert : expertManager->experts) {
+    if (!departments.contains(expert.subject)) {
+      departments.append(expert.subject);
+    }
+  }
+  for (const QString& dept : departments) {
+    departmentCombo->addItem(dept, dept);
+  }
+
+  QDate today = QDate::currentDate();
+  QDateEdit* dateEdit = new QDateEdit(today);
+  dateEdit->setCalendarPopup(true);
+  dateEdit->setMinimumDate(today);
+  dateEdit->setMaximumDate(today.addDays(index->horizonDays() - 1));
+
+  form->addRow("科室:", departmentCombo);
+  form->addRow("日期:", dateEdit);
+  layout->addLayout(form);
+
+  QLabel* summaryLabel = new QLabel();
+  QListWidget* resultList = new QListWidget();
+  layout->addWidget(summaryLabel);
+  layout->addWidget(resultList);
+
+  QPushButton* closeBtn = new QPushButton("关闭");
+  layout->addWidget(closeBtn);
+
+  auto runQuery = [=]() {
+    QString department = departmentCombo->currentData().toString();
+    QDate date = dateEdit->date();
+
+    QElapsedTimer timer;
+    timer.start();
+    QStringList names = index->freeExperts(date, department);
+    qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+
+    resultList->clear();
+    resultList->addItems(names);
+    summaryLabel->setText(
+        QString("%1 %2 仍有余号的专家：%3 位（查询耗时 %4 微秒）")
+            .arg(date.toString("yyyy-MM-dd"))
+            .arg(departmentCombo->currentText())
+            .arg(names.size())
+            .arg(elapsedUs));
+  };
+
+  connect(departmentCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          queryDialog, runQuery);
+  connect(dateEdit, &QDateEdit::dateChanged, queryDialog, runQuery);
+  connect(closeBtn, &QPushButton::clicked, queryDialog, &QDialog::accept);
+
+  runQuery();
+  queryDialog->exec();
+  delete queryDialog;
+}
+
+// 规范化排班：合并所有专家每天内互相重叠的时间段，并批量迁移受影响的预约
+void AdminDialog::on_normalizeSchedulesBtn_clicked() {
+  if (!expertManager || !appointmentManager) {
+    QMessageBox::warning(this, "错误", "数据管理器未初始化！");
+    return;
+  }
+
+  // 先为每位专家计算合并方案
+  QHash<QString, QList<TimeSlotIndex::MergeGroup>> plans;
+  for (const auto& expert : expertManager->experts) {
+    QList<TimeSlotIndex::MergeGroup> groups =
+        TimeSlotIndex::planMerges(expert.serviceTimes);
+    if (groups.isEmpty()) continue;
+    plans.insert(expert.name, groups);
+  }
+
+  if (plans.isEmpty()) {
+    QMessageBox::information(this, "提示", "所有专家的排班均无重叠时间段。");
+    return;
+  }
+
+  int ret = QMessageBox::question(
+      this, "确认",
+      QString("共有 %1 位专家存在重叠时间段，是否全部合并？").arg(plans.size()),
+      QMessageBox::Yes | QMessageBox::No);
+  if (ret != QMessageBox::Yes) return;
+
+  // 容量只约束今天及以后的预约；未载入的历史分区不载入，其中的预约
+  // 由 remapServiceTimes 记下改名，分区载入时再迁移
+  QDate today = QDate::currentDate();
+  int mergedGroups = 0;
+  QStringList skipped;
+  QHash<QString, QHash<QString, QString>> renamesByExpert;
+  for (auto& expert : expertManager->experts) {
+    auto planIt = plans.constFind(expert.name);
+    if (planIt == plans.constEnd()) continue;
+
+    QHash<QString, QString>& renames = renamesByExpert[expert.name];
+    for (const auto& group : planIt.value()) {
+      int maxCapacity = 0;
+      for (const QString& source : group.sources) {
+        maxCapacity = qMax(maxCapacity, expert.getTimeSlotCapacity(source));
+      }
+
+      // 合并后今后任意一天的预约人数超过容量则跳过该组（按专家时间段
+      // 索引统计）
+      if (appointmentManager->peakDailyOccupancy(expert.name, group.sources,
+                                                 today) > maxCapacity) {
+        skipped.append(QString("%1 %2").arg(expert.name).arg(group.merged));
+        continue;
+      }
+
+      for (const QString& source : group.sources) {
+        expert.serviceTimes.removeAll(source);
+        expert.removeTimeSlotCapacity(source);
+        renames.insert(source, group.merged);
+      }
+      expert.serviceTimes.append(group.merged);
+      expert.setTimeSlotCapacity(group.merged, maxCapacity);
+      mergedGroups++;
+    }
+  }
+
+  // 所有专家的时间段迁移一次完成
+  int movedAppointments =
+      appointmentManager->remapServiceTimes(renamesByExpert);
+
+  loadAppointments();
+
+  QString message = QString("已合并 %1 组重叠时间段，迁移预约 %2 个。")
+                        .arg(mergedGroups)
+                        .arg(movedAppointments);
+  if (appointmentManager->hasUnloadedPartitions()) {
+    message += "\n历史分区中的预约将在分区载入时迁移。";
+  }
+  if (!skipped.isEmpty()) {
+    message += QString("\n\n以下时间段合并后超出容量，已跳过：\n%1")
+                   .arg(skipped.join("\n"));
+  }
+  QMessageBox::information(this, "规范化排班", message);
+}
+
+// 批量停诊：为选定专家设置一段日期停诊，并可将受影响的预约顺延改约
+void AdminDialog::on_holidayClosureBtn_clicked() {
+  if (!expertManager || !appointmentManager) {
+    QMessageBox::warning(this, "错误", "数据管理器未初始化！");
+    return;
+  }
+
+  QDialog* closureDialog = new QDialog(this);
+  closureDialog->setWindowTitle("批量停诊");
+  closureDialog->setModal(true);
+  closureDialog->resize(400, 520);
+
+  QVBoxLayout* layout = new QVBoxLayout(closureDialog);
+  QFormLayout* form = new QFormLayout();
+
+  QDate today = QDate::currentDate();
+  QDateEdit* fromEdit = new QDateEdit(today);
+  fromEdit->setCalendarPopup(true);
+  fromEdit->setMinimumDate(today);
+  QDateEdit* toEdit = new QDateEdit(today);
+  toEdit->setCalendarPopup(true);
+  toEdit->setMinimumDate(today);
+
+  QComboBox* departmentCombo = new QComboBox();
+  departmentCombo->addItem("全部科室", QString());
+  QStringList departments;
+  for (const auto& expert : expertManager->experts) {
+    if (!departments.contains(expert.subject)) {
+      departments.append(expert.subject);
+    }
+  }
+  for (const QString& dept : departments) {
+    departmentCombo->addItem(dept, dept);
+  }
+
+  form->addRow("开始日期:", fromEdit);
+  form->addRow("结束日期:", toEdit);
+  form->addRow("科室:", departmentCombo);
+  layout->addLayout(form);
+
+  QListWidget* expertList = new QListWidget();
+  for (const auto& expert : expertManager->experts) {
+    QListWidgetItem* item = new QListWidgetItem(
+        QString("%1（%2）").arg(expert.name).arg(expert.subject));
+    item->setData(Qt::UserRole, expert.name);
+    item->setData(Qt::UserRole + 1, expert.subject);
+    item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+    item->setCheckState(Qt::Checked);
+    expertList->addItem(item);
+  }
+  layout->addWidget(new QLabel("停诊专家:"));
+  layout->addWidget(expertList);
+
+  QCheckBox* rescheduleCheck =
+      new QCheckBox("将受影响的预约改约到该专家下一个可预约时间段");
+  rescheduleCheck->setChecked(true);
+  layout->addWidget(rescheduleCheck);
+
+  QDialogButtonBox* buttons =
+      new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+  layout->addWidget(buttons);
+
+  // 切换科室时勾选该科室的全部专家
+  connect(departmentCombo,
+          QOverload<int>::of(&QComboBox::currentIndexChanged), closureDialog,
+          [=]() {
+            QString department = departmentCombo->currentData().toString();
+            for (int i = 0; i < expertList->count(); ++i) {
+              QListWidgetItem* item = expertList->item(i);
+              bool match = department.isEmpty() ||
+                           item->data(Qt::UserRole + 1).toString() ==
+                               department;
+              item->setCheckState(match ? Qt::Checked : Qt::Unchecked);
+            }
+          });
+  connect(buttons, &QDialogButtonBox::accepted, closureDialog,
+          &QDialog::accept);
+  connect(buttons, &QDialogButtonBox::rejected, closureDialog,
+          &QDialog::reject);
+
+  if (closureDialog->exec() != QDialog::Accepted) {
+    delete closureDialog;
+    return;
+  }
+
+  QDate fromDate = fromEdit->date();
+  QDate toDate = toEdit->date();
+  bool reschedule = rescheduleCheck->isChecked();
+  QSet<QString> selectedExperts;
+  for (int i = 0; i < expertList->count(); ++i) {
+    QListWidgetItem* item = expertList->item(i);
+    if (item->checkState() == Qt::Checked) {
+      selectedExperts.insert(item->data(Qt::UserRole).toString());
+    }
+  }
+  delete closureDialog;
+
+  if (fromDate > toDate) {
+    QMessageBox::warning(this, "错误", "开始日期不能晚于结束日期！");
+    return;
+  }
+  if (selectedExperts.isEmpty()) {
+    QMessageBox::warning(this, "错误", "请至少选择一位专家！");
+    return;
+  }
+
+  // 设置停诊日期
+  int closedDays = 0;
+  for (auto& expert : expertManager->experts) {
+    if (!selectedExperts.contains(expert.name)) continue;
+    for (QDate date = fromDate; date <= toDate; date = date.addDays(1)) {
+      if (expert.closeOnDate(date)) closedDays++;
+    }
+  }
+
+  // 通过日期索引找出停诊期间受影响的预约，按日期与排队号排序
+  QVector<int> affected;
+  const QList<Appointment>& appointments =
+      appointmentManager->getAllAppointments();
+  for (QDate date = fromDate; date <= toDate; date = date.addDays(1)) {
+    for (int index : appointmentManager->appointmentIndexesOn(date)) {
+      if (selectedExperts.contains(appointments[index].expertName)) {
+        affected.append(index);
+      }
+    }
+  }
+  std::sort(affected.begin(), affected.end(), [&](int a, int b) {
+    const Appointment& lhs = appointments[a];
+    const Appointment& rhs = appointments[b];
+    if (lhs.appointmentDate != rhs.appointmentDate) {
+      return lhs.appointmentDate < rhs.appointmentDate;
+    }
+    return lhs.queueNumber < rhs.queueNumber;
+  });
+
+  // 依次为受影响的预约寻找停诊结束后该专家第一个仍有余号的时间段
+  QSettings settings("HospitalApp", "AppointmentSystem");
+  int horizonDays = settings.value("availabilityHorizonDays", 60).toInt();
+  QDate searchStart = qMax(toDate.addDays(1), today);
+  QHash<int, Appointment> updates;
+  QHash<QString, int> pending;  // 专家+日期+时间段 -> 本次新改入人数
+  QHash<QString, int> lastQueueNumbers;  // 专家+日期+时间段 -> 最大排队号
+  QStringList movedLines;
+  QStringList unmovedLines;
+  for (int index : affected) {
+    const Appointment& original = appointments[index];
+    QString line = QString("%1 %2 %3 %4")
+                       .arg(original.patientName)
+                       .arg(original.expertName)
+                       .arg(original.appointmentDate.toString("yyyy-MM-dd"))
+                       .arg(original.serviceTime);
+    Expert* expert = expertManager->findExpertByName(original.expertName);
+    if (!reschedule || !expert) {
+      unmovedLines.append(line);
+      continue;
+    }
+
+    QString originalTime = original.serviceTime.section("：", 1);
+    bool moved = false;
+    for (int day = 0; day < horizonDays && !moved; ++day) {
+      QDate date = searchStart.addDays(day);
+      if (!expert->isAvailableOnDate(date)) continue;
+
+      // 优先保留原来的时间，其次按排班顺序
+      QStringList daySlots = expert->getAvailableTimeSlotsForDate(date);
+      std::stable_partition(
+          daySlots.begin(), daySlots.end(), [&](const QString& slot) {
+            return slot.section("：", 1) == originalTime;
+          });
+
+      for (const QString& slot : daySlots) {
+        QString key = expert->name + "|" +
+                      QString::number(date.toJulianDay()) + "|" + slot;
+        int occupied =
+            appointmentManager->getSlotOccupancy(expert->name, date, slot) +
+            pending.value(key, 0);
+        if (occupied >= expert->getTimeSlotCapacity(slot)) continue;
+
+        // 取消预约后排队号可能不连续，新号接在该时间段已有的最大号之后
+        auto last = lastQueueNumbers.find(key);
+        if (last == lastQueueNumbers.end()) {
+          int existing =
+              appointmentManager->maxQueueNumber(expert->name, date, slot);
+          last = lastQueueNumbers.insert(key, existing);
+        }
+
+        Appointment updated = original;
+        updated.appointmentDate = date;
+        updated.serviceTime = slot;
+        updated.queueNumber = ++last.value();
+        updates.insert(index, updated);
+        pending[key]++;
+        movedLines.append(QString("%1 -> %2 %3")
+                              .arg(line)
+                              .arg(date.toString("yyyy-MM-dd"))
+                              .arg(slot));
+        moved = true;
+        break;
+      }
+    }
+    if (!moved) unmovedLines.append(line);
+  }
+
+  // 一次批量改约，一次落盘
+  appointmentManager->updateAppointments(updates);
+  bool saved = mainWindow ? mainWindow->saveData() : true;
+  loadAppointments();
+
+  QString summary =
+      QString("已为 %1 位专家设置停诊 %2 天次。\n"
+              "受影响预约 %3 个：已改约 %4 个，未改约 %5 个。")
+          .arg(selectedExperts.size())
+          .arg(closedDays)
+          .arg(affected.size())
+          .arg(movedLines.size())
+          .arg(unmovedLines.size());
+  if (!saved) summary += "\n\n警告：数据保存失败！";
+
+  QString details;
+  if (!movedLines.isEmpty()) {
+    details += "已改约：\n" + movedLines.join("\n") + "\n\n";
+  }
+  if (!unmovedLines.isEmpty()) {
+    details += "未改约（请联系患者）：\n" + unmovedLines.join("\n");
+  }
+
+  QMessageBox report(QMessageBox::Information, "批量停诊报告", summary,
+                     QMessageBox::Ok, this);
+  if (!details.isEmpty()) report.setDetailedText(details);
+  report.exec();
+}
+
+// 筛查活动批量预约：读取患者名单，按意向日期一次性分配并批量写入
+void AdminDialog::on_campaignBookingBtn_clicked() {
+  if (!expertManager || !appointmentManager) {
+    QMessageBox::warning(this, "错误", "数据管理器未初始化！");
+    return;
+  }
+
+  QString filename = QFileDialog::getOpenFileName(
+      this, "选择患者名单", QDir::homePath(),
+      "CSV文件 (*.csv *.txt);;所有文件 (*)");
+  if (filename.isEmpty()) return;
+
+  QStringList departments;
+  departments << "全部科室";
+  for (const auto& expert : expertManager->experts) {
+    if (!departments.contains(expert.subject)) {
+      departments.append(expert.subject);
+    }
+  }
+  bool ok = false;
+  QString department = QInputDialog::getItem(this, "筛查批量预约", "预约科室:",
+                                             departments, 0, false, &ok);
+  if (!ok) return;
+  if (department == "全部科室") department.clear();
+
+  QList<CampaignPatient> patients;
+  QString error;
+  if (!CampaignScheduler::loadPatients(filename, &patients, &error)) {
+    QMessageBox::warning(this, "失败", error);
+    return;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  CampaignScheduler scheduler(expertManager, appointmentManager);
+  QList<CampaignOutcome> outcomes = scheduler.assign(patients, department);
+  qint64 elapsedMs = qMax<qint64>(1, timer.elapsed());
+
+  QList<Appointment> batch;
+  for (const auto& outcome : outcomes) {
+    if (outcome.assigned) batch.append(outcome.appointment);
+  }
+
+  // 一次批量校验并写入，一次落盘
+  QList<Appointment> added;  // 含写入时分配的排队号
+  QVector<AppointmentManager::AddStatus> results =
+      appointmentManager->addAppointments(batch, expertManager, &added);
+  bool saved = mainWindow ? mainWindow->saveData() : true;
+  loadAppointments();
+
+  int acceptedCount = 0;
+  int batchIndex = 0;
+  QStringList details;
+  for (const auto& outcome : outcomes) {
+    const Appointment& patient = patients[outcome.patientIndex].info;
+    QString reason = outcome.reason;
+    if (outcome.assigned) {
+      AppointmentManager::AddStatus status = results[batchIndex++];
+      if (status == AppointmentManager::Added) {
+        const Appointment& appt = added[acceptedCount];
+        acceptedCount++;
+        details.append(QString("%1 %2：%3 %4 %5 排队号%6（第%7意向）")
+                           .arg(patient.patientName)
+                           .arg(patient.idNumber)
+                           .arg(appt.expertName)
+                           .arg(appt.appointmentDate.toString("yyyy-MM-dd"))
+                           .arg(appt.serviceTime)
+                           .arg(appt.queueNumber)
+                           .arg(outcome.preferenceRank + 1));
+        continue;
+      }
+      reason = AppointmentManager::addStatusText(status);
+    }
+    details.append(QString("%1 %2：未分配，%3")
+                       .arg(patient.patientName)
+                       .arg(patient.idNumber)
+                       .arg(reason));
+  }
+
+  QString summary =
+      QString("共 %1 位患者：已分配 %2 位，未分配 %3 位。\n"
+              "分配耗时 %4 毫秒（约 %5 人/秒）。")
+          .arg(patients.size())
+          .arg(acceptedCount)
+          .arg(patients.size() - acceptedCount)
+          .arg(elapsedMs)
+          .arg(patients.size() * 1000 / elapsedMs);
+  if (!saved) summary += "\n\n警告：数据保存失败！";
+
+  QMessageBox report(QMessageBox::Information, "筛查批量预约报告", summary,
+                     QMessageBox::Ok, this);
+  if (!details.isEmpty()) report.setDetailedText(details.join("\n"));
+  report.exec();
+}
+
+// 批量导入合作机构的 CSV / NDJSON 预约名单
+void AdminDialog::on_bulkImportBtn_clicked() {
+  if (!expertManager || !appointmentManager) {
+    QMessageBox::warning(this, "错误", "数据管理器未初始化！");
+    return;
+  }
+
+  QString filename = QFileDialog::getOpenFileName(
+      this, "批量导入预约", QDir::homePath(),
+      "预约名单 (*.csv *.ndjson *.jsonl *.qz);;所有文件 (*)");
+  if (filename.isEmpty()) return;
+
+  // 阻塞表格信号，防止导入过程中触发 itemChanged
+  ui->appointmentTable->blockSignals(true);
+
+  BulkImporter importer(expertManager, appointmentManager);
+  BulkImportReport report;
+  QString error;
+  bool imported = importer.importFile(filename, &report, &error);
+  bool saved = true;
+  if (imported && report.accepted > 0) {
+    saved = mainWindow ? mainWindow->saveData() : true;
+    loadAppointments();
+  }
+
+  ui->appointmentTable->blockSignals(false);
+
+  if (!imported) {
+    QMessageBox::warning(this, "失败", error);
+    return;
+  }
+
+  QString summary =
+      QString("共 %1 行：导入 %2 行，失败 %3 行。\n耗时 %4 毫秒（约 %5 行/秒）。")
+          .arg(report.totalRows)
+          .arg(report.accepted)
+          .arg(report.errors.size())
+          .arg(report.elapsedMs)
+          .arg(report.totalRows * 1000LL / qMax<qint64>(1, report.elapsedMs));
+  if (!saved) summary += "\n\n警告：数据保存失败！";
+
+  QStringList details;
+  for (const ImportRowError& rowError : report.errors) {
+    details.append(
+        QString("第 %1 行：%2").arg(rowError.line).arg(rowError.message));
+  }
+
+  QMessageBox result(QMessageBox::Information, "批量导入报告", summary,
+                     QMessageBox::Ok, this);
+  if (!details.isEmpty()) result.setDetailedText(details.join("\n"));
+  result.exec();
+}
+
+void AdminDialog::on_integrityCheckBtn_clicked() {
+  if (!expertManager || !appointmentManager) {
+    QMessageBox::warning(this, "错误", "数据管理器未初始化！");
+    return;
+  }
+
+  IntegrityChecker checker(expertManager, appointmentManager);
+  IntegrityReport report = checker.check();
+
+  bool repairable = false;
+  for (const IntegrityIssue& issue : report.issues) {
+    repairable = repairable || IntegrityChecker::isRepairable(issue.kind);
+  }
+
+  QString summary = report.summaryText();
+  if (!archiveNote().isEmpty()) summary += "\n" + archiveNote();
+  QMessageBox result(
+      report.isClean() ? QMessageBox::Information : QMessageBox::Warning,
+      "数据完整性检查", summary, QMessageBox::Close, this);
+  if (!report.isClean()) result.setDetailedText(report.detailText());
+  QPushButton* repairBtn =
+      repairable ? result.addButton("自动修复", QMessageBox::ActionRole)
+                 : nullptr;
+  QPushButton* exportBtn =
+      result.addButton("导出报告", QMessageBox::ActionRole);
+  result.exec();
+
+  if (result.clickedButton() == exportBtn) {
+    QString filename = QFileDialog::getSaveFileName(
+        this, "导出检查报告", QDir::homePath() + "/integrity_report.json",
+        "JSON文件 (*.json);;所有文件 (*)");
+    if (filename.isEmpty()) return;
+    if (report.saveToFile(filename)) {
+      QMessageBox::information(this, "成功", "检查报告导出成功！");
+    } else {
+      QMessageBox::warning(this, "失败", "检查报告导出失败！");
+    }
+  } else if (repairBtn && result.clickedButton() == repairBtn) {
+    // 阻塞表格信号，防止刷新过程中触发 itemChanged
+    ui->appointmentTable->blockSignals(true);
+    int repaired = checker.repair(report);
+    bool saved = true;
+    if (repaired > 0) {
+      saved = mainWindow ? mainWindow->saveData() : true;
+      loadAppointments();
+    }
+    ui->appointmentTable->blockSignals(false);
+
+    QString message =
+        QString("已修复 %1 条预约（科室不一致、排队号重复），"
+                "其余问题需人工处理。")
+            .arg(repaired);
+    if (!saved) message += "\n\n警告：数据保存失败！";
+    QMessageBox::information(this, "自动修复", message);
+  }
+}
+
 void AdminDialog::on_changeExpertBtn_clicked() {
   // 创建专家管理对话框
   QDialog* expertDialog = new QDialog(this);
@@ -905,6 +1633,7 @@ void AdminDialog::on_changeExpertBtn_clicked() {
                 QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
           return;
         expertManager->experts.removeAt(i);
+        expertManager->markChanged();
         loadExperts();
       });
       expertTable->setCellWidget(i, 7, delBtn);
@@ -970,6 +1699,7 @@ void AdminDialog::on_changeExpertBtn_clicked() {
               default:
                 break;
             }
+            expertManager->markChanged();
           });
 
   // 添加专家
@@ -977,6 +1707,7 @@ void AdminDialog::on_changeExpertBtn_clicked() {
     Expert newExpert;
     if (addExpertDialog(newExpert)) {
       expertManager->experts.append(newExpert);
+      expertManager->markChanged();
       loadExperts();
     }
   });
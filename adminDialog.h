@@ -32,9 +32,15 @@ class AdminDialog : public QDialog {
   void on_deleteAppointmentBtn_clicked();  // 删除预约按钮
   void on_changePasswordBtn_clicked();     // 修改密码按钮
   void on_importDataBtn_clicked();         // 导入数据按钮
+  void on_bulkImportBtn_clicked();         // 批量导入CSV/NDJSON按钮
   void on_exportAppointmentBtn_clicked();  // 导出预约数据按钮
   void on_exportExpertBtn_clicked();       // 导出专家数据按钮
   void on_searchBtn_clicked();             // 搜索按钮
+  void on_freeExpertsBtn_clicked();        // 空闲专家查询按钮
+  void on_normalizeSchedulesBtn_clicked();  // 规范化排班按钮
+  void on_holidayClosureBtn_clicked();     // 批量停诊按钮
+  void on_campaignBookingBtn_clicked();    // 筛查批量预约按钮
+  void on_integrityCheckBtn_clicked();     // 数据完整性检查按钮
   void onDeleteAppointmentRow(int row);    // 删除指定行（动态连接）
   void onItemChanged(QTableWidgetItem* item);  // 表格项变化（用于验证）
   void onDeleteAppointmentByKey(const QString& patientName,  
@@ -52,11 +58,11 @@ private:
   ExpertManager* expertManager;  // 专家管理器指针
   AppointmentManager* appointmentManager;  // 预约管理器指针
   MainWindow* mainWindow;          // 主窗口指针（用于密码修改）
-  PatientDialog* validatorDialog;  // 验证对话框（用于身份证验证）
 
   void setupUI();                   // 设置界面样式
   void setupTable();                // 配置表格
   void loadAppointments();          // 加载预约数据到表格
+  QString archiveNote() const;      // 结果不含已归档预约的提示（无归档为空）
   void editExpertDialog(int row);      // 编辑专家对话框
 };
 
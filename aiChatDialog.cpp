@@ -1,26 +1,62 @@
 #include "aiChatDialog.h"
 
+#include <QDebug>
+#include <QHostInfo>
 #include <QLibrary>
 #include <QMessageBox>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
-#include <QScrollBar>
+#include <QRandomGenerator>
 #include <QSettings>
+#include <QSslConfiguration>
 #include <QSslSocket>
+#include <QTimer>
 #include <QUrl>
 #include <QUrlQuery>
 
 #include "ui_aiChatDialog.h"
 
+// 系统消息：固定说明 + 本轮检索出的数据
+static QString systemPrompt(const QString& systemData) {
+  return QString(
+             "你是一个医院预约系统的AI助手，负责回答用户关于医生和预约的问题。"
+             "以下是与用户问题相关的医生排班与余号信息（JSON，occupancy 为"
+             "每日汇总，slots 为各时间段剩余名额，truncated 表示数据不完整）:"
+             " %1"
+             "请根据这些数据回答用户问题，回答要简洁、准确，并且只使用中文。"
+             "你可以帮助用户查询医生出诊时间、推荐合适的医生、查看预约情况等。")
+      .arg(systemData);
+}
+
 
 AIChatDialog::AIChatDialog(ExpertManager* expertMgr,
-                           AppointmentManager* appointmentMgr, QWidget* parent)
+                           AppointmentManager* appointmentMgr,
+                           QNetworkAccessManager* networkMgr,
+                           AIResponseCache* responseCache,
+                           DepartmentRecommender* recommender,
+                           AvailabilityIndex* availabilityIndex,
+                           QWidget* parent)
     : QDialog(parent),
       ui(new Ui::AIChatDialog),
+      chatModel(nullptr),
+      bubbleDelegate(nullptr),
       expertManager(expertMgr),
       appointmentManager(appointmentMgr),
-      networkManager(new QNetworkAccessManager(this)) {
+      networkManager(networkMgr),
+      responseCache(responseCache),
+      contextBuilder(expertMgr, appointmentMgr),
+      intentMatcher(expertMgr, appointmentMgr, recommender,
+                    availabilityIndex),
+      maxRequestTokens(4000),
+      largestPayload(0),
+      streamingEnabled(true),
+      timeoutMs(30000),
+      maxRetries(3),
+      nextQueryId(0),
+      remoteLatencyTotalMs(0),
+      remoteAnswers(0),
+      prewarming(false) {
   ui->setupUi(this);
 
   resize(600, 500); 
@@ -28,13 +64,61 @@ AIChatDialog::AIChatDialog(ExpertManager* expertMgr,
 
   apiKey = "sk-114514";
 
-  connect(networkManager, &QNetworkAccessManager::finished, this,
-          &AIChatDialog::handleNetworkReply);
+  // 上下文 token 上限可通过配置调整（默认2000）
+  QSettings settings("HospitalApp", "AppointmentSystem");
+  contextBuilder.setTokenBudget(
+      settings.value("aiContextTokenBudget", 2000).toInt());
+  // 接口地址可指向本地的 SSE 模拟服务以便测试
+  apiUrl = settings
+               .value("aiApiUrl",
+                      "https://api.deepseek.com/v1/chat/completions")
+               .toString();
+  streamingEnabled = settings.value("aiStreaming", true).toBool();
+  // 超过该时间没有收到任何数据即视为超时（默认30秒）
+  timeoutMs = qMax(1, settings.value("aiTimeoutSeconds", 30).toInt()) * 1000;
+  maxRetries = qMax(0, settings.value("aiMaxRetries", 3).toInt());
+  // 对话历史与单个请求的 token 上限（默认1500 / 4000）
+  memory.setTokenBudget(settings.value("aiHistoryTokenBudget", 1500).toInt());
+  maxRequestTokens =
+      qMax(500, settings.value("aiMaxRequestTokens", 4000).toInt());
+
+  // 对话记录：列表视图只绘制可见的气泡，排版按消息缓存；保留的消息
+  // 条数有上限（默认500），长时间使用时追加耗时不随记录增长
+  chatModel = new ChatMessageModel(
+      settings.value("aiChatMaxMessages", 500).toInt(), this);
+  bubbleDelegate = new ChatBubbleDelegate(ui->chatHistory);
+  ui->chatHistory->setModel(chatModel);
+  ui->chatHistory->setItemDelegate(bubbleDelegate);
+  connect(chatModel, &ChatMessageModel::dataChanged, bubbleDelegate,
+          &ChatBubbleDelegate::messageChanged);
+
+  updateCancelButton();
+
+  // 打开对话框时就建立连接，第一个问题不再等待握手
+  connect(networkManager, &QNetworkAccessManager::encrypted, this,
+          [this](QNetworkReply*) {
+            if (!prewarming) return;
+            prewarming = false;
+            qDebug() << "AI 连接预热：TCP+TLS 握手完成，累计"
+                     << prewarmTimer.elapsed() << "ms";
+          });
+  prewarmConnection();
 
   appendMessage("您好！我是医院预约AI助手。请问有什么可以帮您？", false);
 }
 
-AIChatDialog::~AIChatDialog() { delete ui; }
+AIChatDialog::~AIChatDialog() {
+  // 先断开再中止，避免 finished 回调访问已销毁的界面
+  for (PendingQuery* pending : pendingQueries) {
+    if (pending->reply) {
+      disconnect(pending->reply, nullptr, this, nullptr);
+      pending->reply->abort();
+      pending->reply->deleteLater();  // 网络管理器由应用共享，需自行释放
+    }
+    delete pending;
+  }
+  delete ui;
+}
 
 void AIChatDialog::on_sendButton_clicked() {
   QString userMessage = ui->messageInput->text().trimmed();
@@ -44,83 +128,114 @@ void AIChatDialog::on_sendButton_clicked() {
   appendMessage(userMessage, true);
   ui->messageInput->clear();
 
-  // 准备系统数据
-  QString systemData = formatSystemData();
-
-  // 发送到API
-  sendToDeepseekAPI(userMessage, systemData);
-}
-
-QString AIChatDialog::formatSystemData() {
-  QJsonObject data;
-
-  // 添加专家信息
-  QJsonArray expertsArray;
-  for (const Expert& expert : expertManager->experts) {
-    QJsonObject expertObj;
-    expertObj["id"] = expert.id;
-    expertObj["name"] = expert.name;
-    expertObj["subject"] = expert.subject;
-    expertObj["gender"] = expert.gender;
-    expertObj["title"] = expert.title;
+  // 确定性的出诊/余号查询与分诊问题直接由本地索引作答
+  QElapsedTimer localTimer;
+  localTimer.start();
+  QueryEntities entities =
+      contextBuilder.extractEntities(userMessage, QDate::currentDate());
+  LocalAnswer localAnswer = intentMatcher.answer(userMessage, entities);
+  if (localAnswer.matched) {
+    appendMessage(localAnswer.text, false);
+    memory.addTurn(userMessage, localAnswer.text);
+    qDebug() << "本地回答（" << localAnswer.intent << "）耗时"
+             << localTimer.nsecsElapsed() / 1000 << "us，远程回答平均"
+             << (remoteAnswers > 0 ? remoteLatencyTotalMs / remoteAnswers : 0)
+             << "ms";
+    return;
+  }
 
-    // 添加出诊时间
-    QJsonArray timesArray;
-    for (const QString& timeSlot : expert.serviceTimes) {
-      timesArray.append(timeSlot);
-    }
-    expertObj["serviceTimes"] = timesArray;
+  // 只检索与问题相关的专家、时间段与占用汇总，按 token 预算截断；
+  // “那明天呢”这类追问没有提到专家或科室时（只换了日期也算），沿用上一轮
+  // 问题中的科室/专家
+  QString retrievalQuery = userMessage;
+  if (entities.expertNames.isEmpty() && entities.departments.isEmpty() &&
+      !memory.lastQuestion().isEmpty()) {
+    retrievalQuery = memory.lastQuestion() + " " + userMessage;
+  }
 
-    expertsArray.append(expertObj);
+  // 请求上限先扣除提示语与本轮问题，上下文只能用剩余额度（不超过配置的
+  // 上下文预算）
+  int promptTokens = AIContextBuilder::estimateTokens(systemPrompt(QString())) +
+                     AIContextBuilder::estimateTokens(userMessage);
+  int contextBudget = contextBuilder.tokenBudget();
+  contextBuilder.setTokenBudget(
+      qMin(contextBudget, maxRequestTokens - promptTokens));
+  QString systemData = contextBuilder.build(retrievalQuery);
+  contextBuilder.setTokenBudget(contextBudget);
+
+  // 历史只占用系统消息与本轮问题之外的剩余额度；问题本身过长、连最小的
+  // 上下文都放不下时不发送
+  int fixedTokens =
+      AIContextBuilder::estimateTokens(systemPrompt(systemData)) +
+      AIContextBuilder::estimateTokens(userMessage);
+  if (fixedTokens > maxRequestTokens) {
+    appendMessage(QString("问题过长（约 %1 token，单次请求上限 %2），请精简后"
+                          "再提问。")
+                      .arg(fixedTokens)
+                      .arg(maxRequestTokens),
+                  false);
+    return;
+  }
+  QJsonArray history = memory.messages(maxRequestTokens - fixedTokens);
+
+  // 同一问题（makeKey 归一化后）与相关数据未变时直接使用缓存的回答。
+  // 独立的问题与对话历史无关，历史不参与键，跨会话也能命中；只有依赖
+  // 上一轮话题的追问（retrievalQuery 带上了上一问）才把历史计入键
+  QString cacheContext = systemData;
+  if (retrievalQuery != userMessage) {
+    cacheContext += QJsonDocument(history).toJson(QJsonDocument::Compact);
   }
-  data["experts"] = expertsArray;
-
-  // 添加预约信息
-  QJsonArray appointmentsArray;
-  for (const Appointment& appt : appointmentManager->getAllAppointments()) {
-    QJsonObject apptObj;
-    apptObj["patientName"] = appt.patientName;
-    apptObj["expertName"] = appt.expertName;
-    apptObj["date"] = appt.appointmentDate.toString("yyyy-MM-dd");
-    apptObj["timeSlot"] = appt.serviceTime;
-    apptObj["subject"] = appt.expertSubject;
-
-    appointmentsArray.append(apptObj);
+  QString cacheKey = AIResponseCache::makeKey(userMessage, cacheContext);
+  QString cachedAnswer;
+  qint64 savedMs = 0;
+  if (responseCache &&
+      responseCache->lookup(cacheKey, &cachedAnswer, &savedMs)) {
+    appendMessage(cachedAnswer, false);
+    memory.addTurn(userMessage, cachedAnswer);
+    qDebug() << "AI 回答来自缓存，节省约" << savedMs << "ms";
+    return;
   }
-  data["appointments"] = appointmentsArray;
 
-  // 添加当前日期
-  data["currentDate"] = QDate::currentDate().toString("yyyy-MM-dd");
+  // 发送到API（可同时有多个提问在进行）
+  sendToDeepseekAPI(userMessage, systemData, history, cacheKey);
+}
 
-  return QJsonDocument(data).toJson(QJsonDocument::Compact);
+void AIChatDialog::on_cancelButton_clicked() {
+  for (int id : pendingQueries.keys()) {
+    PendingQuery* pending = pendingQueries.value(id);
+    if (!pending) continue;
+    pending->cancelled = true;
+    if (pending->reply) {
+      pending->reply->abort();  // finished 中完成收尾
+    } else {
+      // 正在等待重试
+      writeToBubble(pending, "已取消。");
+      finishQuery(pending);
+    }
+  }
 }
 
 void AIChatDialog::sendToDeepseekAPI(const QString& userQuery,
-                                     const QString& systemData) {
-  QUrl url("https://api.deepseek.com/v1/chat/completions");
-  QNetworkRequest request(url);
-  request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-  request.setRawHeader("Authorization",
-                       QString("Bearer %1").arg(apiKey).toUtf8());
-
+                                     const QString& systemData,
+                                     const QJsonArray& history,
+                                     const QString& cacheKey) {
   // 准备请求体
   QJsonObject requestBody;
   requestBody["model"] = "deepseek-chat";
 
   QJsonArray messagesArray;
 
-  // 系统消息包含所有数据
+  // 系统消息包含与本轮问题相关的数据（以往轮次的数据不再重发）
   QJsonObject systemMessage;
   systemMessage["role"] = "system";
-  systemMessage["content"] =
-      QString(
-          "你是一个医院预约系统的AI助手，负责回答用户关于医生和预约的问题。"
-          "以下是当前的医生和预约信息: %1"
-          "请根据这些数据回答用户问题，回答要简洁、准确，并且只使用中文。"
-          "你可以帮助用户查询医生出诊时间、推荐合适的医生、查看预约情况等。")
-          .arg(systemData);
+  systemMessage["content"] = systemPrompt(systemData);
   messagesArray.append(systemMessage);
 
+  // 对话历史：早期摘要 + 最近几轮原文
+  for (const QJsonValue& message : history) {
+    messagesArray.append(message);
+  }
+
   // 用户消息
   QJsonObject userMessage;
   userMessage["role"] = "user";
@@ -129,77 +244,260 @@ void AIChatDialog::sendToDeepseekAPI(const QString& userQuery,
 
   requestBody["messages"] = messagesArray;
   requestBody["temperature"] = 0.3;  // 低温度保证回答准确性
+  requestBody["stream"] = streamingEnabled;  // 流式返回，边生成边显示
+
+  PendingQuery* pending = new PendingQuery;
+  pending->id = ++nextQueryId;
+  pending->query = userQuery;
+  pending->body = QJsonDocument(requestBody).toJson(QJsonDocument::Compact);
+
+  // 记录请求体大小，观察历史与上下文是否控制在上限内
+  largestPayload = qMax(largestPayload, pending->body.size());
+  qDebug() << "AI 请求" << pending->id << "：请求体" << pending->body.size()
+           << "字节，约"
+           << AIContextBuilder::estimateTokens(QString::fromUtf8(pending->body))
+           << "token（历史" << history.size() << "条消息），最大请求体"
+           << largestPayload << "字节";
+  pending->cacheKey = cacheKey;
+
+  // 每个提问有自己的回答气泡，先显示“正在思考...”，回答到达后替换；
+  // 气泡以消息编号定位，其他气泡的追加或淘汰不影响它
+  pending->messageId = appendMessage("正在思考...", false);
+  pending->placeholder = true;
+
+  int id = pending->id;
+  pending->timeout = new QTimer(this);
+  pending->timeout->setSingleShot(true);
+  connect(pending->timeout, &QTimer::timeout, this,
+          [this, id]() { onQueryTimeout(id); });
+
+  pendingQueries.insert(id, pending);
+  pending->timer.start();
+  startAttempt(pending);
+  updateCancelButton();
+}
 
-  // 发送请求
-  QJsonDocument doc(requestBody);
-  networkManager->post(request, doc.toJson());
-
-  // 显示等待消息
-  ui->chatHistory->setEnabled(false);
-  ui->sendButton->setEnabled(false);
-  appendMessage("正在思考...", false);
-}
-
-void AIChatDialog::handleNetworkReply(QNetworkReply* reply) {
-  ui->chatHistory->setEnabled(true);
-  ui->sendButton->setEnabled(true);
-
-  // 删除"正在思考..."消息
-  QTextCursor cursor = ui->chatHistory->textCursor();
-  cursor.movePosition(QTextCursor::End);
-  cursor.select(QTextCursor::LineUnderCursor);
-  cursor.removeSelectedText();
-
-  if (reply->error() == QNetworkReply::NoError) {
-    // 解析JSON响应
-    QJsonDocument response = QJsonDocument::fromJson(reply->readAll());
-    QString aiMessage;
-
-    if (response.isObject()) {
-      QJsonObject responseObj = response.object();
-      if (responseObj.contains("choices") && responseObj["choices"].isArray()) {
-        QJsonArray choices = responseObj["choices"].toArray();
-        if (!choices.isEmpty() && choices[0].isObject()) {
-          QJsonObject firstChoice = choices[0].toObject();
-          if (firstChoice.contains("message") &&
-              firstChoice["message"].isObject()) {
-            QJsonObject message = firstChoice["message"].toObject();
-            aiMessage = message["content"].toString();
-          }
-        }
-      }
+void AIChatDialog::prewarmConnection() {
+  QUrl url(apiUrl);
+  if (url.host().isEmpty()) return;
+
+  // 先单独解析域名（结果进入 Qt 的主机缓存），再建立连接并完成握手
+  prewarmTimer.start();
+  QHostInfo::lookupHost(url.host(), this, [this, url](const QHostInfo& info) {
+    qDebug() << "AI 连接预热：DNS 解析" << url.host()
+             << prewarmTimer.elapsed() << "ms"
+             << (info.error() == QHostInfo::NoError ? "" : info.errorString());
+    if (url.scheme() == "https") {
+      QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
+      sslConfig.setAllowedNextProtocols(
+          {QSslConfiguration::ALPNProtocolHTTP2,
+           QSslConfiguration::NextProtocolHttp1_1});
+      prewarming = true;
+      networkManager->connectToHostEncrypted(url.host(), url.port(443),
+                                             sslConfig);
+    } else {
+      networkManager->connectToHost(url.host(), url.port(80));
     }
+  });
+}
+
+void AIChatDialog::startAttempt(PendingQuery* pending) {
+  QUrl url(apiUrl);
+  QNetworkRequest request(url);
+  request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+  request.setRawHeader("Authorization",
+                       QString("Bearer %1").arg(apiKey).toUtf8());
 
-    if (!aiMessage.isEmpty()) {
-      appendMessage(aiMessage, false);
+  // 允许 HTTP/2（单连接多路复用）；HTTP/1.1 时 Qt 默认保持连接
+  request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+
+  pending->parser.reset();
+  pending->timedOut = false;
+  pending->attemptTimer.start();
+  pending->reply = networkManager->post(request, pending->body);
+
+  // 每个请求单独连接，不依赖 QNetworkAccessManager 的全局 finished
+  int id = pending->id;
+  connect(pending->reply, &QNetworkReply::readyRead, this,
+          [this, id]() { onReplyReadyRead(id); });
+  connect(pending->reply, &QNetworkReply::finished, this,
+          [this, id]() { onReplyFinished(id); });
+
+  // 计时：新建连接时的 TLS 握手、收到响应头（复用连接时没有握手）
+  connect(pending->reply, &QNetworkReply::encrypted, this, [this, id]() {
+    PendingQuery* current = pendingQueries.value(id);
+    if (!current) return;
+    qDebug() << "AI 请求" << id << "：新建连接，TLS 握手完成于"
+             << current->attemptTimer.elapsed() << "ms";
+  });
+  connect(pending->reply, &QNetworkReply::metaDataChanged, this,
+          [this, id]() {
+            PendingQuery* current = pendingQueries.value(id);
+            if (!current || !current->reply) return;
+            bool http2 = current->reply
+                             ->attribute(QNetworkRequest::HTTP2WasUsedAttribute)
+                             .toBool();
+            qDebug() << "AI 请求" << id << "：收到响应头"
+                     << current->attemptTimer.elapsed() << "ms，"
+                     << (http2 ? "HTTP/2" : "HTTP/1.1");
+          });
+  pending->timeout->start(timeoutMs);
+}
+
+void AIChatDialog::onReplyReadyRead(int id) {
+  PendingQuery* pending = pendingQueries.value(id);
+  if (!pending || !pending->reply) return;
+  pending->timeout->start(timeoutMs);  // 收到数据，重新计时
+
+  // 服务器未按流式返回时不读取，留到请求结束后整体解析
+  QString contentType =
+      pending->reply->header(QNetworkRequest::ContentTypeHeader).toString();
+  if (!contentType.contains("text/event-stream")) return;
+
+  readStreamChunks(pending, pending->reply);
+}
+
+void AIChatDialog::onQueryTimeout(int id) {
+  PendingQuery* pending = pendingQueries.value(id);
+  if (!pending || !pending->reply) return;
+  qDebug() << "AI 请求超时：" << id;
+  pending->timedOut = true;
+  pending->reply->abort();  // finished 中决定是否重试
+}
+
+void AIChatDialog::onReplyFinished(int id) {
+  PendingQuery* pending = pendingQueries.value(id);
+  if (!pending || !pending->reply) return;
+
+  QNetworkReply* reply = pending->reply;
+  pending->reply = nullptr;
+  pending->timeout->stop();
+  reply->deleteLater();
+
+  QString contentType =
+      reply->header(QNetworkRequest::ContentTypeHeader).toString();
+  bool streamed = contentType.contains("text/event-stream");
+  if (streamed) readStreamChunks(pending, reply);  // 最后一批数据
+
+  if (pending->cancelled) {
+    writeToBubble(pending, pending->started ? "\n（已取消）" : "已取消。");
+    finishQuery(pending);
+    return;
+  }
+
+  if (reply->error() == QNetworkReply::NoError && !pending->timedOut) {
+    if (!streamed) {
+      // 解析JSON响应（未使用流式或服务器不支持流式时）
+      QJsonDocument response = QJsonDocument::fromJson(reply->readAll());
+      QJsonArray choices = response.object()["choices"].toArray();
+      QJsonObject message = choices.isEmpty()
+                                ? QJsonObject()
+                                : choices[0].toObject()["message"].toObject();
+      QString aiMessage = message["content"].toString();
+      if (!aiMessage.isEmpty()) writeToBubble(pending, aiMessage);
+    }
+    if (!pending->started) {
+      writeToBubble(pending, "抱歉，我无法正确理解API返回的结果。");
     } else {
-      appendMessage("抱歉，我无法正确理解API返回的结果。", false);
+      remoteLatencyTotalMs += pending->timer.elapsed();
+      remoteAnswers++;
+      memory.addTurn(pending->query, pending->text);
+      if (responseCache) {
+        responseCache->insert(pending->cacheKey, pending->text,
+                              pending->timer.elapsed());
+      }
     }
+    qDebug() << "AI 回答完成：" << pending->text.size() << "字，总耗时"
+             << pending->timer.elapsed() << "ms，重试" << pending->attempt
+             << "次";
+    finishQuery(pending);
+    return;
+  }
+
+  // 尚未显示任何内容时，429/5xx/超时按指数退避加随机抖动有限次重试
+  int status =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  bool retryable =
+      pending->timedOut || status == 429 || (status >= 500 && status < 600);
+  if (retryable && !pending->started && pending->attempt < maxRetries) {
+    int delay = retryDelayMs(pending->attempt, reply);
+    pending->attempt++;
+    qDebug() << "AI 请求失败（HTTP" << status << "），" << delay
+             << "ms 后第" << pending->attempt << "次重试";
+    QTimer::singleShot(delay, this, [this, id]() {
+      PendingQuery* waiting = pendingQueries.value(id);
+      if (waiting && !waiting->cancelled) startAttempt(waiting);
+    });
+    return;
+  }
+
+  QString reason = pending->timedOut ? "请求超时" : reply->errorString();
+  writeToBubble(pending, pending->started ? "\n（回答中断：" + reason + "）"
+                                          : "抱歉，发生了错误：" + reason);
+  finishQuery(pending);
+}
+
+void AIChatDialog::readStreamChunks(PendingQuery* pending,
+                                    QNetworkReply* reply) {
+  // 每个事件为一个 chat.completion.chunk，增量内容在 choices[0].delta
+  for (const QString& event : pending->parser.feed(reply->readAll())) {
+    QJsonObject chunk = QJsonDocument::fromJson(event.toUtf8()).object();
+    QJsonArray choices = chunk["choices"].toArray();
+    if (choices.isEmpty()) continue;
+
+    QJsonObject delta = choices[0].toObject()["delta"].toObject();
+    QString content = delta["content"].toString();
+    if (!content.isEmpty()) writeToBubble(pending, content);
+  }
+}
+
+void AIChatDialog::writeToBubble(PendingQuery* pending, const QString& text) {
+  if (!pending->started && !pending->cancelled && !pending->timedOut) {
+    qDebug() << "AI 首个 token 耗时" << pending->timer.elapsed() << "ms";
+  }
+  pending->started = true;
+
+  QString plain = text;
+  plain.remove('\r');
+
+  // 只修改本气泡所在的一行；首次写入时替换“正在思考...”
+  if (pending->placeholder) {
+    chatModel->setText(pending->messageId, plain);
+    pending->placeholder = false;
   } else {
-    // 处理错误
-    appendMessage("抱歉，发生了错误：" + reply->errorString(), false);
+    chatModel->appendText(pending->messageId, plain);
   }
+  pending->text += plain;
 
-  reply->deleteLater();
+  ui->chatHistory->scrollToBottom();
+}
+
+void AIChatDialog::finishQuery(PendingQuery* pending) {
+  pendingQueries.remove(pending->id);
+  pending->timeout->deleteLater();
+  delete pending;
+  updateCancelButton();
 }
 
-void AIChatDialog::appendMessage(const QString& message, bool isUser) {
-  QString style = isUser ? "background-color: #DCF8C6; border-radius: 10px; "
-                           "padding: 8px; margin: 4px;"
-                         : "background-color: #F5F5F5; border-radius: 10px; "
-                           "padding: 8px; margin: 4px;";
+int AIChatDialog::retryDelayMs(int attempt, QNetworkReply* reply) const {
+  // 服务器给出 Retry-After（秒）时优先使用
+  bool ok = false;
+  int retryAfter = reply->rawHeader("Retry-After").trimmed().toInt(&ok);
+  if (ok && retryAfter >= 0) return qMin(retryAfter, 30) * 1000;
+
+  int base = qMin(500 << qMin(attempt, 4), 8000);
+  return base / 2 + int(QRandomGenerator::global()->bounded(base / 2 + 1));
+}
 
-  QString alignStyle = isUser ? "text-align: right;" : "text-align: left;";
-  QString sender = isUser ? "您" : "AI助手";
+void AIChatDialog::updateCancelButton() {
+  ui->cancelButton->setEnabled(!pendingQueries.isEmpty());
+}
 
-  ui->chatHistory->append(
-      QString("<div style='%1'><b>%2:</b><div style='%3'>%4</div></div>")
-          .arg(alignStyle)
-          .arg(sender)
-          .arg(style)
-          .arg(message));
+int AIChatDialog::appendMessage(const QString& message, bool isUser) {
+  // 消息按纯文本显示，由气泡委托绘制
+  int id = chatModel->appendMessage(message, isUser);
 
   // 滚动到底部
-  QScrollBar* sb = ui->chatHistory->verticalScrollBar();
-  sb->setValue(sb->maximum());
+  ui->chatHistory->scrollToBottom();
+  return id;
 }
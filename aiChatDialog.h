@@ -2,43 +2,110 @@
 #define AICHATDIALOG_H
 
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include "aiContextBuilder.h"
+#include "aiResponseCache.h"
 #include "appointmentManager.h"
+#include "chatBubbleDelegate.h"
+#include "chatMessageModel.h"
+#include "conversationMemory.h"
 #include "expertManager.h"
+#include "localIntentMatcher.h"
+#include "sseParser.h"
 
 
 namespace Ui {
 class AIChatDialog;
 }
 
+class AvailabilityIndex;
 class QNetworkAccessManager;
 class QNetworkReply;
+class QTimer;
 
 class AIChatDialog : public QDialog {
   Q_OBJECT
 
  public:
+  // networkMgr 与 responseCache 由应用共享（连接与缓存可在多次打开
+  // 对话框之间复用）；responseCache 可为空（不缓存），recommender 可为
+  // 空（分诊问题交给远程模型），availabilityIndex 为主窗口的余号索引，
+  // 可为空（科室余号逐个专家计算）
   explicit AIChatDialog(ExpertManager* expertMgr,
                         AppointmentManager* appointmentMgr,
+                        QNetworkAccessManager* networkMgr,
+                        AIResponseCache* responseCache,
+                        DepartmentRecommender* recommender,
+                        AvailabilityIndex* availabilityIndex,
                         QWidget* parent = nullptr);
   ~AIChatDialog();
 
  private slots:
   void on_sendButton_clicked();
-  void handleNetworkReply(QNetworkReply* reply);
+  void on_cancelButton_clicked();  // 取消全部进行中的提问
 
  private:
+  // 一个进行中的提问：绑定自己的回答气泡、请求与重试状态
+  struct PendingQuery {
+    int id = 0;
+    QString query;                    // 用户问题（回答完成后写入对话记忆）
+    QByteArray body;                  // 请求体（重试时原样重发）
+    QString cacheKey;                 // 回答缓存的键
+    QNetworkReply* reply = nullptr;   // 当前这次尝试的请求
+    QTimer* timeout = nullptr;        // 传输超时（收到数据时重新计时）
+    SseParser parser;                 // 流式回答的解析状态
+    int messageId = -1;               // 回答气泡的消息编号
+    bool placeholder = false;         // 气泡仍显示“正在思考...”（首次写入时替换）
+    bool started = false;             // 是否已收到回答内容
+    bool timedOut = false;
+    bool cancelled = false;
+    int attempt = 0;                  // 已重试次数
+    QString text;                     // 已收到的回答
+    QElapsedTimer timer;              // 提问计时（首个 token / 总耗时）
+    QElapsedTimer attemptTimer;       // 本次尝试计时（TLS / 响应头）
+  };
+
   Ui::AIChatDialog* ui;
+  ChatMessageModel* chatModel;         // 对话消息（超过保留条数淘汰最早的）
+  ChatBubbleDelegate* bubbleDelegate;  // 气泡绘制与排版缓存
   ExpertManager* expertManager;
   AppointmentManager* appointmentManager;
   QNetworkAccessManager* networkManager;
+  AIResponseCache* responseCache;
   QString apiKey;
+  AIContextBuilder contextBuilder;  // 按问题检索相关数据作为上下文
+  LocalIntentMatcher intentMatcher;  // 出诊/余号/分诊问题的本地直接回答
+  ConversationMemory memory;        // 本次对话的历史（按 token 预算压缩）
+  int maxRequestTokens;             // 单个请求（提示+上下文+历史+问题）上限
+  int largestPayload;               // 已发送的最大请求体（字节）
+  QString apiUrl;                   // 接口地址（可配置为本地测试服务）
+  bool streamingEnabled;            // 是否使用流式（SSE）回答
+  int timeoutMs;                    // 传输超时（毫秒）
+  int maxRetries;                   // 429/5xx/超时的最多重试次数
+  QHash<int, PendingQuery*> pendingQueries;  // 提问编号 -> 状态
+  int nextQueryId;
+  qint64 remoteLatencyTotalMs;  // 远程回答累计耗时（与本地回答对比）
+  int remoteAnswers;
+  QElapsedTimer prewarmTimer;  // 预热计时（DNS / 连接与 TLS）
+  bool prewarming;             // 预热连接尚未完成握手
 
-  QString formatSystemData();
-  void appendMessage(const QString& message, bool isUser);
-  void sendToDeepseekAPI(const QString& userQuery, const QString& systemData);
+  int appendMessage(const QString& message, bool isUser);  // 返回消息编号
+  void prewarmConnection();  // 预先完成 DNS、TCP 与 TLS 握手
+  void sendToDeepseekAPI(const QString& userQuery, const QString& systemData,
+                         const QJsonArray& history, const QString& cacheKey);
+  void startAttempt(PendingQuery* pending);
+  void onReplyReadyRead(int id);
+  void onReplyFinished(int id);
+  void onQueryTimeout(int id);
+  void readStreamChunks(PendingQuery* pending, QNetworkReply* reply);
+  void writeToBubble(PendingQuery* pending, const QString& text);
+  void finishQuery(PendingQuery* pending);
+  int retryDelayMs(int attempt, QNetworkReply* reply) const;
+  void updateCancelButton();
 };
 
-#endif  // AICHATDIALOG_H
\ No newline at end of file
+#endif  // AICHATDIALOG_H
@@ -0,0 +1,369 @@
+#include "aiContextBuilder.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <algorithm>
+
+static const int kDefaultDays = 7;  // 未提到日期时覆盖今天起的天数
+static const int kMaxDates = 14;    // 单次上下文最多覆盖的日期数
+
+// 周一..周日 对应的汉字（“天”同“日”）
+static int weekdayFromChar(const QString& ch) {
+  static const QString kDays = "一二三四五六日";
+  if (ch == "天") return 7;
+  int pos = kDays.indexOf(ch);
+  return pos < 0 ? 0 : pos + 1;
+}
+
+static const int kMaxCachedFragments = 20000;  // 专家×日期 片段数上限
+
+static QByteArray joinFragments(const QList<QByteArray>& fragments) {
+  QByteArray joined;
+  for (int i = 0; i < fragments.size(); ++i) {
+    if (i > 0) joined += ',';
+    joined += fragments[i];
+  }
+  return joined;
+}
+
+AIContextBuilder::AIContextBuilder(ExpertManager* expertMgr,
+                                   AppointmentManager* appointmentMgr)
+    : expertManager(expertMgr), appointmentManager(appointmentMgr),
+      budget(2000), nextSerial(0) {}
+
+void AIContextBuilder::setTokenBudget(int tokens) {
+  budget = qMax(200, tokens);
+}
+
+int AIContextBuilder::tokenBudget() const { return budget; }
+
+int AIContextBuilder::estimateTokens(const QString& text) {
+  int wide = 0;
+  int narrow = 0;
+  for (QChar ch : text) {
+    if (ch.unicode() >= 0x2E80) {
+      wide++;
+    } else {
+      narrow++;
+    }
+  }
+  return wide + (narrow + 3) / 4;
+}
+
+QList<QDate> AIContextBuilder::extractDates(const QString& query,
+                                            const QDate& today) {
+  QList<QDate> dates;
+  QDate monday = today.addDays(1 - today.dayOfWeek());
+
+  // 相对日期（“大后天”需先于“后天”匹配）
+  static const QRegularExpression relative("大后天|后天|明天|明日|今天|今日");
+  auto it = relative.globalMatch(query);
+  while (it.hasNext()) {
+    QString word = it.next().captured(0);
+    int offset = 0;
+    if (word == "大后天") {
+      offset = 3;
+    } else if (word == "后天") {
+      offset = 2;
+    } else if (word.startsWith("明")) {
+      offset = 1;
+    }
+    dates.append(today.addDays(offset));
+  }
+
+  // 周三 / 星期三 / 下周三 / 本周五
+  static const QRegularExpression weekday(
+      "(下下|下|本|这)?(?:周|星期|礼拜)([一二三四五六日天])");
+  it = weekday.globalMatch(query);
+  while (it.hasNext()) {
+    QRegularExpressionMatch match = it.next();
+    QString prefix = match.captured(1);
+    QDate date = monday.addDays(weekdayFromChar(match.captured(2)) - 1);
+    if (prefix == "下") {
+      date = date.addDays(7);
+    } else if (prefix == "下下") {
+      date = date.addDays(14);
+    } else if (prefix.isEmpty() && date < today) {
+      date = date.addDays(7);  // 未说明时指最近的一个
+    }
+    dates.append(date);
+  }
+
+  // 本周 / 下周（不带星期几时指整周，本周从今天算起）
+  static const QRegularExpression week(
+      "(下|本|这)(?:周|星期)(?![一二三四五六日天])");
+  it = week.globalMatch(query);
+  while (it.hasNext()) {
+    bool next = it.next().captured(1) == "下";
+    QDate first = next ? monday.addDays(7) : today;
+    QDate last = next ? monday.addDays(13) : monday.addDays(6);
+    for (QDate date = first; date <= last; date = date.addDays(1)) {
+      dates.append(date);
+    }
+  }
+
+  // 2024-03-05 / 3月5日 / 3月5号
+  static const QRegularExpression isoDate("(\\d{4})-(\\d{1,2})-(\\d{1,2})");
+  it = isoDate.globalMatch(query);
+  while (it.hasNext()) {
+    QRegularExpressionMatch match = it.next();
+    dates.append(QDate(match.captured(1).toInt(), match.captured(2).toInt(),
+                       match.captured(3).toInt()));
+  }
+  static const QRegularExpression monthDay("(\\d{1,2})月(\\d{1,2})[日号]");
+  it = monthDay.globalMatch(query);
+  while (it.hasNext()) {
+    QRegularExpressionMatch match = it.next();
+    dates.append(QDate(today.year(), match.captured(1).toInt(),
+                       match.captured(2).toInt()));
+  }
+
+  QList<QDate> unique;
+  for (const QDate& date : dates) {
+    if (date.isValid() && !unique.contains(date)) unique.append(date);
+  }
+  std::sort(unique.begin(), unique.end());
+  return unique.mid(0, kMaxDates);
+}
+
+QueryEntities AIContextBuilder::extractEntities(const QString& query,
+                                                const QDate& today) const {
+  QueryEntities entities;
+  entities.dates = extractDates(query, today);
+  if (!expertManager) return entities;
+
+  QSet<QString> subjects;
+  for (const Expert& expert : expertManager->experts) {
+    if (!expert.name.isEmpty() && query.contains(expert.name)) {
+      entities.expertNames.append(expert.name);
+    }
+    if (expert.subject.isEmpty() || subjects.contains(expert.subject)) continue;
+    subjects.insert(expert.subject);
+
+    // “心内科”也接受“心内”这样的简称（至少两个字）
+    QString shortName = expert.subject;
+    if (shortName.endsWith("科") && shortName.size() > 2) shortName.chop(1);
+    if (query.contains(shortName)) entities.departments.append(expert.subject);
+  }
+  return entities;
+}
+
+const AIContextBuilder::ExpertFragment& AIContextBuilder::expertFragment(
+    const Expert& expert, ContextStats* stats) {
+  quint64 roster = expertManager->generation();
+  ExpertFragment& fragment = expertFragments[expert.name];
+  if (fragment.json.isEmpty() || fragment.rosterGeneration != roster ||
+      fragment.scheduleGeneration != expert.scheduleGeneration) {
+    QJsonObject expertObj;
+    expertObj["name"] = expert.name;
+    expertObj["subject"] = expert.subject;
+    expertObj["title"] = expert.title;
+    expertObj["serviceTimes"] =
+        QJsonArray::fromStringList(QStringList(expert.serviceTimes));
+    fragment.json = QJsonDocument(expertObj).toJson(QJsonDocument::Compact);
+    fragment.tokens = estimateTokens(QString::fromUtf8(fragment.json));
+    fragment.rosterGeneration = roster;
+    fragment.scheduleGeneration = expert.scheduleGeneration;
+    stats->cacheMisses++;
+  } else {
+    stats->cacheHits++;
+  }
+  return fragment;
+}
+
+const AIContextBuilder::DayFragment& AIContextBuilder::dayFragment(
+    const Expert& expert, const QDate& date, ContextStats* stats) {
+  quint64 appointmentGeneration =
+      appointmentManager ? appointmentManager->expertGeneration(expert.name)
+                         : 0;
+  QString key = expert.name + QChar(0x1f) + QString::number(date.toJulianDay());
+  DayFragment& fragment = dayFragments[key];
+  if (fragment.serial != 0 &&
+      fragment.scheduleGeneration == expert.scheduleGeneration &&
+      fragment.appointmentGeneration == appointmentGeneration) {
+    stats->cacheHits++;
+    return fragment;
+  }
+
+  fragment = DayFragment();
+  fragment.scheduleGeneration = expert.scheduleGeneration;
+  fragment.appointmentGeneration = appointmentGeneration;
+  fragment.serial = ++nextSerial;
+  fragment.onDuty = expert.isAvailableOnDate(date);
+  if (fragment.onDuty) {
+    for (const QString& timeSlot : expert.getAvailableTimeSlotsForDate(date)) {
+      int slotCapacity = expert.getTimeSlotCapacity(timeSlot);
+      int slotBooked = appointmentManager
+                           ? appointmentManager->getSlotOccupancy(
+                                 expert.name, date, timeSlot)
+                           : 0;
+      fragment.capacity += slotCapacity;
+      fragment.booked += slotBooked;
+
+      QJsonObject slot;
+      slot["date"] = date.toString("yyyy-MM-dd");
+      slot["expert"] = expert.name;
+      slot["time"] = timeSlot;
+      slot["remaining"] = qMax(0, slotCapacity - slotBooked);
+      QByteArray json = QJsonDocument(slot).toJson(QJsonDocument::Compact);
+      fragment.slots.append(json);
+      fragment.slotTokens.append(estimateTokens(QString::fromUtf8(json)));
+    }
+  }
+  stats->cacheMisses++;
+  return fragment;
+}
+
+QString AIContextBuilder::build(const QString& query, ContextStats* stats) {
+  QElapsedTimer timer;
+  timer.start();
+  ContextStats local;
+
+  QDate today = QDate::currentDate();
+  if (today != cacheDate) {
+    // 跨日后旧日期的片段不再使用，整体丢弃
+    dayFragments.clear();
+    summaryFragments.clear();
+    headerFragments.clear();
+    cacheDate = today;
+  }
+  QueryEntities entities = extractEntities(query, today);
+
+  // 相关专家：提到的专家与科室；都没有提到时为全部专家
+  QList<const Expert*> selected;
+  QString selectionKey;
+  if (expertManager) {
+    bool filtered =
+        !entities.expertNames.isEmpty() || !entities.departments.isEmpty();
+    for (const Expert& expert : expertManager->experts) {
+      if (!filtered || entities.expertNames.contains(expert.name) ||
+          entities.departments.contains(expert.subject)) {
+        selected.append(&expert);
+        selectionKey += expert.name + QChar(0x1f);
+      }
+    }
+  }
+
+  QList<QDate> dates = entities.dates;
+  if (dates.isEmpty()) {
+    for (int i = 0; i < kDefaultDays; ++i) dates.append(today.addDays(i));
+  }
+
+  // 开头部分（日期与识别出的实体）按实体缓存
+  QString headerKey = entities.departments.join(QChar(0x1f)) + QChar(0x1e) +
+                      entities.expertNames.join(QChar(0x1f));
+  auto header = headerFragments.find(headerKey);
+  if (header == headerFragments.end()) {
+    QJsonObject data;
+    data["currentDate"] = today.toString("yyyy-MM-dd");
+    data["weekday"] = Expert::getDayOfWeekString(today);
+    if (!entities.departments.isEmpty()) {
+      data["matchedDepartments"] =
+          QJsonArray::fromStringList(entities.departments);
+    }
+    if (!entities.expertNames.isEmpty()) {
+      data["matchedExperts"] = QJsonArray::fromStringList(entities.expertNames);
+    }
+    QByteArray json = QJsonDocument(data).toJson(QJsonDocument::Compact);
+    json.chop(1);  // 去掉结尾的 '}'，后面继续拼接
+    header = headerFragments.insert(headerKey, json);
+    local.cacheMisses++;
+  } else {
+    local.cacheHits++;
+  }
+
+  // 依次加入 汇总占用 -> 专家 -> 时间段余量，超出预算后不再加入
+  int used = estimateTokens(QString::fromUtf8(header.value())) + 32;
+  auto take = [&](int tokens) -> bool {
+    if (local.truncated) return false;
+    if (used + tokens + 1 > budget) {
+      local.truncated = true;
+      return false;
+    }
+    used += tokens + 1;
+    return true;
+  };
+
+  QList<QByteArray> occupancy;
+  QList<const DayFragment*> slotSources;
+  for (const QDate& date : dates) {
+    QList<const DayFragment*> parts;
+    quint64 newestSerial = 0;
+    for (const Expert* expert : selected) {
+      const DayFragment& part = dayFragment(*expert, date, &local);
+      parts.append(&part);
+      newestSerial = qMax(newestSerial, part.serial);
+    }
+    slotSources.append(parts);
+
+    // 某日的汇总由各专家当日片段求和；任一片段重建过（序号变大）才重算
+    SummaryFragment& summary = summaryFragments[
+        selectionKey + QChar(0x1e) + QString::number(date.toJulianDay())];
+    if (summary.json.isEmpty() || summary.serial != newestSerial) {
+      int capacity = 0;
+      int booked = 0;
+      int expertsOnDuty = 0;
+      for (const DayFragment* part : parts) {
+        if (!part->onDuty) continue;
+        expertsOnDuty++;
+        capacity += part->capacity;
+        booked += part->booked;
+      }
+      QJsonObject day;
+      day["date"] = date.toString("yyyy-MM-dd");
+      day["weekday"] = Expert::getDayOfWeekString(date);
+      day["expertsOnDuty"] = expertsOnDuty;
+      day["capacity"] = capacity;
+      day["booked"] = booked;
+      summary.json = QJsonDocument(day).toJson(QJsonDocument::Compact);
+      summary.tokens = estimateTokens(QString::fromUtf8(summary.json));
+      summary.serial = newestSerial;
+      local.cacheMisses++;
+    } else {
+      local.cacheHits++;
+    }
+    if (take(summary.tokens)) occupancy.append(summary.json);
+  }
+
+  QList<QByteArray> experts;
+  for (const Expert* expert : selected) {
+    const ExpertFragment& fragment = expertFragment(*expert, &local);
+    if (!take(fragment.tokens)) break;
+    experts.append(fragment.json);
+  }
+
+  QList<QByteArray> slotList;
+  for (const DayFragment* source : slotSources) {
+    for (int i = 0; i < source->slots.size() && !local.truncated; ++i) {
+      if (take(source->slotTokens[i])) slotList.append(source->slots[i]);
+    }
+  }
+
+  // 拼接缓存的片段
+  QByteArray context = header.value();
+  context += ",\"occupancy\":[" + joinFragments(occupancy) + "]";
+  context += ",\"experts\":[" + joinFragments(experts) + "]";
+  context += ",\"slots\":[" + joinFragments(slotList) + "]";
+  if (local.truncated) context += ",\"truncated\":true";  // 提示模型数据不完整
+  context += "}";
+
+  // 缓存只在本次会话内有效，片段过多时整体清空
+  if (dayFragments.size() > kMaxCachedFragments) {
+    dayFragments.clear();
+    summaryFragments.clear();
+  }
+
+  QString result = QString::fromUtf8(context);
+  local.tokens = estimateTokens(result);
+  local.elapsedUs = timer.nsecsElapsed() / 1000;
+  qDebug() << "AI 上下文构建：约" << local.tokens << "tokens，耗时"
+           << local.elapsedUs << "us，片段命中" << local.cacheHits << "/"
+           << local.cacheHits + local.cacheMisses;
+  if (stats) *stats = local;
+  return result;
+}
@@ -0,0 +1,100 @@
+#ifndef AICONTEXTBUILDER_H
+#define AICONTEXTBUILDER_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "appointmentManager.h"
+#include "expertManager.h"
+
+// 从用户问题中识别出的实体
+struct QueryEntities {
+  QStringList departments;  // 提到的科室（“心内”也可命中“心内科”）
+  QStringList expertNames;  // 提到的专家姓名
+  QList<QDate> dates;       // 日期词：今天/明天/周三/下周一/3月5日/2024-03-05
+
+  bool isEmpty() const {
+    return departments.isEmpty() && expertNames.isEmpty() && dates.isEmpty();
+  }
+};
+
+// 一次上下文构建的统计（用于性能观测）
+struct ContextStats {
+  int tokens = 0;          // 估算的 token 数
+  qint64 elapsedUs = 0;    // 构建耗时（微秒）
+  int cacheHits = 0;       // 直接复用的片段数
+  int cacheMisses = 0;     // 重新序列化的片段数
+  bool truncated = false;  // 是否因预算截断
+};
+
+// AI 助手的检索式上下文：不再序列化全部专家与预约，而是按问题中的科室、
+// 专家与日期，经专家名单与预约占用索引只选出相关专家、时间段余量与汇总
+// 占用情况，并按 token 预算截断。专家、专家×日期、每日汇总各自缓存已
+// 序列化的 JSON 片段，按专家名单/排班/预约的变更代号失效，构建时只拼接
+// 片段；同一会话内重复提问不再重新序列化
+class AIContextBuilder {
+ public:
+  AIContextBuilder(ExpertManager* expertMgr,
+                   AppointmentManager* appointmentMgr);
+
+  void setTokenBudget(int tokens);  // 上下文 token 上限（至少 200）
+  int tokenBudget() const;
+
+  QueryEntities extractEntities(const QString& query,
+                                const QDate& today) const;
+  // 生成上下文 JSON（紧凑格式）；stats 返回 token 数、耗时与缓存命中
+  QString build(const QString& query, ContextStats* stats = nullptr);
+
+  // 粗略估算 token 数：汉字每字约 1 个，其余每 4 个字符约 1 个
+  static int estimateTokens(const QString& text);
+
+ private:
+  ExpertManager* expertManager;
+  AppointmentManager* appointmentManager;
+  int budget;
+
+  // 专家基本信息片段，按专家名单与排班代号失效
+  struct ExpertFragment {
+    quint64 rosterGeneration = 0;
+    quint64 scheduleGeneration = 0;
+    QByteArray json;
+    int tokens = 0;
+  };
+  // 某专家某日的时间段片段，按排班与该专家的预约代号失效
+  struct DayFragment {
+    quint64 scheduleGeneration = 0;
+    quint64 appointmentGeneration = 0;
+    quint64 serial = 0;  // 重建序号（递增），汇总片段据此判断是否过期
+    bool onDuty = false;
+    int capacity = 0;
+    int booked = 0;
+    QList<QByteArray> slots;  // 各时间段余量的 JSON
+    QList<int> slotTokens;
+  };
+  // 一组专家某日的占用汇总片段
+  struct SummaryFragment {
+    quint64 serial = 0;  // 构建时各专家当日片段的最大重建序号
+    QByteArray json;
+    int tokens = 0;
+  };
+
+  // QHash 的节点地址在插入时保持不变，构建期间可持有片段指针
+  QHash<QString, ExpertFragment> expertFragments;    // 专家姓名 -> 片段
+  QHash<QString, DayFragment> dayFragments;          // 专家+日期 -> 片段
+  QHash<QString, SummaryFragment> summaryFragments;  // 专家组+日期 -> 片段
+  QHash<QString, QByteArray> headerFragments;  // 识别出的实体 -> 开头部分
+  QDate cacheDate;     // 片段对应的“今天”（跨日后清空）
+  quint64 nextSerial;
+
+  const ExpertFragment& expertFragment(const Expert& expert,
+                                       ContextStats* stats);
+  const DayFragment& dayFragment(const Expert& expert, const QDate& date,
+                                 ContextStats* stats);
+  static QList<QDate> extractDates(const QString& query, const QDate& today);
+};
+
+#endif
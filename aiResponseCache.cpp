@@ -0,0 +1,180 @@
+#include "aiResponseCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static const int kSaveDelayMs = 2000;  // 写入后延迟保存的时间
+
+AIResponseCache::AIResponseCache(const QString& filename, int capacity,
+                                 int ttlMinutes)
+    : cacheFile(filename),
+      maxEntries(qMax(1, capacity)),
+      ttlMs(qint64(qMax(1, ttlMinutes)) * 60 * 1000),
+      hits(0),
+      misses(0),
+      savedTotalMs(0),
+      dirty(false) {
+  saveTimer.setSingleShot(true);
+  saveTimer.setInterval(kSaveDelayMs);
+  QObject::connect(&saveTimer, &QTimer::timeout, [this] { save(); });
+  load();
+}
+
+AIResponseCache::~AIResponseCache() {
+  if (dirty) save();
+}
+
+// 全角转半角、去掉空白与标点、英文转小写：“内科今天还有号吗？”与
+// “内科 今天还有号吗”视为同一个问题
+QString AIResponseCache::normalizeQuery(const QString& query) {
+  QString normalized;
+  for (QChar ch : query.normalized(QString::NormalizationForm_KC)) {
+    if (ch.isSpace() || ch.isPunct() || ch.isSymbol()) continue;
+    normalized.append(ch.toLower());
+  }
+  return normalized;
+}
+
+QString AIResponseCache::makeKey(const QString& query,
+                                 const QString& context) {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(normalizeQuery(query).toUtf8());
+  hash.addData(QByteArray(1, '\0'));
+  hash.addData(context.toUtf8());
+  return QString::fromLatin1(hash.result().toHex());
+}
+
+bool AIResponseCache::lookup(const QString& key, QString* answer,
+                             qint64* savedMs) {
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  auto it = entries.find(key);
+  if (it == entries.end() || isExpired(it.value(), now)) {
+    if (it != entries.end()) entries.erase(it);
+    misses++;
+    qDebug() << "AI 回答缓存未命中，" << statsText();
+    return false;
+  }
+
+  it.value().lastUsed = now;
+  *answer = it.value().answer;
+  if (savedMs) *savedMs = it.value().latencyMs;
+  hits++;
+  savedTotalMs += it.value().latencyMs;
+  qDebug() << "AI 回答缓存命中，" << statsText();
+  return true;
+}
+
+void AIResponseCache::insert(const QString& key, const QString& answer,
+                             qint64 latencyMs) {
+  if (answer.isEmpty()) return;
+
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  Entry entry;
+  entry.answer = answer;
+  entry.createdAt = now;
+  entry.lastUsed = now;
+  entry.latencyMs = latencyMs;
+  entries.insert(key, entry);
+  evict();
+  dirty = true;
+  saveTimer.start();  // 重新计时
+}
+
+QString AIResponseCache::statsText() const {
+  int total = hits + misses;
+  return QString("命中 %1/%2（%3%），累计节省 %4 ms")
+      .arg(hits)
+      .arg(total)
+      .arg(total > 0 ? hits * 100 / total : 0)
+      .arg(savedTotalMs);
+}
+
+bool AIResponseCache::isExpired(const Entry& entry, qint64 now) const {
+  return now - entry.createdAt > ttlMs;
+}
+
+// 先清掉过期条目，仍超出容量时按最近使用时间淘汰
+void AIResponseCache::evict() {
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (isExpired(it.value(), now)) {
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  while (entries.size() > maxEntries) {
+    auto oldest = entries.begin();
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      if (it.value().lastUsed < oldest.value().lastUsed) oldest = it;
+    }
+    entries.erase(oldest);
+  }
+}
+
+bool AIResponseCache::load() {
+  QFile file(cacheFile);
+  if (!file.open(QIODevice::ReadOnly)) return false;  // 尚无缓存文件
+
+  QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+  file.close();
+  for (const QJsonValue& value : doc.object()["entries"].toArray()) {
+    QJsonObject obj = value.toObject();
+    Entry entry;
+    entry.answer = obj["answer"].toString();
+    entry.createdAt = qint64(obj["createdAt"].toDouble());
+    entry.lastUsed = qint64(obj["lastUsed"].toDouble());
+    entry.latencyMs = qint64(obj["latencyMs"].toDouble());
+    entries.insert(obj["key"].toString(), entry);
+  }
+  evict();
+  qDebug() << "载入 AI 回答缓存" << entries.size() << "条：" << cacheFile;
+  return true;
+}
+
+bool AIResponseCache::save() {
+  saveTimer.stop();
+  QJsonArray array;
+  for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+    QJsonObject obj;
+    obj["key"] = it.key();
+    obj["answer"] = it.value().answer;
+    obj["createdAt"] = double(it.value().createdAt);
+    obj["lastUsed"] = double(it.value().lastUsed);
+    obj["latencyMs"] = double(it.value().latencyMs);
+    array.append(obj);
+  }
+  QJsonObject root;
+  root["version"] = 1;
+  root["entries"] = array;
+
+  // 使用临时文件确保原子性写入
+  QString tempFilename = cacheFile + ".tmp";
+  QFile file(tempFilename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qDebug() << "无法写入 AI 回答缓存：" << cacheFile;
+    return false;
+  }
+  QByteArray data = QJsonDocument(root).toJson(QJsonDocument::Compact);
+  bool written = file.write(data) == data.size();
+  file.close();
+  if (!written) {
+    // 写入不完整时保留原有的缓存文件
+    QFile::remove(tempFilename);
+    return false;
+  }
+  if (QFile::exists(cacheFile)) {
+    QFile::remove(cacheFile);
+  }
+  if (!QFile::rename(tempFilename, cacheFile)) {
+    QFile::remove(tempFilename);
+    return false;
+  }
+  dirty = false;
+  return true;
+}
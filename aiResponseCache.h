@@ -0,0 +1,51 @@
+#ifndef AIRESPONSECACHE_H
+#define AIRESPONSECACHE_H
+
+#include <QHash>
+#include <QString>
+#include <QTimer>
+
+// AI 回答缓存：键为“规范化后的问题 + 检索出的上下文”的摘要。上下文由按
+// 专家/排班/预约变更代号失效的片段拼成，相关数据一变键就不同；内存中的
+// 变更代号每次启动都从头计数，不能直接写入磁盘，因此以上下文内容作为
+// 数据版本。条目有有效期，超出容量时淘汰最久未使用的。新条目不逐条写盘：
+// 写入停顿片刻后整体保存一次，析构时写出尚未保存的条目
+class AIResponseCache {
+ public:
+  AIResponseCache(const QString& filename, int capacity, int ttlMinutes);
+  ~AIResponseCache();
+
+  static QString normalizeQuery(const QString& query);
+  static QString makeKey(const QString& query, const QString& context);
+
+  // 命中时返回 true 并给出回答；savedMs 为当初请求的耗时（即节省的时间）
+  bool lookup(const QString& key, QString* answer, qint64* savedMs = nullptr);
+  void insert(const QString& key, const QString& answer, qint64 latencyMs);
+
+  QString statsText() const;  // 命中率与累计节省时间
+
+ private:
+  struct Entry {
+    QString answer;
+    qint64 createdAt = 0;  // 写入时间（毫秒时间戳）
+    qint64 lastUsed = 0;   // 最近使用时间（LRU 依据）
+    qint64 latencyMs = 0;  // 原请求耗时
+  };
+
+  QString cacheFile;
+  int maxEntries;
+  qint64 ttlMs;
+  QHash<QString, Entry> entries;
+  int hits;
+  int misses;
+  qint64 savedTotalMs;
+  QTimer saveTimer;  // 最后一次写入后延迟保存，连续写入只落盘一次
+  bool dirty;        // 有尚未保存的条目
+
+  bool isExpired(const Entry& entry, qint64 now) const;
+  void evict();
+  bool load();
+  bool save();
+};
+
+#endif
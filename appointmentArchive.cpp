@@ -0,0 +1,311 @@
+#include "appointmentArchive.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <algorithm>
+
+#include "appointmentManager.h"
+
+static const quint32 kSegmentMagic = 0x41505347;  // "APSG"
+static const quint32 kSegmentVersion = 1;
+
+static void writeRecord(QDataStream& out, const Appointment& appointment) {
+  out << appointment.patientName << appointment.gender
+      << qint32(appointment.age) << appointment.idNumber << appointment.phone
+      << appointment.description << appointment.expertName
+      << appointment.expertSubject << appointment.serviceTime
+      << qint32(appointment.queueNumber) << appointment.appointmentDate;
+}
+
+static Appointment readRecord(QDataStream& in) {
+  Appointment appointment;
+  qint32 age = 0;
+  qint32 queueNumber = 0;
+  in >> appointment.patientName >> appointment.gender >> age >>
+      appointment.idNumber >> appointment.phone >> appointment.description >>
+      appointment.expertName >> appointment.expertSubject >>
+      appointment.serviceTime >> queueNumber >> appointment.appointmentDate;
+  appointment.age = age;
+  appointment.queueNumber = queueNumber;
+  return appointment;
+}
+
+// 读取段首（索引部分），不读取后面的压缩数据
+static bool readSegmentHeader(QDataStream& in, ArchiveSegmentIndex* index) {
+  quint32 magic = 0;
+  quint32 version = 0;
+  in >> magic >> version;
+  if (magic != kSegmentMagic || version != kSegmentVersion) return false;
+
+  qint32 count = 0;
+  in >> index->month >> count >> index->idRows >> index->expertRows;
+  index->count = count;
+  return in.status() == QDataStream::Ok;
+}
+
+// 读取整个段的记录
+static bool readSegmentFile(const QString& path, ArchiveSegmentIndex* index,
+                            QList<Appointment>* records) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_12);
+  if (!readSegmentHeader(in, index)) return false;
+
+  QByteArray payload;
+  in >> payload;
+  QByteArray data = qUncompress(payload);
+  if (data.isEmpty() && index->count > 0) return false;
+
+  QDataStream recordStream(data);
+  recordStream.setVersion(QDataStream::Qt_5_12);
+  records->reserve(index->count);
+  for (int i = 0; i < index->count; ++i) {
+    records->append(readRecord(recordStream));
+  }
+  return recordStream.status() == QDataStream::Ok;
+}
+
+// 解压后缓存的归档预约总条数上限
+static const int kSegmentCacheRecords = 50000;
+
+AppointmentArchive::AppointmentArchive()
+    : segmentCache(kSegmentCacheRecords) {}
+
+bool AppointmentArchive::open(const QString& dir) {
+  archiveDir = dir;
+  segments.clear();
+  segmentCache.clear();
+
+  QDir root(dir);
+  if (!root.exists()) return true;  // 尚无归档
+
+  for (const QString& file :
+       root.entryList(QStringList() << "*.seg", QDir::Files, QDir::Name)) {
+    QFile segmentFile(root.filePath(file));
+    if (!segmentFile.open(QIODevice::ReadOnly)) continue;
+
+    QDataStream in(&segmentFile);
+    in.setVersion(QDataStream::Qt_5_12);
+    ArchiveSegmentIndex index;
+    if (readSegmentHeader(in, &index)) {
+      segments.insert(index.month, index);
+    } else {
+      qDebug() << "无效的归档段：" << segmentFile.fileName();
+    }
+  }
+
+  qDebug() << "归档载入" << segments.size() << "个段，共" << totalCount()
+           << "个预约：" << dir;
+  return true;
+}
+
+QString AppointmentArchive::directory() const { return archiveDir; }
+
+bool AppointmentArchive::writeSegment(const QString& month,
+                                      const QList<Appointment>& records,
+                                      ArchiveSegmentIndex* index) const {
+  QDir root(archiveDir);
+  if (!root.exists() && !root.mkpath(".")) {
+    qDebug() << "无法创建归档目录：" << archiveDir;
+    return false;
+  }
+
+  // 并入该月已有的归档，自然键相同时以新记录为准
+  QString path = segmentPath(month);
+  QList<Appointment> merged;
+  if (QFile::exists(path)) {
+    ArchiveSegmentIndex existing;
+    if (!readSegmentFile(path, &existing, &merged)) {
+      qDebug() << "无法读取已有归档段：" << path;
+      return false;
+    }
+  }
+  QSet<QString> incoming;
+  for (const Appointment& record : records) {
+    incoming.insert(AppointmentManager::naturalKey(record));
+  }
+  QList<Appointment> kept;
+  for (const Appointment& record : merged) {
+    if (!incoming.contains(AppointmentManager::naturalKey(record))) {
+      kept.append(record);
+    }
+  }
+  kept.append(records);
+  std::stable_sort(kept.begin(), kept.end(),
+                   [](const Appointment& a, const Appointment& b) {
+                     return a.appointmentDate < b.appointmentDate;
+                   });
+
+  ArchiveSegmentIndex built;
+  built.month = month;
+  built.count = kept.size();
+  QByteArray data;
+  QDataStream recordStream(&data, QIODevice::WriteOnly);
+  recordStream.setVersion(QDataStream::Qt_5_12);
+  for (int row = 0; row < kept.size(); ++row) {
+    const Appointment& record = kept[row];
+    writeRecord(recordStream, record);
+    if (!record.idNumber.isEmpty()) built.idRows[record.idNumber].append(row);
+    built.expertRows[record.expertName].append(row);
+  }
+
+  // 先写暂存文件，确认预约数据在写盘期间没有变化后再由 installSegment
+  // 替换正式的段；暂存文件不会被 open 读取，中途退出时自然作废
+  QString stagedPath = pendingPath(month);
+  QFile file(stagedPath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qDebug() << "无法打开暂存文件进行写入：" << stagedPath;
+    return false;
+  }
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_12);
+  out << kSegmentMagic << kSegmentVersion << built.month << qint32(built.count)
+      << built.idRows << built.expertRows << qCompress(data);
+  bool written = out.status() == QDataStream::Ok;
+  file.close();
+
+  if (!written) {
+    qDebug() << "归档段写入失败：" << stagedPath;
+    QFile::remove(stagedPath);
+    return false;
+  }
+
+  *index = built;
+  return true;
+}
+
+bool AppointmentArchive::installSegment(const ArchiveSegmentIndex& index) {
+  // 原有的段先改名保留，替换失败时恢复，不会丢失已归档的数据
+  QString path = segmentPath(index.month);
+  QString stagedPath = pendingPath(index.month);
+  QString backupPath = path + ".old";
+  bool hadSegment = QFile::exists(path);
+  if (hadSegment) {
+    QFile::remove(backupPath);
+    if (!QFile::rename(path, backupPath)) {
+      qDebug() << "归档段启用失败：" << path;
+      return false;
+    }
+  }
+  if (!QFile::rename(stagedPath, path)) {
+    qDebug() << "归档段启用失败：" << path;
+    if (hadSegment) QFile::rename(backupPath, path);
+    return false;
+  }
+  if (hadSegment) QFile::remove(backupPath);
+
+  segments.insert(index.month, index);
+  segmentCache.remove(index.month);
+  return true;
+}
+
+void AppointmentArchive::discardSegment(const QString& month) {
+  QFile::remove(pendingPath(month));
+}
+
+QList<Appointment> AppointmentArchive::visitsByIdNumber(
+    const QString& idNumber) const {
+  QList<Appointment> visits;
+  for (auto it = segments.constBegin(); it != segments.constEnd(); ++it) {
+    auto rows = it.value().idRows.constFind(idNumber);
+    if (rows == it.value().idRows.constEnd()) continue;
+
+    QList<Appointment> records = segmentRecords(it.key());
+    for (int row : rows.value()) {
+      if (row < records.size()) visits.append(records[row]);
+    }
+  }
+  return visits;
+}
+
+QList<Appointment> AppointmentArchive::visitsByExpert(
+    const QString& expertName, const QDate& from, const QDate& to) const {
+  QString fromKey = AppointmentManager::partitionKey(from);
+  QString toKey = AppointmentManager::partitionKey(to);
+
+  QList<Appointment> visits;
+  for (auto it = segments.constBegin(); it != segments.constEnd(); ++it) {
+    if ((from.isValid() && it.key() < fromKey) ||
+        (to.isValid() && it.key() > toKey)) {
+      continue;
+    }
+    auto rows = it.value().expertRows.constFind(expertName);
+    if (rows == it.value().expertRows.constEnd()) continue;
+
+    QList<Appointment> records = segmentRecords(it.key());
+    for (int row : rows.value()) {
+      if (row >= records.size()) continue;
+      const QDate& date = records[row].appointmentDate;
+      if ((!from.isValid() || date >= from) && (!to.isValid() || date <= to)) {
+        visits.append(records[row]);
+      }
+    }
+  }
+  return visits;
+}
+
+bool AppointmentArchive::containsIdNumber(const QString& idNumber) const {
+  for (const ArchiveSegmentIndex& index : segments) {
+    if (index.idRows.contains(idNumber)) return true;
+  }
+  return false;
+}
+
+int AppointmentArchive::totalCount() const {
+  int total = 0;
+  for (const ArchiveSegmentIndex& index : segments) total += index.count;
+  return total;
+}
+
+QStringList AppointmentArchive::segmentFiles() const {
+  QStringList files;
+  for (auto it = segments.constBegin(); it != segments.constEnd(); ++it) {
+    files.append(segmentPath(it.key()));
+  }
+  return files;
+}
+
+bool AppointmentArchive::readSegment(const QString& path,
+                                     QList<Appointment>* records) {
+  ArchiveSegmentIndex index;
+  return readSegmentFile(path, &index, records);
+}
+
+QString AppointmentArchive::exclusionNote() const {
+  int count = totalCount();
+  if (count == 0) return QString();
+  return QString("另有 %1 条已归档的历史预约未包含在内，可在专家或患者的"
+                 "就诊记录中查看。")
+      .arg(count);
+}
+
+QString AppointmentArchive::segmentPath(const QString& month) const {
+  return QDir(archiveDir).filePath(month + ".seg");
+}
+
+QString AppointmentArchive::pendingPath(const QString& month) const {
+  return segmentPath(month) + ".pending";
+}
+
+// 返回的列表与缓存隐式共享，不复制记录
+QList<Appointment> AppointmentArchive::segmentRecords(
+    const QString& month) const {
+  if (const QList<Appointment>* cached = segmentCache.object(month)) {
+    return *cached;
+  }
+
+  QList<Appointment> records;
+  ArchiveSegmentIndex index;
+  if (!readSegmentFile(segmentPath(month), &index, &records)) {
+    qDebug() << "无法读取归档段：" << segmentPath(month);
+    return QList<Appointment>();  // 读取失败不缓存，下次重试
+  }
+  segmentCache.insert(month, new QList<Appointment>(records),
+                      qMax(1, records.size()));
+  return records;
+}
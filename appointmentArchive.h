@@ -0,0 +1,68 @@
+#ifndef APPOINTMENTARCHIVE_H
+#define APPOINTMENTARCHIVE_H
+
+#include <QCache>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "appointment.h"
+
+// 归档段的索引（常驻内存，数据本身留在磁盘上）
+struct ArchiveSegmentIndex {
+  QString month;  // yyyy-MM
+  int count = 0;
+  QHash<QString, QVector<int>> idRows;      // 身份证号 -> 段内行号
+  QHash<QString, QVector<int>> expertRows;  // 专家姓名 -> 段内行号
+};
+
+// 历史预约归档：每月一个只追加的压缩段（yyyy-MM.seg）。段首保存身份证号
+// 与专家索引，打开归档时只读取各段索引，查询时只解压命中的段。
+class AppointmentArchive {
+ public:
+  AppointmentArchive();
+
+  bool open(const QString& dir);  // 读取目录下全部段的索引
+  QString directory() const;
+
+  // 把 records 并入某月的归档段，写入暂存文件（yyyy-MM.seg.pending，按
+  // 自然键去重）；只读取磁盘文件、不修改本对象，可在工作线程中调用。
+  // 成功时通过 index 返回新段的索引，之后由 installSegment 正式启用
+  bool writeSegment(const QString& month, const QList<Appointment>& records,
+                    ArchiveSegmentIndex* index) const;
+  // 用暂存文件替换该月的段并启用新索引；失败时原有的段保持不变
+  bool installSegment(const ArchiveSegmentIndex& index);
+  void discardSegment(const QString& month);  // 丢弃未启用的暂存文件
+
+  // 某患者的全部归档就诊记录（按日期排序）
+  QList<Appointment> visitsByIdNumber(const QString& idNumber) const;
+  // 某专家在日期范围内的归档预约（无效日期表示该端不限）
+  QList<Appointment> visitsByExpert(const QString& expertName,
+                                    const QDate& from, const QDate& to) const;
+  bool containsIdNumber(const QString& idNumber) const;
+  int totalCount() const;  // 归档预约总数
+  QStringList segmentFiles() const;  // 全部段文件路径（按月份升序）
+  // 读取一个段文件的全部记录；不访问任何对象，可在工作线程中调用
+  static bool readSegment(const QString& path, QList<Appointment>* records);
+  // 归档中有预约时，给出导出、关键字查询与完整性检查“不含已归档预约”
+  // 的提示文字；没有归档时返回空串
+  QString exclusionNote() const;
+
+ private:
+  QString archiveDir;
+  QMap<QString, ArchiveSegmentIndex> segments;  // 月份 -> 段索引
+
+  // 最近解压过的段（LRU，成本按预约条数计）；同一患者或专家的查询常
+  // 反复命中相同的几个段
+  mutable QCache<QString, QList<Appointment>> segmentCache;
+
+  QString segmentPath(const QString& month) const;
+  QString pendingPath(const QString& month) const;
+  QList<Appointment> segmentRecords(const QString& month) const;
+};
+
+#endif
@@ -1,35 +1,254 @@
 #include "appointmentManager.h"
 
 #include <QDebug>
+#include <QDir>
 #include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSet>
 #include <QTextStream>
+#include <algorithm>
 
-AppointmentManager::AppointmentManager() {
-  // 构造函数
+#include "appointmentArchive.h"
+#include "expertManager.h"
+
+// 从下标索引中移除某条预约的下标，列表为空时删除该键
+template <typename Key>
+static void removePosition(QHash<Key, QVector<int>>& index, const Key& key,
+                           int position) {
+  auto it = index.find(key);
+  if (it == index.end()) return;
+  it.value().removeOne(position);
+  if (it.value().isEmpty()) index.erase(it);
+}
+
+// 删除第 removed 条预约后，其后所有下标前移一位
+template <typename Key>
+static void shiftPositions(QHash<Key, QVector<int>>& index, int removed) {
+  for (auto it = index.begin(); it != index.end(); ++it) {
+    for (int& position : it.value()) {
+      if (position > removed) --position;
+    }
+  }
 }
 
+// 就诊历史查询缓存的历史分区预约总条数上限
+static const int kPartitionVisitCacheRecords = 50000;
+
+AppointmentManager::AppointmentManager(QObject* parent)
+    : QObject(parent),
+      changeGeneration(0),
+      partitionVisits(kPartitionVisitCacheRecords),
+      archive(nullptr),
+      partitionReads(0) {}
+
 bool AppointmentManager::addAppointment(const Appointment& appointment) {
   appointments.append(appointment);
+  adjustOccupancy(appointment, 1);
+  indexPosition(appointment, appointments.size() - 1);
   qDebug() << "添加预约：" << appointment.patientName << " -> "
            << appointment.expertName;
+  emit appointmentsAdded(appointments.size() - 1, 1);
+  emit slotOccupancyChanged(appointment.expertName,
+                            appointment.appointmentDate);
   return true;
 }
 
+QVector<AppointmentManager::AddStatus> AppointmentManager::addAppointments(
+    const QList<Appointment>& batch, ExpertManager* expertMgr,
+    QList<Appointment>* added) {
+  QList<Appointment> accepted;
+  QVector<AddStatus> results = validateBatch(batch, expertMgr, &accepted);
+  appendBatch(accepted);
+  if (added) *added = accepted;
+  if (!accepted.isEmpty()) {
+    emit appointmentsAdded(appointments.size() - accepted.size(),
+                           accepted.size());
+  }
+
+  qDebug() << "批量添加预约：通过" << accepted.size() << "个，拒绝"
+           << batch.size() - accepted.size() << "个";
+  if (accepted.size() == 1) {
+    emit slotOccupancyChanged(accepted.first().expertName,
+                              accepted.first().appointmentDate);
+  } else if (accepted.size() > 1) {
+    emit appointmentsReset();
+  }
+  return results;
+}
+
+QVector<AppointmentManager::AddStatus> AppointmentManager::validateBatch(
+    const QList<Appointment>& batch, ExpertManager* expertMgr,
+    QList<Appointment>* accepted) const {
+  QVector<AddStatus> results(batch.size(), Added);
+  QSet<QString> batchIds;       // 本批次已通过的身份证号
+  QHash<QString, int> pending;  // 本批次各时间段新增人数
+  QHash<QString, int> lastQueue;  // 本批次各时间段已分配的最大排队号
+
+  for (int i = 0; i < batch.size(); ++i) {
+    const Appointment& appointment = batch[i];
+
+    const QString& idNumber = appointment.idNumber;
+    if (!idNumber.isEmpty() &&
+        (batchIds.contains(idNumber) || hasIdNumber(idNumber))) {
+      results[i] = DuplicateIdNumber;
+      continue;
+    }
+
+    const QDate& date = appointment.appointmentDate;
+    QString key =
+        occupancyKey(appointment.expertName, date, appointment.serviceTime);
+    int occupied = occupancyIndex.value(key, 0) + pending.value(key, 0);
+
+    if (expertMgr) {
+      Expert* expert = expertMgr->findExpertByName(appointment.expertName);
+      if (!expert) {
+        results[i] = ExpertNotFound;
+        continue;
+      }
+      if (!expert->isAvailableOnDate(date) ||
+          !expert->getAvailableTimeSlotsForDate(date).contains(
+              appointment.serviceTime)) {
+        results[i] = ExpertUnavailable;
+        continue;
+      }
+      if (occupied >= expert->getTimeSlotCapacity(appointment.serviceTime)) {
+        results[i] = SlotFull;
+        continue;
+      }
+    }
+
+    pending[key]++;
+    if (!idNumber.isEmpty()) batchIds.insert(idNumber);
+    accepted->append(appointment);
+
+    // 未指定排队号的记录按写入顺序接在该时间段已有的最大排队号之后；
+    // 取消预约后排队号可能不连续，按人数计算会与已有的号重复
+    auto last = lastQueue.find(key);
+    if (last == lastQueue.end()) {
+      last = lastQueue.insert(
+          key, maxQueueNumber(appointment.expertName, date,
+                              appointment.serviceTime));
+    }
+    if (appointment.queueNumber <= 0) {
+      accepted->last().queueNumber = ++last.value();
+    } else {
+      last.value() = qMax(last.value(), appointment.queueNumber);
+    }
+  }
+  return results;
+}
+
+void AppointmentManager::appendBatch(const QList<Appointment>& accepted) {
+  appointments.reserve(appointments.size() + accepted.size());
+  for (const Appointment& appointment : accepted) {
+    appointments.append(appointment);
+    adjustOccupancy(appointment, 1);
+    indexPosition(appointment, appointments.size() - 1);
+  }
+}
+
+QString AppointmentManager::addStatusText(AddStatus status) {
+  switch (status) {
+    case Added:
+      return "已添加";
+    case DuplicateIdNumber:
+      return "该身份证号已有预约";
+    case ExpertNotFound:
+      return "专家不存在";
+    case ExpertUnavailable:
+      return "专家该日不出诊或无此时间段";
+    case SlotFull:
+      return "该时间段预约已满";
+  }
+  return QString();
+}
+
+bool AppointmentManager::hasIdNumber(const QString& idNumber) const {
+  if (idPositions.contains(idNumber)) return true;
+
+  // 未载入的历史分区：过滤器判定不含该患者的直接跳过，不读文件
+  for (auto it = unloadedPartitions.constBegin();
+       it != unloadedPartitions.constEnd(); ++it) {
+    if (partitionFilters.value(it.key()).mightContain(idNumber) &&
+        unloadedVisits(it.key()).contains(idNumber)) {
+      return true;
+    }
+  }
+  return archive && archive->containsIdNumber(idNumber);
+}
+
+void AppointmentManager::setArchive(const AppointmentArchive* archive) {
+  this->archive = archive;
+}
+
+QList<Appointment> AppointmentManager::visitsByIdNumber(
+    const QString& idNumber) const {
+  QList<Appointment> visits;
+  QSet<QString> inMemory;
+  for (int index : idPositions.value(idNumber)) {
+    visits.append(appointments[index]);
+    inMemory.insert(naturalKey(appointments[index]));
+  }
+
+  // 未载入的历史分区：过滤器判定不含该患者的直接跳过，不读文件
+  for (auto it = unloadedPartitions.constBegin();
+       it != unloadedPartitions.constEnd(); ++it) {
+    if (!partitionFilters.value(it.key()).mightContain(idNumber)) continue;
+    for (const Appointment& record :
+         unloadedVisits(it.key()).value(idNumber)) {
+      if (!inMemory.contains(naturalKey(record))) visits.append(record);
+    }
+  }
+  return visits;
+}
+
+AppointmentManager::VisitsById AppointmentManager::unloadedVisits(
+    const QString& month) const {
+  if (const VisitsById* cached = partitionVisits.object(month)) {
+    return *cached;
+  }
+
+  QList<Appointment> records;
+  if (!readPartitionFile(month, &records)) return VisitsById();
+  VisitsById byId;
+  for (const Appointment& record : records) {
+    if (!record.idNumber.isEmpty()) byId[record.idNumber].append(record);
+  }
+  // 超过上限的单个分区不缓存（insert 会直接释放）
+  partitionVisits.insert(month, new VisitsById(byId),
+                         qMax(1, records.size()));
+  return byId;
+}
+
 void AppointmentManager::removeAppointment(int index) {
   if (index >= 0 && index < appointments.size()) {
     qDebug() << "删除预约：" << appointments[index].patientName;
-    appointments.removeAt(index);
+    Appointment removed = appointments.takeAt(index);
+    adjustOccupancy(removed, -1);
+    unindexPosition(removed, index);
+    shiftPositions(slotPositions, index);
+    shiftPositions(datePositions, index);
+    shiftPositions(idPositions, index);
+    shiftPositions(departmentPositions, index);
+    emit slotOccupancyChanged(removed.expertName, removed.appointmentDate);
   }
 }
 
 void AppointmentManager::updateAppointment(int index,
                                            const Appointment& appointment) {
   if (index >= 0 && index < appointments.size()) {
+    Appointment previous = appointments[index];
+    adjustOccupancy(previous, -1);
     appointments[index] = appointment;
+    adjustOccupancy(appointment, 1);
+    unindexPosition(previous, index);
+    indexPosition(appointment, index);
     qDebug() << "更新预约：" << appointment.patientName;
+    emit slotOccupancyChanged(previous.expertName, previous.appointmentDate);
+    emit slotOccupancyChanged(appointment.expertName,
+                              appointment.appointmentDate);
   }
 }
 
@@ -57,45 +276,109 @@ QList<Appointment> AppointmentManager::getAppointmentsByExpert(
 void AppointmentManager::updateServiceTimeForExpert(const QString& expertName,
                                                     const QString& oldTime,
                                                     const QString& newTime) {
+  QHash<QString, QString> renames;
+  renames.insert(oldTime, newTime);
+  remapServiceTimes(expertName, renames);
+}
+
+int AppointmentManager::remapServiceTimes(
+    const QHash<QString, QHash<QString, QString>>& renamesByExpert) {
+  // 时间段改名不限日期，但未载入的历史分区不为此载入：改名记在各分区
+  // 名下，载入或读取该分区时再应用，之后保存时随分区写回
+  for (auto it = unloadedPartitions.constBegin();
+       it != unloadedPartitions.constEnd(); ++it) {
+    SlotRenames& pending = pendingRenames[it.key()];
+    composeRenames(&pending, renamesByExpert);
+    if (pending.isEmpty()) pendingRenames.remove(it.key());
+    partitionVisits.remove(it.key());
+  }
+
+  // 先取出所有旧时间段的预约下标再统一改写，每条预约只按其原时间段
+  // 重命名一次（如 A->B 与 B->C 同时存在时不会被连续移动两次）
+  struct Move {
+    QVector<int> positions;
+    QString expertName;
+    QString newTime;
+  };
+  QList<Move> moves;
+  for (auto expertIt = renamesByExpert.constBegin();
+       expertIt != renamesByExpert.constEnd(); ++expertIt) {
+    const QHash<QString, QString>& renames = expertIt.value();
+    for (auto it = renames.constBegin(); it != renames.constEnd(); ++it) {
+      if (it.key() == it.value()) continue;
+      QVector<int> positions =
+          slotPositions.take(slotKey(expertIt.key(), it.key()));
+      if (positions.isEmpty()) continue;
+
+      Move move;
+      move.positions = positions;
+      move.expertName = expertIt.key();
+      move.newTime = it.value();
+      moves.append(move);
+    }
+  }
+
   int updatedCount = 0;
-  for (auto& appointment : appointments) {
-    if (appointment.expertName == expertName &&
-        appointment.serviceTime == oldTime) {
-      appointment.serviceTime = newTime;
-      updatedCount++;
-      qDebug() << "更新预约时间：" << appointment.patientName << oldTime
-               << " -> " << newTime;
+  for (const Move& move : moves) {
+    QVector<int>& target =
+        slotPositions[slotKey(move.expertName, move.newTime)];
+    for (int index : move.positions) {
+      Appointment& appointment = appointments[index];
+      adjustOccupancy(appointment, -1);
+      appointment.serviceTime = move.newTime;
+      adjustOccupancy(appointment, 1);
+      target.append(index);
     }
+    updatedCount += move.positions.size();
   }
-  qDebug() << "共更新了" << updatedCount << "个预约的服务时间";
+
+  qDebug() << "批量更新时间段：" << renamesByExpert.size() << "位专家，共"
+           << updatedCount << "个预约";
+  if (updatedCount > 0) {
+    emit appointmentsReset();
+  }
+  return updatedCount;
+}
+
+int AppointmentManager::remapServiceTimes(
+    const QString& expertName, const QHash<QString, QString>& renames) {
+  QHash<QString, QHash<QString, QString>> renamesByExpert;
+  renamesByExpert.insert(expertName, renames);
+  return remapServiceTimes(renamesByExpert);
 }
 
 bool AppointmentManager::saveToFile(const QString& filename) const {
+  return writeAppointments(filename, appointments);
+}
+
+bool AppointmentManager::loadFromFile(const QString& filename) {
+  QList<Appointment> loaded;
+  if (!readAppointments(filename, &loaded)) {
+    return false;
+  }
+
+  // 整体替换：尚未载入的历史分区也一并作废，下次保存时删除
+  appointments = loaded;
+  unloadedPartitions.clear();
+  partitionFilters.clear();
+  pendingRenames.clear();
+  partitionVisits.clear();
+  rebuildIndexes();
+  emit appointmentsReset();
+
+  qDebug() << "成功从文件加载" << appointments.size() << "个预约：" << filename;
+  return true;
+}
+
+bool AppointmentManager::writeAppointments(
+    const QString& filename, const QList<Appointment>& list) {
   // 使用临时文件确保原子性写入
   QString tempFilename = filename + ".tmp";
   QJsonArray appointmentArray;
 
   // 将所有预约转换为JSON对象
-  for (const Appointment& appointment : appointments) {
-    QJsonObject appointmentObj;
-    appointmentObj["patientName"] = appointment.patientName;
-    appointmentObj["gender"] = appointment.gender;
-    appointmentObj["age"] = appointment.age;
-    appointmentObj["idNumber"] = appointment.idNumber;
-    appointmentObj["phone"] = appointment.phone;
-    appointmentObj["description"] = appointment.description;
-    appointmentObj["expertName"] = appointment.expertName;
-    appointmentObj["expertSubject"] = appointment.expertSubject;
-    appointmentObj["serviceTime"] = appointment.serviceTime;
-    appointmentObj["queueNumber"] = appointment.queueNumber;
-
-    // 保存日期
-    if (appointment.appointmentDate.isValid()) {
-      appointmentObj["appointmentDate"] =
-          appointment.appointmentDate.toString("yyyy-MM-dd");
-    }
-
-    appointmentArray.append(appointmentObj);
+  for (const Appointment& appointment : list) {
+    appointmentArray.append(appointmentToJson(appointment));
   }
 
   // 创建JSON文档
@@ -128,11 +411,12 @@ bool AppointmentManager::saveToFile(const QString& filename) const {
     return false;
   }
 
-  qDebug() << "成功保存" << appointments.size() << "个预约到文件：" << filename;
+  qDebug() << "成功保存" << list.size() << "个预约到文件：" << filename;
   return true;
 }
 
-bool AppointmentManager::loadFromFile(const QString& filename) {
+bool AppointmentManager::readAppointments(const QString& filename,
+                                          QList<Appointment>* list) {
   QFile file(filename);
   if (!file.open(QIODevice::ReadOnly)) {
     qDebug() << "无法打开文件: " << filename;
@@ -148,38 +432,549 @@ bool AppointmentManager::loadFromFile(const QString& filename) {
     return false;
   }
 
-  // 清空现有数据
-  appointments.clear();
-
   // 解析JSON数组
   QJsonArray appointmentArray = doc.array();
   for (const QJsonValue& value : appointmentArray) {
     if (!value.isObject()) continue;
 
-    QJsonObject obj = value.toObject();
-    Appointment appointment;
+    list->append(appointmentFromJson(value.toObject()));
+  }
+  return true;
+}
 
-    appointment.patientName = obj["patientName"].toString();
-    appointment.gender = obj["gender"].toString();
-    appointment.age = obj["age"].toInt();
-    appointment.idNumber = obj["idNumber"].toString();
-    appointment.phone = obj["phone"].toString();
-    appointment.description = obj["description"].toString();
-    appointment.expertName = obj["expertName"].toString();
-    appointment.expertSubject = obj["expertSubject"].toString();
-    appointment.serviceTime = obj["serviceTime"].toString();
-    appointment.queueNumber = obj["queueNumber"].toInt();
+QString AppointmentManager::partitionKey(const QDate& date) {
+  return date.isValid() ? date.toString("yyyy-MM") : "undated";
+}
 
-    // 加载日期
-    if (obj.contains("appointmentDate")) {
-      appointment.appointmentDate =
-          QDate::fromString(obj["appointmentDate"].toString(), "yyyy-MM-dd");
+bool AppointmentManager::loadPartitions(const QString& dir,
+                                        const QDate& fromDate) {
+  QDir partitionRoot(dir);
+  QFile manifestFile(partitionRoot.filePath("manifest.json"));
+  if (!manifestFile.open(QIODevice::ReadOnly)) {
+    qDebug() << "分区清单不存在：" << manifestFile.fileName();
+    return false;
+  }
+  QJsonDocument doc = QJsonDocument::fromJson(manifestFile.readAll());
+  manifestFile.close();
+  if (!doc.isObject()) {
+    qDebug() << "无效的分区清单：" << manifestFile.fileName();
+    return false;
+  }
+
+  // 当月及以后的分区（以及无日期分区）立即载入，更早的只记录在清单中
+  // 读取失败的分区同样留在未载入列表中，保存时不会被覆盖
+  // 上次运行时记下的时间段改名在载入分区时应用，未载入的继续保留
+  QString fromKey = partitionKey(fromDate);
+  QList<Appointment> loaded;
+  QMap<QString, int> unloaded;
+  QHash<QString, BloomFilter> filters;
+  QHash<QString, SlotRenames> renames;
+  QSet<QString> known;
+  for (const QJsonValue& value : doc.object()["partitions"].toArray()) {
+    QJsonObject partition = value.toObject();
+    QString month = partition["month"].toString();
+    known.insert(month);
+    SlotRenames monthRenames = renamesFromJson(partition["renames"].toObject());
+    QList<Appointment> records;
+    if ((fromDate.isValid() && month != "undated" && month < fromKey) ||
+        !readAppointments(partitionRoot.filePath(month + ".json"),
+                          &records)) {
+      unloaded.insert(month, partition["count"].toInt());
+      filters.insert(month,
+                     BloomFilter::fromBase64(partition["idFilter"].toString()));
+      if (!monthRenames.isEmpty()) renames.insert(month, monthRenames);
+      continue;
     }
+    applyRenames(monthRenames, &records);
+    loaded.append(records);
+  }
 
-    appointments.append(appointment);
+  appointments = loaded;
+  partitionDir = dir;
+  unloadedPartitions = unloaded;
+  partitionFilters = filters;
+  pendingRenames = renames;
+  partitionVisits.clear();
+  knownPartitions = known;
+  rebuildIndexes();
+  emit appointmentsReset();
+
+  qDebug() << "从分区目录载入" << appointments.size() << "个预约，"
+           << unloadedPartitions.size() << "个历史分区按需载入：" << dir;
+  return true;
+}
+
+bool AppointmentManager::savePartitions(const QString& dir) {
+  QDir partitionRoot(dir);
+  if (!partitionRoot.exists() && !partitionRoot.mkpath(".")) {
+    qDebug() << "无法创建分区目录：" << dir;
+    return false;
   }
 
-  qDebug() << "成功从文件加载" << appointments.size() << "个预约：" << filename;
+  // 内存中的预约落在未载入的历史分区时，先载入该分区再整体写回，
+  // 避免用部分数据覆盖历史文件
+  QStringList pending;
+  for (const Appointment& appointment : appointments) {
+    QString month = partitionKey(appointment.appointmentDate);
+    if (unloadedPartitions.contains(month) && !pending.contains(month)) {
+      pending.append(month);
+    }
+  }
+  if (!pending.isEmpty()) {
+    loadPartitionMonths(pending);
+    for (const QString& month : pending) {
+      if (unloadedPartitions.contains(month)) {
+        qDebug() << "历史分区载入失败，取消保存：" << month;
+        return false;
+      }
+    }
+  }
+
+  QMap<QString, QList<Appointment>> groups;
+  for (const Appointment& appointment : appointments) {
+    groups[partitionKey(appointment.appointmentDate)].append(appointment);
+  }
+
+  // 每个分区附带身份证号布隆过滤器，查询就诊历史时可跳过未载入的分区
+  QMap<QString, int> counts = unloadedPartitions;
+  QHash<QString, BloomFilter> filters = partitionFilters;
+  for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+    if (!writeAppointments(partitionRoot.filePath(it.key() + ".json"),
+                           it.value())) {
+      return false;
+    }
+    counts.insert(it.key(), it.value().size());
+    BloomFilter filter(it.value().size());
+    for (const Appointment& appointment : it.value()) {
+      filter.insert(appointment.idNumber);
+    }
+    filters.insert(it.key(), filter);
+  }
+
+  // 删除已清空的分区文件（只处理本次运行读写过的分区，清单损坏时
+  // 目录中的其他文件保持不动）
+  for (const QString& month : knownPartitions) {
+    if (!counts.contains(month)) {
+      QFile::remove(partitionRoot.filePath(month + ".json"));
+    }
+  }
+
+  QJsonArray partitions;
+  for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+    QJsonObject partition;
+    partition["month"] = it.key();
+    partition["file"] = it.key() + ".json";
+    partition["count"] = it.value();
+    QString idFilter = filters.value(it.key()).toBase64();
+    if (!idFilter.isEmpty()) partition["idFilter"] = idFilter;
+    // 仍未载入的分区文件没有改写，改名留到下次载入时应用
+    if (unloadedPartitions.contains(it.key()) &&
+        pendingRenames.contains(it.key())) {
+      partition["renames"] = renamesToJson(pendingRenames.value(it.key()));
+    }
+    partitions.append(partition);
+  }
+  QJsonObject manifest;
+  manifest["version"] = 1;
+  manifest["partitions"] = partitions;
+
+  // 清单最后写入，同样先写临时文件再重命名
+  QString manifestFilename = partitionRoot.filePath("manifest.json");
+  QFile file(manifestFilename + ".tmp");
+  if (!file.open(QIODevice::WriteOnly)) {
+    qDebug() << "无法写入分区清单：" << manifestFilename;
+    return false;
+  }
+  QByteArray data = QJsonDocument(manifest).toJson();
+  bool written = file.write(data) == data.size();
+  file.close();
+  if (QFile::exists(manifestFilename)) {
+    QFile::remove(manifestFilename);
+  }
+  if (!written || !QFile::rename(file.fileName(), manifestFilename)) {
+    qDebug() << "分区清单写入失败：" << manifestFilename;
+    QFile::remove(file.fileName());
+    return false;
+  }
+
+  partitionDir = dir;
+  knownPartitions = QSet<QString>::fromList(counts.keys());
+  return true;
+}
+
+int AppointmentManager::ensureLoaded(const QDate& from, const QDate& to) {
+  QStringList months = unloadedMonths(from, to);
+  if (months.isEmpty()) return 0;
+
+  int loadedCount = loadPartitionMonths(months);
+  if (loadedCount > 0) {
+    emit appointmentsReset();
+  }
+  return loadedCount;
+}
+
+QString AppointmentManager::oldestPartitionBefore(const QDate& cutoff) const {
+  // 未载入的历史分区只考虑整月早于 cutoff 所在月的
+  QString cutoffKey = partitionKey(cutoff);
+  QString oldest;
+  for (auto it = unloadedPartitions.constBegin();
+       it != unloadedPartitions.constEnd(); ++it) {
+    if (it.key() != "undated" && it.key() < cutoffKey) {
+      oldest = it.key();
+      break;  // QMap 按月份升序
+    }
+  }
+
+  QDate earliest;
+  for (auto it = datePositions.constBegin(); it != datePositions.constEnd();
+       ++it) {
+    QDate date = QDate::fromJulianDay(it.key());
+    if (date < cutoff && (!earliest.isValid() || date < earliest)) {
+      earliest = date;
+    }
+  }
+  if (earliest.isValid() &&
+      (oldest.isEmpty() || partitionKey(earliest) < oldest)) {
+    oldest = partitionKey(earliest);
+  }
+  return oldest;
+}
+
+QList<Appointment> AppointmentManager::appointmentsToArchive(
+    const QString& month, const QDate& cutoff) {
+  QDate first = QDate::fromString(month + "-01", "yyyy-MM-dd");
+  if (!first.isValid()) return QList<Appointment>();
+  ensureLoaded(first, first);
+
+  // 逐日取日期索引，只访问该月的预约
+  QList<Appointment> result;
+  for (QDate date = first; date.month() == first.month() && date < cutoff;
+       date = date.addDays(1)) {
+    for (int index : datePositions.value(date.toJulianDay())) {
+      result.append(appointments[index]);
+    }
+  }
+  return result;
+}
+
+int AppointmentManager::removeArchived(const QList<Appointment>& archived) {
+  QSet<QString> keys;
+  for (const Appointment& appointment : archived) {
+    keys.insert(naturalKey(appointment));
+  }
+
+  QList<Appointment> remaining;
+  remaining.reserve(appointments.size());
+  for (const Appointment& appointment : appointments) {
+    if (!keys.contains(naturalKey(appointment))) {
+      remaining.append(appointment);
+    }
+  }
+
+  int removedCount = appointments.size() - remaining.size();
+  if (removedCount > 0) {
+    appointments = remaining;
+    rebuildIndexes();
+    emit appointmentsReset();
+  }
+  qDebug() << "归档后移除预约" << removedCount << "个";
+  return removedCount;
+}
+
+bool AppointmentManager::hasUnloadedPartitions() const {
+  return !unloadedPartitions.isEmpty();
+}
+
+int AppointmentManager::partitionFileReads() const { return partitionReads; }
+
+QStringList AppointmentManager::unloadedMonths(const QDate& from,
+                                               const QDate& to) const {
+  QString fromKey = partitionKey(from);
+  QString toKey = partitionKey(to);
+  QStringList months;
+  for (auto it = unloadedPartitions.constBegin();
+       it != unloadedPartitions.constEnd(); ++it) {
+    if ((!from.isValid() || it.key() >= fromKey) &&
+        (!to.isValid() || it.key() <= toKey)) {
+      months.append(it.key());
+    }
+  }
+  return months;
+}
+
+QStringList AppointmentManager::unloadedPartitionFiles() const {
+  QStringList files;
+  for (auto it = unloadedPartitions.constBegin();
+       it != unloadedPartitions.constEnd(); ++it) {
+    files.append(QDir(partitionDir).filePath(it.key() + ".json"));
+  }
+  return files;
+}
+
+QList<Appointment> AppointmentManager::readUnloadedPartition(
+    const QString& month) const {
+  QList<Appointment> records;
+  if (!unloadedPartitions.contains(month) ||
+      !readPartitionFile(month, &records)) {
+    return QList<Appointment>();
+  }
+
+  // 内存中同月的预约（新增或合并导入）优先，经日期索引逐日取出
+  QSet<QString> existing;
+  QDate first = QDate::fromString(month + "-01", "yyyy-MM-dd");
+  for (QDate date = first; date.isValid() && date.month() == first.month();
+       date = date.addDays(1)) {
+    for (int index : datePositions.value(date.toJulianDay())) {
+      existing.insert(naturalKey(appointments[index]));
+    }
+  }
+  if (existing.isEmpty()) return records;
+
+  QList<Appointment> result;
+  for (const Appointment& record : records) {
+    if (!existing.contains(naturalKey(record))) result.append(record);
+  }
+  return result;
+}
+
+int AppointmentManager::loadPartitionMonths(const QStringList& months) {
+  // 内存中已有的同月预约（新增或合并导入）优先，文件中自然键相同的跳过
+  QSet<QString> existing;
+  for (const Appointment& appointment : appointments) {
+    if (months.contains(partitionKey(appointment.appointmentDate))) {
+      existing.insert(naturalKey(appointment));
+    }
+  }
+
+  int loadedCount = 0;
+  for (const QString& month : months) {
+    QList<Appointment> records;
+    if (!readPartitionFile(month, &records)) continue;
+    for (const Appointment& record : records) {
+      if (!existing.contains(naturalKey(record))) {
+        appointments.append(record);
+        loadedCount++;
+      }
+    }
+    unloadedPartitions.remove(month);
+    partitionFilters.remove(month);
+    pendingRenames.remove(month);
+    partitionVisits.remove(month);
+  }
+
+  if (loadedCount > 0) {
+    rebuildIndexes();
+  }
+  qDebug() << "按需载入历史分区" << months << "共" << loadedCount << "个预约";
+  return loadedCount;
+}
+
+bool AppointmentManager::readPartitionFile(const QString& month,
+                                           QList<Appointment>* records) const {
+  partitionReads++;
+  if (!readAppointments(QDir(partitionDir).filePath(month + ".json"),
+                        records)) {
+    return false;
+  }
+  applyRenames(pendingRenames.value(month), records);
+  return true;
+}
+
+void AppointmentManager::applyRenames(const SlotRenames& renames,
+                                      QList<Appointment>* records) {
+  if (renames.isEmpty()) return;
+  for (Appointment& record : *records) {
+    auto expertIt = renames.constFind(record.expertName);
+    if (expertIt == renames.constEnd()) continue;
+    auto it = expertIt.value().constFind(record.serviceTime);
+    if (it != expertIt.value().constEnd()) record.serviceTime = it.value();
+  }
+}
+
+void AppointmentManager::composeRenames(SlotRenames* pending,
+                                        const SlotRenames& renames) {
+  for (auto expertIt = renames.constBegin(); expertIt != renames.constEnd();
+       ++expertIt) {
+    const QHash<QString, QString>& next = expertIt.value();
+    QHash<QString, QString>& current = (*pending)[expertIt.key()];
+
+    // 文件中的时间段 s 最终变为 next(current(s))：已有的改名接上新的，
+    // 文件中尚未改过名的时间段直接按新的改名
+    QHash<QString, QString> composed;
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+      composed.insert(it.key(), next.value(it.value(), it.value()));
+    }
+    for (auto it = next.constBegin(); it != next.constEnd(); ++it) {
+      if (!current.contains(it.key())) composed.insert(it.key(), it.value());
+    }
+    for (auto it = composed.begin(); it != composed.end();) {
+      if (it.key() == it.value()) {
+        it = composed.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    if (composed.isEmpty()) {
+      pending->remove(expertIt.key());
+    } else {
+      current = composed;
+    }
+  }
+}
+
+AppointmentManager::SlotRenames AppointmentManager::renamesFromJson(
+    const QJsonObject& obj) {
+  SlotRenames renames;
+  for (auto expertIt = obj.constBegin(); expertIt != obj.constEnd();
+       ++expertIt) {
+    QJsonObject slotRenames = expertIt.value().toObject();
+    for (auto it = slotRenames.constBegin(); it != slotRenames.constEnd();
+         ++it) {
+      renames[expertIt.key()].insert(it.key(), it.value().toString());
+    }
+  }
+  return renames;
+}
+
+QJsonObject AppointmentManager::renamesToJson(const SlotRenames& renames) {
+  QJsonObject obj;
+  for (auto expertIt = renames.constBegin(); expertIt != renames.constEnd();
+       ++expertIt) {
+    QJsonObject slotRenames;
+    for (auto it = expertIt.value().constBegin();
+         it != expertIt.value().constEnd(); ++it) {
+      slotRenames[it.key()] = it.value();
+    }
+    obj[expertIt.key()] = slotRenames;
+  }
+  return obj;
+}
+
+QJsonObject AppointmentManager::appointmentToJson(
+    const Appointment& appointment) {
+  QJsonObject appointmentObj;
+  appointmentObj["patientName"] = appointment.patientName;
+  appointmentObj["gender"] = appointment.gender;
+  appointmentObj["age"] = appointment.age;
+  appointmentObj["idNumber"] = appointment.idNumber;
+  appointmentObj["phone"] = appointment.phone;
+  appointmentObj["description"] = appointment.description;
+  appointmentObj["expertName"] = appointment.expertName;
+  appointmentObj["expertSubject"] = appointment.expertSubject;
+  appointmentObj["serviceTime"] = appointment.serviceTime;
+  appointmentObj["queueNumber"] = appointment.queueNumber;
+
+  // 保存日期
+  if (appointment.appointmentDate.isValid()) {
+    appointmentObj["appointmentDate"] =
+        appointment.appointmentDate.toString("yyyy-MM-dd");
+  }
+
+  return appointmentObj;
+}
+
+Appointment AppointmentManager::appointmentFromJson(const QJsonObject& obj) {
+  Appointment appointment;
+
+  appointment.patientName = obj["patientName"].toString();
+  appointment.gender = obj["gender"].toString();
+  appointment.age = obj["age"].toInt();
+  appointment.idNumber = obj["idNumber"].toString();
+  appointment.phone = obj["phone"].toString();
+  appointment.description = obj["description"].toString();
+  appointment.expertName = obj["expertName"].toString();
+  appointment.expertSubject = obj["expertSubject"].toString();
+  appointment.serviceTime = obj["serviceTime"].toString();
+  appointment.queueNumber = obj["queueNumber"].toInt();
+
+  // 加载日期
+  if (obj.contains("appointmentDate")) {
+    appointment.appointmentDate =
+        QDate::fromString(obj["appointmentDate"].toString(), "yyyy-MM-dd");
+  }
+
+  return appointment;
+}
+
+QString AppointmentManager::naturalKey(const Appointment& appointment) {
+  // 患者（优先身份证号）+ 日期 + 专家 + 时间段唯一确定一条预约
+  const QString& patient = appointment.idNumber.isEmpty()
+                               ? appointment.patientName
+                               : appointment.idNumber;
+  return patient + QChar('\x1f') +
+         occupancyKey(appointment.expertName, appointment.appointmentDate,
+                      appointment.serviceTime);
+}
+
+bool AppointmentManager::mergeFromFile(const QString& filename,
+                                       ExpertManager* expertMgr,
+                                       MergeSummary* summary) {
+  JsonArrayReader reader(filename);
+  if (!reader.open()) {
+    qDebug() << reader.errorString();
+    return false;
+  }
+
+  // 以自然键与现有数据做哈希连接，边读边分类
+  QHash<QString, int> indexByKey;
+  for (int i = 0; i < appointments.size(); ++i) {
+    indexByKey.insert(naturalKey(appointments[i]), i);
+  }
+
+  QHash<int, Appointment> updates;
+  QList<Appointment> inserts;
+  QSet<QString> seenKeys;
+  QJsonObject obj;
+  while (reader.next(&obj)) {
+    Appointment incoming = appointmentFromJson(obj);
+    QString key = naturalKey(incoming);
+    if (seenKeys.contains(key)) {
+      summary->rejected++;
+      summary->messages.append(
+          QString("%1：文件内重复记录").arg(incoming.patientName));
+      continue;
+    }
+    seenKeys.insert(key);
+
+    auto it = indexByKey.constFind(key);
+    if (it == indexByKey.constEnd()) {
+      inserts.append(incoming);
+    } else if (appointmentToJson(appointments[it.value()]) !=
+               appointmentToJson(incoming)) {
+      updates.insert(it.value(), incoming);
+    } else {
+      summary->unchanged++;
+    }
+  }
+  if (reader.hasError()) {
+    qDebug() << "合并导入预约数据出错：" << reader.errorString();
+    return false;
+  }
+
+  // 更新与新增在同一批内完成，只发出一次变更通知
+  summary->updated = applyUpdates(updates);
+  QList<Appointment> accepted;
+  QVector<AddStatus> results = validateBatch(inserts, expertMgr, &accepted);
+  for (int i = 0; i < results.size(); ++i) {
+    if (results[i] == Added) continue;
+    summary->rejected++;
+    summary->messages.append(QString("%1 %2：%3")
+                                 .arg(inserts[i].patientName)
+                                 .arg(inserts[i].idNumber)
+                                 .arg(addStatusText(results[i])));
+  }
+  appendBatch(accepted);
+  summary->inserted = accepted.size();
+  if (!accepted.isEmpty()) {
+    emit appointmentsAdded(appointments.size() - accepted.size(),
+                           accepted.size());
+  }
+
+  qDebug() << "合并导入预约数据：" << summary->toText();
+  if (summary->inserted > 0 || summary->updated > 0) {
+    emit appointmentsReset();
+  }
   return true;
 }
 
@@ -190,10 +985,186 @@ bool AppointmentManager::updateAppointment(
         appointments[i].appointmentDate == updatedAppointment.appointmentDate &&
         appointments[i].expertName == updatedAppointment.expertName &&
         appointments[i].serviceTime == updatedAppointment.serviceTime) {
-      appointments[i] = updatedAppointment;
+      updateAppointment(i, updatedAppointment);
       return true;
     }
   }
   return false;
 }
 
+int AppointmentManager::updateAppointments(
+    const QHash<int, Appointment>& updates) {
+  int updatedCount = applyUpdates(updates);
+  qDebug() << "批量更新预约：共" << updatedCount << "个";
+  if (updatedCount > 0) {
+    emit appointmentsReset();
+  }
+  return updatedCount;
+}
+
+int AppointmentManager::applyUpdates(const QHash<int, Appointment>& updates) {
+  int updatedCount = 0;
+  for (auto it = updates.constBegin(); it != updates.constEnd(); ++it) {
+    int index = it.key();
+    if (index < 0 || index >= appointments.size()) continue;
+
+    adjustOccupancy(appointments[index], -1);
+    unindexPosition(appointments[index], index);
+    appointments[index] = it.value();
+    adjustOccupancy(appointments[index], 1);
+    indexPosition(appointments[index], index);
+    updatedCount++;
+  }
+  return updatedCount;
+}
+
+QVector<int> AppointmentManager::appointmentIndexesOn(
+    const QDate& date) const {
+  if (!date.isValid()) return QVector<int>();
+  return datePositions.value(date.toJulianDay());
+}
+
+QVector<int> AppointmentManager::appointmentIndexesInDepartment(
+    const QString& department) const {
+  // 修改预约后下标按重新索引的先后排列，排序后与存储顺序一致
+  QVector<int> indexes = departmentPositions.value(department);
+  std::sort(indexes.begin(), indexes.end());
+  return indexes;
+}
+
+QList<QDate> AppointmentManager::appointmentDates() const {
+  QList<QDate> dates;
+  dates.reserve(datePositions.size());
+  for (qint64 julianDay : datePositions.keys()) {
+    dates.append(QDate::fromJulianDay(julianDay));
+  }
+  return dates;
+}
+
+int AppointmentManager::getSlotOccupancy(const QString& expertName,
+                                         const QDate& date,
+                                         const QString& serviceTime) const {
+  return occupancyIndex.value(occupancyKey(expertName, date, serviceTime), 0);
+}
+
+int AppointmentManager::countInSlot(const QString& expertName,
+                                     const QString& serviceTime,
+                                     const QDate& from) const {
+  const QVector<int> positions =
+      slotPositions.value(slotKey(expertName, serviceTime));
+  if (!from.isValid()) return positions.size();
+
+  int count = 0;
+  for (int index : positions) {
+    if (appointments[index].appointmentDate >= from) count++;
+  }
+  return count;
+}
+
+int AppointmentManager::peakDailyOccupancy(const QString& expertName,
+                                           const QStringList& serviceTimes,
+                                           const QDate& from) const {
+  QHash<qint64, int> dailyCounts;  // 儒略日 -> 人数
+  int peak = 0;
+  for (const QString& serviceTime : serviceTimes) {
+    for (int index : slotPositions.value(slotKey(expertName, serviceTime))) {
+      const QDate& date = appointments[index].appointmentDate;
+      if (!date.isValid() || (from.isValid() && date < from)) continue;
+      peak = qMax(peak, ++dailyCounts[date.toJulianDay()]);
+    }
+  }
+  return peak;
+}
+
+int AppointmentManager::maxQueueNumber(const QString& expertName,
+                                       const QDate& date,
+                                       const QString& serviceTime) const {
+  int maxNumber = 0;
+  for (int index : appointmentIndexesOn(date)) {
+    const Appointment& appointment = appointments[index];
+    if (appointment.expertName == expertName &&
+        appointment.serviceTime == serviceTime) {
+      maxNumber = qMax(maxNumber, appointment.queueNumber);
+    }
+  }
+  return maxNumber;
+}
+
+quint64 AppointmentManager::generation() const { return changeGeneration; }
+
+quint64 AppointmentManager::expertGeneration(const QString& expertName) const {
+  return expertGenerations.value(expertName, 0);
+}
+
+QString AppointmentManager::occupancyKey(const QString& expertName,
+                                         const QDate& date,
+                                         const QString& serviceTime) {
+  // 使用不会出现在姓名/时间段中的分隔符拼接复合键
+  return expertName + QChar('\x1f') + QString::number(date.toJulianDay()) +
+         QChar('\x1f') + serviceTime;
+}
+
+QString AppointmentManager::slotKey(const QString& expertName,
+                                    const QString& serviceTime) {
+  return expertName + QChar('\x1f') + serviceTime;
+}
+
+void AppointmentManager::adjustOccupancy(const Appointment& appointment,
+                                         int delta) {
+  ++changeGeneration;
+  expertGenerations.insert(appointment.expertName, changeGeneration);
+
+  // 未选定日期或时间段的预约不占用名额
+  if (!appointment.appointmentDate.isValid() ||
+      appointment.serviceTime.isEmpty()) {
+    return;
+  }
+
+  QString key = occupancyKey(appointment.expertName,
+                             appointment.appointmentDate,
+                             appointment.serviceTime);
+  int count = occupancyIndex.value(key, 0) + delta;
+  if (count > 0) {
+    occupancyIndex.insert(key, count);
+  } else {
+    occupancyIndex.remove(key);
+  }
+}
+
+void AppointmentManager::indexPosition(const Appointment& appointment,
+                                       int index) {
+  slotPositions[slotKey(appointment.expertName, appointment.serviceTime)]
+      .append(index);
+  if (appointment.appointmentDate.isValid()) {
+    datePositions[appointment.appointmentDate.toJulianDay()].append(index);
+  }
+  idPositions[appointment.idNumber].append(index);
+  departmentPositions[appointment.expertSubject].append(index);
+}
+
+void AppointmentManager::unindexPosition(const Appointment& appointment,
+                                         int index) {
+  removePosition(slotPositions,
+                 slotKey(appointment.expertName, appointment.serviceTime),
+                 index);
+  if (appointment.appointmentDate.isValid()) {
+    removePosition(datePositions, appointment.appointmentDate.toJulianDay(),
+                   index);
+  }
+  removePosition(idPositions, appointment.idNumber, index);
+  removePosition(departmentPositions, appointment.expertSubject, index);
+}
+
+void AppointmentManager::rebuildIndexes() {
+  occupancyIndex.clear();
+  slotPositions.clear();
+  datePositions.clear();
+  idPositions.clear();
+  departmentPositions.clear();
+  expertGenerations.clear();
+  ++changeGeneration;
+  for (int i = 0; i < appointments.size(); ++i) {
+    adjustOccupancy(appointments[i], 1);
+    indexPosition(appointments[i], i);
+  }
+}
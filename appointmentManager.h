@@ -1,15 +1,56 @@
 #ifndef APPOINTMENTMANAGER_H
 #define APPOINTMENTMANAGER_H
 
+#include <QCache>
+#include <QHash>
 #include <QList>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
 
 #include "appointment.h"
+#include "bloomFilter.h"
+#include "jsonImport.h"
+
+class AppointmentArchive;
+class ExpertManager;
+
+class AppointmentManager : public QObject {
+  Q_OBJECT
 
-class AppointmentManager {
  public:
-  AppointmentManager();
+  // 批量添加时单条预约的校验结果
+  enum AddStatus {
+    Added = 0,          // 已添加
+    DuplicateIdNumber,  // 身份证号已有预约（含同批次内重复）
+    ExpertNotFound,     // 专家不存在
+    ExpertUnavailable,  // 专家该日不出诊或无此时间段
+    SlotFull            // 时间段已约满
+  };
+
+  explicit AppointmentManager(QObject* parent = nullptr);
 
   bool addAppointment(const Appointment& appointment);
+  // 批量添加预约：先按索引一次校验整批（身份证号唯一、专家出诊、时间段
+  // 容量，expertMgr 为空时只校验身份证号），再一次性写入通过的记录并只
+  // 发出一次变更通知；返回与输入一一对应的校验结果。未指定排队号
+  // （<= 0）的记录接在该时间段已有的最大排队号之后；added 非空时返回
+  // 实际写入的记录（按输入顺序，含分配的排队号）
+  QVector<AddStatus> addAppointments(const QList<Appointment>& batch,
+                                     ExpertManager* expertMgr,
+                                     QList<Appointment>* added = nullptr);
+  static QString addStatusText(AddStatus status);
+  // 该身份证号是否已有预约：内存中的预约、未载入的历史分区（布隆过滤器
+  // 排除后只读取可能命中的分区）与归档都算，结果与分区是否载入无关
+  bool hasIdNumber(const QString& idNumber) const;
+  // 设置归档（可为空），身份证号唯一性检查同时查询归档
+  void setArchive(const AppointmentArchive* archive);
+  // 某患者在预约数据中的全部记录：内存中的由身份证号索引给出，未载入的
+  // 历史分区先用清单中的布隆过滤器排除，只读取可能命中的分区（不载入）；
+  // 读取过的分区按身份证号分组缓存，再次查询时不重复解析文件
+  QList<Appointment> visitsByIdNumber(const QString& idNumber) const;
   void removeAppointment(int index);
   void updateAppointment(int index, const Appointment& appointment);
 
@@ -19,12 +60,145 @@ class AppointmentManager {
   void updateServiceTimeForExpert(const QString& expertName,
                                   const QString& oldTime,
                                   const QString& newTime);
+  // 批量重命名时间段（专家 -> {旧时间段 -> 新时间段}），通过专家时间段
+  // 索引只访问受影响的预约，只发出一次变更通知；返回被修改的（内存中
+  // 的）预约数。未载入的历史分区不载入：改名记在该分区名下（随清单保存），
+  // 分区载入或被读取时再应用
+  int remapServiceTimes(
+      const QHash<QString, QHash<QString, QString>>& renamesByExpert);
+  int remapServiceTimes(const QString& expertName,
+                        const QHash<QString, QString>& renames);
   bool saveToFile(const QString& filename) const;
   bool loadFromFile(const QString& filename);
+  // 按月分区存储：目录下每月一个 yyyy-MM.json 加清单 manifest.json。
+  // 只立即载入 fromDate 所在月及以后的分区（fromDate 无效时全部载入），
+  // 更早的历史分区由 ensureLoaded 按需载入；清单不存在时返回 false
+  bool loadPartitions(const QString& dir, const QDate& fromDate);
+  // 写出内存中各月的分区与清单，未载入的历史分区原样保留
+  bool savePartitions(const QString& dir);
+  // 载入与 [from, to] 重叠的历史分区（无效日期表示该端不限），有新数据时
+  // 只发出一次变更通知；返回新载入的预约数
+  int ensureLoaded(const QDate& from, const QDate& to);
+  bool hasUnloadedPartitions() const;  // 是否还有未载入的历史分区
+  // 累计从磁盘读取分区文件的次数（含载入），用于确认过滤器跳过了分区
+  int partitionFileReads() const;
+  // 与 [from, to] 重叠的未载入历史分区（升序，无效日期表示该端不限）
+  QStringList unloadedMonths(const QDate& from, const QDate& to) const;
+  // 直接从磁盘读取一个未载入的历史分区而不载入：已应用待改名的时间段，
+  // 内存中已有同一预约（自然键相同）的记录跳过。供导出与查询逐个分区
+  // 处理，内存占用只与单个分区有关
+  QList<Appointment> readUnloadedPartition(const QString& month) const;
+  // 未载入历史分区的文件路径（按月份升序），供工作线程经
+  // readAppointments 直接读取（不含待应用的改名）
+  QStringList unloadedPartitionFiles() const;
+  // 读取一个预约 JSON 文件；不访问任何对象，可在工作线程中调用
+  static bool readAppointments(const QString& filename,
+                               QList<Appointment>* list);
+  static QString partitionKey(const QDate& date);  // yyyy-MM，无日期为 undated
+  // 患者（优先身份证号）+ 日期 + 专家 + 时间段，唯一确定一条预约
+  static QString naturalKey(const Appointment& appointment);
+
+  // 归档支持：最早一个含 cutoff 之前预约的分区（含未载入的历史分区，
+  // 不含无日期分区），没有时返回空串
+  QString oldestPartitionBefore(const QDate& cutoff) const;
+  // 载入该分区（如尚未载入）并返回其中 cutoff 之前的预约副本
+  QList<Appointment> appointmentsToArchive(const QString& month,
+                                           const QDate& cutoff);
+  // 移除已归档的预约（按自然键匹配），只发出一次变更通知；返回移除条数
+  int removeArchived(const QList<Appointment>& archived);
+  // 合并导入：按自然键（患者+日期+专家+时间段）更新已有预约，新增预约经
+  // addAppointments 的同一套校验；全部完成后只发出一次变更通知
+  bool mergeFromFile(const QString& filename, ExpertManager* expertMgr,
+                     MergeSummary* summary);
   bool updateAppointment(const Appointment& updatedAppointment);
+  // 批量修改预约（下标 -> 新内容），只发出一次变更通知；返回修改条数
+  int updateAppointments(const QHash<int, Appointment>& updates);
+  // 某日期的全部预约下标（由日期索引给出，无需扫描全部预约）
+  QVector<int> appointmentIndexesOn(const QDate& date) const;
+  // 某科室的全部预约下标（升序，由科室索引给出）
+  QVector<int> appointmentIndexesInDepartment(
+      const QString& department) const;
+  QList<QDate> appointmentDates() const;  // 有预约的全部日期（无序）
+
+  // 某专家某日期某时间段的已预约人数（由占用索引 O(1) 给出）
+  int getSlotOccupancy(const QString& expertName, const QDate& date,
+                       const QString& serviceTime) const;
+  // 某专家某时间段 from 起（无效日期表示不限）的预约数，由专家时间段
+  // 索引给出，不扫描全部预约
+  int countInSlot(const QString& expertName, const QString& serviceTime,
+                  const QDate& from = QDate()) const;
+  // 把若干时间段视为一个（合并时间段）后，from 起单日预约人数的最大值
+  int peakDailyOccupancy(const QString& expertName,
+                         const QStringList& serviceTimes,
+                         const QDate& from) const;
+  // 某时间段已有的最大排队号（取消预约后排队号可能不连续，新号应在
+  // 此基础上加一，而不是按人数计算）；经日期索引只访问当天的预约
+  int maxQueueNumber(const QString& expertName, const QDate& date,
+                     const QString& serviceTime) const;
+  quint64 generation() const;  // 预约数据变更代号（每次修改后递增）
+  // 某专家预约数据的变更代号（仅该专家的预约变化时改变）
+  quint64 expertGeneration(const QString& expertName) const;
+
+  static QJsonObject appointmentToJson(const Appointment& appointment);
+  static Appointment appointmentFromJson(const QJsonObject& obj);
+
+ signals:
+  // 单个时间段的预约人数发生变化（新增/删除/修改预约）
+  void slotOccupancyChanged(const QString& expertName, const QDate& date);
+  // 预约数据被整体替换或批量修改
+  void appointmentsReset();
+  // 在末尾追加了 [first, first + count) 的预约（先于上面两个信号发出）
+  void appointmentsAdded(int first, int count);
 
  private: 
   QList<Appointment> appointments;
+  QHash<QString, int> occupancyIndex;  // 专家+日期+时间段 -> 已预约人数
+  QHash<QString, QVector<int>> slotPositions;  // 专家+时间段 -> 预约下标
+  QHash<qint64, QVector<int>> datePositions;   // 日期(儒略日) -> 预约下标
+  QHash<QString, QVector<int>> idPositions;    // 身份证号 -> 预约下标
+  QHash<QString, QVector<int>> departmentPositions;  // 科室 -> 预约下标
+  QHash<QString, quint64> expertGenerations;  // 专家姓名 -> 最近变更代号
+  quint64 changeGeneration;
+  QString partitionDir;                   // 分区目录（未使用分区存储时为空）
+  QMap<QString, int> unloadedPartitions;  // 未载入的历史分区 -> 预约数
+  QHash<QString, BloomFilter> partitionFilters;  // 未载入分区的身份证号过滤器
+  // 专家 -> {旧时间段 -> 新时间段}
+  typedef QHash<QString, QHash<QString, QString>> SlotRenames;
+  QHash<QString, SlotRenames> pendingRenames;  // 未载入分区 -> 待应用的改名
+  // 读取过的未载入分区：身份证号 -> 预约（LRU，成本按预约条数计）
+  typedef QHash<QString, QList<Appointment>> VisitsById;
+  mutable QCache<QString, VisitsById> partitionVisits;
+  QSet<QString> knownPartitions;  // 本次运行读写过的分区（可安全删除）
+  const AppointmentArchive* archive;
+  mutable int partitionReads;  // 分区文件读取次数
+
+  static QString occupancyKey(const QString& expertName, const QDate& date,
+                              const QString& serviceTime);
+  static QString slotKey(const QString& expertName,
+                         const QString& serviceTime);
+  static bool writeAppointments(const QString& filename,
+                                const QList<Appointment>& list);
+  int loadPartitionMonths(const QStringList& months);
+  // 读取分区文件并应用该分区待应用的改名
+  bool readPartitionFile(const QString& month,
+                         QList<Appointment>* records) const;
+  VisitsById unloadedVisits(const QString& month) const;  // 经缓存
+  static void applyRenames(const SlotRenames& renames,
+                           QList<Appointment>* records);
+  // 在 pending 之后再应用 renames 的效果合并进 pending
+  static void composeRenames(SlotRenames* pending,
+                             const SlotRenames& renames);
+  static SlotRenames renamesFromJson(const QJsonObject& obj);
+  static QJsonObject renamesToJson(const SlotRenames& renames);
+  QVector<AddStatus> validateBatch(const QList<Appointment>& batch,
+                                   ExpertManager* expertMgr,
+                                   QList<Appointment>* accepted) const;
+  void appendBatch(const QList<Appointment>& accepted);
+  int applyUpdates(const QHash<int, Appointment>& updates);
+  void adjustOccupancy(const Appointment& appointment, int delta);
+  void indexPosition(const Appointment& appointment, int index);
+  void unindexPosition(const Appointment& appointment, int index);
+  void rebuildIndexes();
 };
 
 #endif
@@ -0,0 +1,159 @@
+#include "availabilityCalendar.h"
+
+#include <QSet>
+
+AvailabilityCalendar::AvailabilityCalendar(AppointmentManager* appointmentMgr,
+                                           int horizonDays)
+    : appointmentManager(appointmentMgr),
+      days(qMax(1, horizonDays)),
+      renderedCalendar(nullptr) {}
+
+int AvailabilityCalendar::horizonDays() const { return days; }
+
+AvailabilityCalendar::DayState AvailabilityCalendar::stateOn(
+    const Expert& expert, const QDate& date) {
+  const Snapshot& snap = snapshot(expert);
+  qint64 offset = snap.startDate.daysTo(date);
+  if (offset < 0 || offset >= days) return Unavailable;
+  return static_cast<DayState>(snap.states[static_cast<int>(offset)]);
+}
+
+bool AvailabilityCalendar::isBookable(const Expert& expert,
+                                      const QDate& date) {
+  DayState state = stateOn(expert, date);
+  return state == Regular || state == Special;
+}
+
+bool AvailabilityCalendar::hasBookableDate(const Expert& expert) {
+  return firstBookableDate(expert).isValid();
+}
+
+QDate AvailabilityCalendar::firstBookableDate(const Expert& expert) {
+  const Snapshot& snap = snapshot(expert);
+  for (int day = 0; day < snap.states.size(); ++day) {
+    quint8 state = snap.states[day];
+    if (state == Regular || state == Special) {
+      return snap.startDate.addDays(day);
+    }
+  }
+  return QDate();
+}
+
+void AvailabilityCalendar::render(QCalendarWidget* calendar,
+                                  const Expert& expert,
+                                  const QVector<QTextCharFormat>& formats) {
+  if (!calendar) return;
+
+  const Snapshot& snap = snapshot(expert);
+  QString key = QString("%1|%2|%3|%4")
+                    .arg(expert.name)
+                    .arg(snap.startDate.toJulianDay())
+                    .arg(snap.scheduleGeneration)
+                    .arg(snap.appointmentGeneration);
+  if (calendar == renderedCalendar && key == renderedKey) return;
+
+  // 暂停重绘，清除旧格式后一次性写入，最后统一刷新
+  calendar->setUpdatesEnabled(false);
+  calendar->setDateTextFormat(QDate(), QTextCharFormat());
+
+  for (int day = 0; day < snap.states.size(); ++day) {
+    int state = snap.states[day];
+    if (state < formats.size() && !formats[state].properties().isEmpty()) {
+      calendar->setDateTextFormat(snap.startDate.addDays(day), formats[state]);
+    }
+  }
+
+  // 窗口以外的特殊出诊/停诊日期照常标记
+  QDate endDate = snap.startDate.addDays(days - 1);
+  if (Special < formats.size()) {
+    for (const QDate& date : expert.scheduleDates) {
+      if (date < snap.startDate || date > endDate) {
+        calendar->setDateTextFormat(date, formats[Special]);
+      }
+    }
+  }
+  if (Closed < formats.size()) {
+    for (const QDate& date : expert.closedDates) {
+      if (date < snap.startDate || date > endDate) {
+        calendar->setDateTextFormat(date, formats[Closed]);
+      }
+    }
+  }
+
+  calendar->setUpdatesEnabled(true);
+  renderedCalendar = calendar;
+  renderedKey = key;
+}
+
+const AvailabilityCalendar::Snapshot& AvailabilityCalendar::snapshot(
+    const Expert& expert) {
+  Snapshot& snap = cache[expert.name];
+  quint64 appointmentGeneration =
+      appointmentManager ? appointmentManager->expertGeneration(expert.name)
+                         : 0;
+
+  if (snap.states.isEmpty() || snap.startDate != QDate::currentDate() ||
+      snap.scheduleGeneration != expert.scheduleGeneration ||
+      snap.appointmentGeneration != appointmentGeneration) {
+    compute(expert, snap);
+    snap.appointmentGeneration = appointmentGeneration;
+  }
+  return snap;
+}
+
+void AvailabilityCalendar::compute(const Expert& expert,
+                                   Snapshot& snap) const {
+  snap.startDate = QDate::currentDate();
+  snap.scheduleGeneration = expert.scheduleGeneration;
+  snap.states.fill(Unavailable, days);
+
+  // 预先整理停诊/特殊出诊日期与常规出诊星期，避免逐日线性查找
+  QSet<qint64> closedDays;
+  for (const QDate& date : expert.closedDates) {
+    closedDays.insert(date.toJulianDay());
+  }
+  QSet<qint64> specialDays;
+  for (const QDate& date : expert.scheduleDates) {
+    specialDays.insert(date.toJulianDay());
+  }
+  bool regularWeekdays[8] = {false};  // 下标为 QDate::dayOfWeek()
+  for (int day = 0; day < 7; ++day) {
+    QDate date = snap.startDate.addDays(day);
+    QString dayOfWeek = Expert::getDayOfWeekString(date);
+    for (const QString& timeSlot : expert.serviceTimes) {
+      if (timeSlot.startsWith(dayOfWeek)) {
+        regularWeekdays[date.dayOfWeek()] = true;
+        break;
+      }
+    }
+  }
+
+  for (int day = 0; day < days; ++day) {
+    QDate date = snap.startDate.addDays(day);
+    qint64 julian = date.toJulianDay();
+    snap.states[day] = static_cast<quint8>(computeState(
+        expert, date, closedDays.contains(julian),
+        specialDays.contains(julian), regularWeekdays[date.dayOfWeek()]));
+  }
+}
+
+AvailabilityCalendar::DayState AvailabilityCalendar::computeState(
+    const Expert& expert, const QDate& date, bool isClosed, bool isSpecial,
+    bool isRegular) const {
+  if (isClosed) return Closed;
+  if (!isSpecial && !isRegular) return Unavailable;
+
+  DayState openState = isSpecial ? Special : Regular;
+  if (!appointmentManager) return openState;
+
+  // 所有时间段均已约满则标记为“已满”
+  QStringList daySlots = expert.getAvailableTimeSlotsForDate(date);
+  if (daySlots.isEmpty()) return openState;
+  for (const QString& slot : daySlots) {
+    if (appointmentManager->getSlotOccupancy(expert.name, date, slot) <
+        expert.getTimeSlotCapacity(slot)) {
+      return openState;
+    }
+  }
+  return Full;
+}
@@ -0,0 +1,61 @@
+#ifndef AVAILABILITYCALENDAR_H
+#define AVAILABILITYCALENDAR_H
+
+#include <QCalendarWidget>
+#include <QDate>
+#include <QHash>
+#include <QTextCharFormat>
+#include <QVector>
+
+#include "appointmentManager.h"
+#include "expert.h"
+
+// 专家出诊日历缓存：为每位专家预先计算“今天起 N 天”的日状态数组，
+// 由专家排班代号与该专家的预约代号共同决定是否失效。
+class AvailabilityCalendar {
+ public:
+  enum DayState {
+    Unavailable = 0,  // 非出诊日
+    Regular,          // 常规出诊日
+    Special,          // 特殊出诊日
+    Closed,           // 特殊停诊日
+    Full,             // 出诊但所有时间段已约满
+    DayStateCount
+  };
+
+  explicit AvailabilityCalendar(AppointmentManager* appointmentMgr,
+                                int horizonDays = 60);
+
+  int horizonDays() const;
+  DayState stateOn(const Expert& expert, const QDate& date);
+  // 可预约指出诊且还有余号（Regular / Special），已约满的日期不算
+  bool isBookable(const Expert& expert, const QDate& date);
+  bool hasBookableDate(const Expert& expert);  // 窗口内是否有可预约日
+  QDate firstBookableDate(const Expert& expert);  // 没有时返回无效日期
+
+  // 按状态格式表批量写入日历控件；缓存与上次绘制一致时直接跳过。
+  // formats 以 DayState 为下标，未设置任何属性的格式表示该状态不着色。
+  void render(QCalendarWidget* calendar, const Expert& expert,
+              const QVector<QTextCharFormat>& formats);
+
+ private:
+  struct Snapshot {
+    QDate startDate;
+    quint64 scheduleGeneration = 0;
+    quint64 appointmentGeneration = 0;
+    QVector<quint8> states;  // 每天一个 DayState
+  };
+
+  AppointmentManager* appointmentManager;
+  int days;
+  QHash<QString, Snapshot> cache;  // 专家姓名 -> 日历快照
+  QCalendarWidget* renderedCalendar;
+  QString renderedKey;  // 上次绘制的快照标识
+
+  const Snapshot& snapshot(const Expert& expert);
+  void compute(const Expert& expert, Snapshot& snap) const;
+  DayState computeState(const Expert& expert, const QDate& date,
+                        bool isClosed, bool isSpecial, bool isRegular) const;
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include "availabilityIndex.h"
+
+#include <QDebug>
+#include <QtAlgorithms>
+#include <algorithm>
+
+AvailabilityIndex::AvailabilityIndex(ExpertManager* expertMgr,
+                                     AppointmentManager* appointmentMgr,
+                                     int horizonDays, QObject* parent)
+    : QObject(parent),
+      expertManager(expertMgr),
+      appointmentManager(appointmentMgr),
+      days(qMax(1, horizonDays)),
+      wordsPerDay(0),
+      dirty(true),
+      rosterGeneration(0) {
+  if (appointmentManager) {
+    connect(appointmentManager, &AppointmentManager::slotOccupancyChanged,
+            this, &AvailabilityIndex::onSlotOccupancyChanged);
+    connect(appointmentManager, &AppointmentManager::appointmentsReset, this,
+            &AvailabilityIndex::invalidate);
+  }
+}
+
+void AvailabilityIndex::setHorizonDays(int horizonDays) {
+  horizonDays = qMax(1, horizonDays);
+  if (horizonDays != days) {
+    days = horizonDays;
+    dirty = true;
+  }
+}
+
+int AvailabilityIndex::horizonDays() const { return days; }
+
+void AvailabilityIndex::invalidate() { dirty = true; }
+
+bool AvailabilityIndex::hasFreeCapacity(const QString& expertName,
+                                        const QDate& date) {
+  ensureFresh();
+  int day = dayOffset(date);
+  int column = columnByName.value(expertName, -1);
+  if (day < 0 || column < 0) return false;
+
+  quint64 word = bits[day * wordsPerDay + column / 64];
+  return (word >> (column % 64)) & 1ULL;
+}
+
+bool AvailabilityIndex::covers(const QDate& date) const {
+  QDate today = QDate::currentDate();
+  return date >= today && date < today.addDays(days);
+}
+
+QStringList AvailabilityIndex::freeExperts(const QDate& date,
+                                           const QString& department) {
+  QStringList result;
+  ensureFresh();
+
+  int day = dayOffset(date);
+  if (day < 0) return result;
+
+  bool found = true;
+  const QVector<quint64>* mask = maskFor(department, &found);
+  if (!found) return result;
+
+  const quint64* row = bits.constData() + day * wordsPerDay;
+  for (int w = 0; w < wordsPerDay; ++w) {
+    quint64 word = mask ? (row[w] & mask->at(w)) : row[w];
+    while (word) {
+      int column = w * 64 + qCountTrailingZeroBits(word);
+      result.append(expertManager->experts[column].name);
+      word &= word - 1;  // 清除最低位的 1
+    }
+  }
+  return result;
+}
+
+int AvailabilityIndex::countFreeExperts(const QDate& date,
+                                        const QString& department) {
+  ensureFresh();
+
+  int day = dayOffset(date);
+  if (day < 0) return 0;
+
+  bool found = true;
+  const QVector<quint64>* mask = maskFor(department, &found);
+  if (!found) return 0;
+
+  int count = 0;
+  const quint64* row = bits.constData() + day * wordsPerDay;
+  for (int w = 0; w < wordsPerDay; ++w) {
+    quint64 word = mask ? (row[w] & mask->at(w)) : row[w];
+    count += qPopulationCount(word);
+  }
+  return count;
+}
+
+void AvailabilityIndex::onSlotOccupancyChanged(const QString& expertName,
+                                               const QDate& date) {
+  // 索引尚未建立或专家名单已变化时，等待下次查询整体重建
+  if (dirty || !expertManager ||
+      rosterGeneration != expertManager->generation()) {
+    return;
+  }
+
+  int day = dayOffset(date);
+  int column = columnByName.value(expertName, -1);
+  if (day < 0 || column < 0 || column >= expertManager->experts.size()) {
+    return;
+  }
+
+  refreshCell(column, day);
+}
+
+void AvailabilityIndex::ensureFresh() {
+  if (!expertManager || !appointmentManager) return;
+
+  const QList<Expert>& experts = expertManager->experts;
+  if (dirty || rosterGeneration != expertManager->generation() ||
+      expertGenerations.size() != experts.size()) {
+    rebuild();
+    return;
+  }
+
+  // 日期变化后滚动窗口，只计算新进入窗口的日期
+  QDate today = QDate::currentDate();
+  if (startDate != today) {
+    qint64 offset = startDate.daysTo(today);
+    if (offset <= 0 || offset >= days) {
+      rebuild();
+      return;
+    }
+    shiftWindow(static_cast<int>(offset));
+  }
+
+  // 排班被修改过的专家只重算其所在列
+  for (int column = 0; column < experts.size(); ++column) {
+    if (expertGenerations[column] != experts[column].scheduleGeneration) {
+      refreshColumn(column);
+    }
+  }
+}
+
+void AvailabilityIndex::rebuild() {
+  const QList<Expert>& experts = expertManager->experts;
+
+  startDate = QDate::currentDate();
+  wordsPerDay = (experts.size() + 63) / 64;
+  bits.fill(0, days * wordsPerDay);
+  expertGenerations.fill(0, experts.size());
+  columnByName.clear();
+  departmentMasks.clear();
+
+  for (int column = 0; column < experts.size(); ++column) {
+    const Expert& expert = experts[column];
+    if (!columnByName.contains(expert.name)) {
+      columnByName.insert(expert.name, column);
+    }
+
+    QVector<quint64>& mask = departmentMasks[expert.subject];
+    if (mask.isEmpty()) mask.fill(0, wordsPerDay);
+    mask[column / 64] |= 1ULL << (column % 64);
+
+    refreshColumn(column);
+  }
+
+  rosterGeneration = expertManager->generation();
+  dirty = false;
+  qDebug() << "余号位图索引重建完成：" << experts.size() << "位专家，" << days
+           << "天";
+}
+
+void AvailabilityIndex::shiftWindow(int offset) {
+  // 整行前移 offset 天，尾部新日期清零后重新计算
+  std::copy(bits.begin() + offset * wordsPerDay, bits.end(), bits.begin());
+  std::fill(bits.end() - offset * wordsPerDay, bits.end(), 0);
+  startDate = startDate.addDays(offset);
+
+  for (int column = 0; column < expertGenerations.size(); ++column) {
+    for (int day = days - offset; day < days; ++day) {
+      refreshCell(column, day);
+    }
+  }
+}
+
+void AvailabilityIndex::refreshColumn(int column) {
+  for (int day = 0; day < days; ++day) {
+    refreshCell(column, day);
+  }
+  expertGenerations[column] =
+      expertManager->experts[column].scheduleGeneration;
+}
+
+void AvailabilityIndex::refreshCell(int column, int day) {
+  const Expert& expert = expertManager->experts[column];
+  quint64& word = bits[day * wordsPerDay + column / 64];
+  quint64 bit = 1ULL << (column % 64);
+
+  if (computeFree(expert, startDate.addDays(day))) {
+    word |= bit;
+  } else {
+    word &= ~bit;
+  }
+}
+
+bool AvailabilityIndex::computeFree(const Expert& expert,
+                                    const QDate& date) const {
+  if (!expert.isAvailableOnDate(date)) return false;
+
+  for (const QString& slot : expert.getAvailableTimeSlotsForDate(date)) {
+    if (appointmentManager->getSlotOccupancy(expert.name, date, slot) <
+        expert.getTimeSlotCapacity(slot)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int AvailabilityIndex::dayOffset(const QDate& date) const {
+  if (!date.isValid() || !startDate.isValid()) return -1;
+  qint64 offset = startDate.daysTo(date);
+  return (offset >= 0 && offset < days) ? static_cast<int>(offset) : -1;
+}
+
+const QVector<quint64>* AvailabilityIndex::maskFor(const QString& department,
+                                                   bool* found) const {
+  *found = true;
+  if (department.isEmpty()) return nullptr;  // 不过滤科室
+
+  auto it = departmentMasks.constFind(department);
+  if (it == departmentMasks.constEnd()) {
+    *found = false;
+    return nullptr;
+  }
+  return &it.value();
+}
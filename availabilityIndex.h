@@ -0,0 +1,67 @@
+#ifndef AVAILABILITYINDEX_H
+#define AVAILABILITYINDEX_H
+
+#include <QDate>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "appointmentManager.h"
+#include "expertManager.h"
+
+// 专家余号位图索引：在“今天起 N 天”的滚动窗口内按 日期 × 专家 维护
+// “是否仍有可预约名额”，科室过滤通过按字与运算 + popcount 完成。
+class AvailabilityIndex : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit AvailabilityIndex(ExpertManager* expertMgr,
+                             AppointmentManager* appointmentMgr,
+                             int horizonDays = 60, QObject* parent = nullptr);
+
+  void setHorizonDays(int days);  // 设置滚动窗口天数（至少1天）
+  int horizonDays() const;
+  bool covers(const QDate& date) const;  // 日期是否在今天起的窗口内
+
+  // 指定专家在某日期是否还有余号
+  bool hasFreeCapacity(const QString& expertName, const QDate& date);
+  // 某日期（可按科室过滤）仍有余号的专家姓名
+  QStringList freeExperts(const QDate& date,
+                          const QString& department = QString());
+  // 某日期（可按科室过滤）仍有余号的专家数量
+  int countFreeExperts(const QDate& date,
+                       const QString& department = QString());
+
+ public slots:
+  void invalidate();  // 标记索引整体失效，下次查询时重建
+
+ private slots:
+  void onSlotOccupancyChanged(const QString& expertName, const QDate& date);
+
+ private:
+  ExpertManager* expertManager;
+  AppointmentManager* appointmentManager;
+  int days;         // 窗口天数
+  int wordsPerDay;  // 每天一行所需的 64 位字数
+  QDate startDate;  // 窗口第一天
+  bool dirty;       // 是否需要整体重建
+  quint64 rosterGeneration;  // 建立索引时的专家名单代号
+
+  QVector<quint64> bits;  // days × wordsPerDay，第 c 位表示第 c 个专家有余号
+  QVector<quint64> expertGenerations;  // 每列对应专家的排班代号
+  QHash<QString, int> columnByName;    // 专家姓名 -> 列号
+  QHash<QString, QVector<quint64>> departmentMasks;  // 科室 -> 专家位掩码
+
+  void ensureFresh();  // 滚动窗口并刷新排班有变化的列
+  void rebuild();
+  void shiftWindow(int offset);
+  void refreshColumn(int column);
+  void refreshCell(int column, int day);
+  bool computeFree(const Expert& expert, const QDate& date) const;
+  int dayOffset(const QDate& date) const;  // 超出窗口返回 -1
+  const QVector<quint64>* maskFor(const QString& department,
+                                  bool* found) const;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "bloomFilter.h"
+
+static const int kBitsPerKey = 10;  // 约1%误报率
+static const int kHashCount = 7;
+
+BloomFilter::BloomFilter() : hashCount(0) {}
+
+BloomFilter::BloomFilter(int expectedCount) : hashCount(kHashCount) {
+  int bitCount = qMax(64, expectedCount * kBitsPerKey);
+  bits = QByteArray((bitCount + 7) / 8, '\0');
+}
+
+void BloomFilter::insert(const QString& key) {
+  if (isNull()) return;
+
+  quint64 h1 = 0;
+  quint64 h2 = 0;
+  hashes(key, &h1, &h2);
+  quint64 bitCount = quint64(bits.size()) * 8;
+  for (int i = 0; i < hashCount; ++i) {
+    quint64 bit = (h1 + quint64(i) * h2) % bitCount;
+    bits[int(bit / 8)] = char(bits[int(bit / 8)] | (1 << (bit % 8)));
+  }
+}
+
+bool BloomFilter::mightContain(const QString& key) const {
+  if (isNull()) return true;
+
+  quint64 h1 = 0;
+  quint64 h2 = 0;
+  hashes(key, &h1, &h2);
+  quint64 bitCount = quint64(bits.size()) * 8;
+  for (int i = 0; i < hashCount; ++i) {
+    quint64 bit = (h1 + quint64(i) * h2) % bitCount;
+    if (!(bits[int(bit / 8)] & (1 << (bit % 8)))) return false;
+  }
+  return true;
+}
+
+bool BloomFilter::isNull() const { return hashCount <= 0 || bits.isEmpty(); }
+
+QString BloomFilter::toBase64() const {
+  if (isNull()) return QString();
+  QByteArray data;
+  data.append(char(hashCount));
+  data.append(bits);
+  return QString::fromLatin1(data.toBase64());
+}
+
+BloomFilter BloomFilter::fromBase64(const QString& text) {
+  BloomFilter filter;
+  QByteArray data = QByteArray::fromBase64(text.toLatin1());
+  if (data.size() < 2) return filter;
+  filter.hashCount = quint8(data[0]);
+  filter.bits = data.mid(1);
+  return filter;
+}
+
+// 双重哈希：一次 FNV-1a 64 位得到 h1，再混合出 h2（保证为奇数）
+void BloomFilter::hashes(const QString& key, quint64* h1,
+                         quint64* h2) const {
+  quint64 hash = 14695981039346656037ULL;
+  for (QChar ch : key) {
+    hash ^= ch.unicode();
+    hash *= 1099511628211ULL;
+  }
+  *h1 = hash;
+  quint64 mixed = hash ^ (hash >> 33);
+  mixed *= 0xff51afd7ed558ccdULL;
+  mixed ^= mixed >> 33;
+  *h2 = mixed | 1;
+}
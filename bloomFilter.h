@@ -0,0 +1,28 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <QByteArray>
+#include <QString>
+
+// 字符串布隆过滤器：判断某个键“一定不在”集合中（约1%误报，无漏报）。
+// 哈希为自实现的 FNV-1a，不依赖 Qt 版本，序列化后可写入文件长期保存
+class BloomFilter {
+ public:
+  BloomFilter();                           // 空过滤器（视为“可能包含”任何键）
+  explicit BloomFilter(int expectedCount);  // 按预计元素数确定位数
+
+  void insert(const QString& key);
+  bool mightContain(const QString& key) const;
+  bool isNull() const;  // 未建立（如旧版清单中没有过滤器）
+
+  QString toBase64() const;  // 哈希个数(1字节) + 位数组
+  static BloomFilter fromBase64(const QString& text);
+
+ private:
+  QByteArray bits;
+  int hashCount;
+
+  void hashes(const QString& key, quint64* h1, quint64* h2) const;
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include "bulkExport.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QtEndian>
+
+static const int kBlockSize = 1024 * 1024;  // 每次写盘/压缩的数据量
+
+namespace {
+
+// 固定大小缓冲的写入器，满一块即写盘（可选压缩）
+class BlockWriter {
+ public:
+  BlockWriter(QFile* file, bool compress) : file(file), compress(compress) {
+    buffer.reserve(kBlockSize + 4096);
+  }
+
+  bool write(const QByteArray& bytes) {
+    buffer.append(bytes);
+    return buffer.size() < kBlockSize || flush();
+  }
+
+  bool flush() {
+    if (buffer.isEmpty()) return true;
+
+    bool ok;
+    if (compress) {
+      QByteArray block = qCompress(buffer);
+      uchar header[4];
+      qToBigEndian<quint32>(block.size(), header);
+      ok = file->write(reinterpret_cast<const char*>(header), 4) == 4 &&
+           file->write(block) == block.size();
+    } else {
+      ok = file->write(buffer) == buffer.size();
+    }
+    buffer.clear();
+    return ok;
+  }
+
+ private:
+  QFile* file;
+  bool compress;
+  QByteArray buffer;
+};
+
+}  // namespace
+
+// CSV 字段转义；换行替换为空格，保证一条记录只占一行
+static QByteArray csvField(QString value) {
+  value.replace('\r', ' ').replace('\n', ' ');
+  if (value.contains(',') || value.contains('"')) {
+    value.replace("\"", "\"\"");
+    value = "\"" + value + "\"";
+  }
+  return value.toUtf8();
+}
+
+static QByteArray csvRow(const Appointment& appointment) {
+  QByteArray row;
+  row += csvField(appointment.patientName) + ',';
+  row += csvField(appointment.gender) + ',';
+  row += QByteArray::number(appointment.age) + ',';
+  row += csvField(appointment.idNumber) + ',';
+  row += csvField(appointment.phone) + ',';
+  row += csvField(appointment.expertName) + ',';
+  row += csvField(appointment.expertSubject) + ',';
+  row += appointment.appointmentDate.toString("yyyy-MM-dd").toUtf8() + ',';
+  row += csvField(appointment.serviceTime) + ',';
+  row += QByteArray::number(appointment.queueNumber) + ',';
+  row += csvField(appointment.description) + '\n';
+  return row;
+}
+
+ExportOptions ExportOptions::fromFilename(const QString& filename) {
+  ExportOptions options;
+  QString name = filename.toLower();
+  if (name.endsWith(".qz")) {
+    options.compress = true;
+    name.chop(3);
+  }
+  if (name.endsWith(".ndjson") || name.endsWith(".jsonl")) {
+    options.format = Ndjson;
+  } else if (name.endsWith(".json")) {
+    options.format = Json;
+  } else {
+    options.format = Csv;
+  }
+  return options;
+}
+
+BulkExporter::BulkExporter(const AppointmentManager* appointmentMgr)
+    : appointmentManager(appointmentMgr) {}
+
+bool BulkExporter::exportToFile(const QString& filename,
+                                const ExportOptions& options, int* exported,
+                                QString* error) const {
+  *exported = 0;
+  if (!appointmentManager) {
+    *error = "预约管理器未初始化";
+    return false;
+  }
+
+  // 使用临时文件确保原子性写入
+  QString tempFilename = filename + ".tmp";
+  QFile file(tempFilename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    *error = QString("无法打开临时文件进行写入：%1").arg(tempFilename);
+    return false;
+  }
+
+  BlockWriter writer(&file, options.compress);
+  bool ok = true;
+  if (options.format == ExportOptions::Csv) {
+    ok = writer.write(
+        "patientName,gender,age,idNumber,phone,expertName,expertSubject,"
+        "appointmentDate,serviceTime,queueNumber,description\n");
+  } else if (options.format == ExportOptions::Json) {
+    ok = writer.write("[\n");
+  }
+
+  const QList<Appointment>& appointments =
+      appointmentManager->getAllAppointments();
+  auto writeOne = [&](const Appointment& appointment) {
+    if (options.format == ExportOptions::Csv) {
+      ok = ok && writer.write(csvRow(appointment));
+    } else {
+      QJsonDocument doc(AppointmentManager::appointmentToJson(appointment));
+      QByteArray line = doc.toJson(QJsonDocument::Compact);
+      if (options.format == ExportOptions::Json) {
+        // 数组元素之间以逗号分隔，最后一个元素后不加
+        line.prepend(*exported > 0 ? ",\n" : "");
+        ok = ok && writer.write(line);
+      } else {
+        ok = ok && writer.write(line + '\n');
+      }
+    }
+    (*exported)++;
+  };
+
+  // 尚未载入的历史分区逐月从磁盘读出并按条件筛选，不并入内存
+  bool hasRange = options.fromDate.isValid() && options.toDate.isValid();
+  for (const QString& month : appointmentManager->unloadedMonths(
+           hasRange ? options.fromDate : QDate(),
+           hasRange ? options.toDate : QDate())) {
+    if (!ok) break;
+    for (const Appointment& appointment :
+         appointmentManager->readUnloadedPartition(month)) {
+      if (hasRange && (appointment.appointmentDate < options.fromDate ||
+                       appointment.appointmentDate > options.toDate)) {
+        continue;
+      }
+      if (!options.department.isEmpty() &&
+          appointment.expertSubject != options.department) {
+        continue;
+      }
+      writeOne(appointment);
+    }
+  }
+
+  if (hasRange) {
+    // 日期范围由日期索引直接给出，无需扫描全部预约；同时限定科室时
+    // 只在这些预约中比较科室
+    for (QDate date = options.fromDate; ok && date <= options.toDate;
+         date = date.addDays(1)) {
+      for (int index : appointmentManager->appointmentIndexesOn(date)) {
+        if (options.department.isEmpty() ||
+            appointments[index].expertSubject == options.department) {
+          writeOne(appointments[index]);
+        }
+      }
+    }
+  } else if (!options.department.isEmpty()) {
+    // 只限定科室时由科室索引给出该科室的预约
+    for (int index : appointmentManager->appointmentIndexesInDepartment(
+             options.department)) {
+      if (!ok) break;
+      writeOne(appointments[index]);
+    }
+  } else {
+    for (const Appointment& appointment : appointments) {
+      if (!ok) break;
+      writeOne(appointment);
+    }
+  }
+  if (options.format == ExportOptions::Json) {
+    ok = ok && writer.write("\n]\n");
+  }
+  ok = ok && writer.flush();
+  file.close();
+
+  if (!ok) {
+    *error = "写入数据不完整";
+    QFile::remove(tempFilename);
+    return false;
+  }
+
+  // 原子性重命名
+  if (QFile::exists(filename)) {
+    QFile::remove(filename);
+  }
+  if (!QFile::rename(tempFilename, filename)) {
+    *error = QString("无法重命名临时文件到目标文件：%1").arg(filename);
+    QFile::remove(tempFilename);
+    return false;
+  }
+
+  qDebug() << "流式导出" << *exported << "个预约到文件：" << filename;
+  return true;
+}
+
+bool BulkExporter::decompress(const QByteArray& data, QByteArray* out) {
+  out->clear();
+  int pos = 0;
+  while (pos < data.size()) {
+    if (data.size() - pos < 4) return false;
+    quint32 length = qFromBigEndian<quint32>(
+        reinterpret_cast<const uchar*>(data.constData() + pos));
+    pos += 4;
+    if (length > static_cast<quint32>(data.size() - pos)) return false;
+
+    QByteArray block = qUncompress(
+        reinterpret_cast<const uchar*>(data.constData() + pos), length);
+    if (block.isEmpty()) return false;
+    out->append(block);
+    pos += length;
+  }
+  return true;
+}
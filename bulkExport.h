@@ -0,0 +1,54 @@
+#ifndef BULKEXPORT_H
+#define BULKEXPORT_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QString>
+
+#include "appointmentManager.h"
+
+// 导出选项
+struct ExportOptions {
+  enum Format { Csv, Ndjson, Json };
+
+  Format format = Csv;
+  QDate fromDate;      // 与 toDate 均有效时只导出该日期范围（走日期索引）
+  QDate toDate;
+  QString department;  // 为空表示全部科室
+  bool compress = false;  // 按块 qCompress 压缩
+
+  // 按文件名推断格式与压缩：*.ndjson / *.jsonl 为 NDJSON，*.json 为
+  // JSON 数组（与 AppointmentManager::saveToFile 格式相同），其余为 CSV，
+  // 以 .qz 结尾表示压缩
+  static ExportOptions fromFilename(const QString& filename);
+};
+
+// 预约流式导出：逐条写入固定大小的缓冲区，缓冲区满即写盘（可选压缩），
+// 内存占用与数据量无关。尚未载入的历史分区逐月从磁盘读出后直接写出，
+// 不并入内存。CSV 表头与 JSON 字段名一致，可由 BulkImporter 直接导回。
+//
+// 压缩文件（.qz）的格式：文件由若干块依次拼接而成，没有文件头。每块为
+//   4 字节大端无符号整数 N（本块其余部分的字节数）
+//   N 字节的 qCompress 输出：4 字节大端原始长度 + zlib 数据流（RFC 1950）
+// 各块解压后按顺序拼接即为原始 CSV / NDJSON（每块原始数据约 1 MiB，块边界
+// 可能落在一行中间）。应用内由“批量导入”直接读取 .qz 文件；其他工具可
+// 逐块跳过长度字段后用任意 zlib 实现解压，例如 Python：
+//   while data:
+//       n = int.from_bytes(data[:4], "big")
+//       out += zlib.decompress(data[8:4 + n])
+//       data = data[4 + n:]
+class BulkExporter {
+ public:
+  explicit BulkExporter(const AppointmentManager* appointmentMgr);
+
+  bool exportToFile(const QString& filename, const ExportOptions& options,
+                    int* exported, QString* error) const;
+
+  // 还原压缩导出文件的内容，格式错误时返回 false
+  static bool decompress(const QByteArray& data, QByteArray* out);
+
+ private:
+  const AppointmentManager* appointmentManager;
+};
+
+#endif
@@ -0,0 +1,348 @@
+#include "bulkImport.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+#include <algorithm>
+
+#include "bulkExport.h"
+#include "inputValidator.h"
+
+namespace {
+
+// CSV 列对应的预约字段
+enum Field {
+  UnknownField = 0,
+  PatientNameField,
+  GenderField,
+  AgeField,
+  IdNumberField,
+  PhoneField,
+  DescriptionField,
+  ExpertNameField,
+  ExpertSubjectField,
+  ServiceTimeField,
+  QueueNumberField,
+  AppointmentDateField
+};
+
+// 解析后的一行
+struct ParsedRow {
+  int line;  // 块内行号（从 0 开始）
+  Appointment appointment;
+  QString error;  // 为空表示校验通过
+};
+
+struct ChunkResult {
+  QVector<ParsedRow> rows;
+  int lineCount = 0;  // 块内总行数（含空行），用于换算文件行号
+};
+
+// 各工作线程共享的只读上下文
+struct ParseContext {
+  bool csv = false;
+  QVector<Field> columns;                 // CSV 各列对应的字段
+  QHash<QString, const Expert*> experts;  // 专家姓名 -> 专家
+};
+
+}  // namespace
+
+static Field fieldFromName(const QString& name) {
+  static const QHash<QString, Field> fields = {
+      {"patientName", PatientNameField},
+      {"gender", GenderField},
+      {"age", AgeField},
+      {"idNumber", IdNumberField},
+      {"phone", PhoneField},
+      {"description", DescriptionField},
+      {"expertName", ExpertNameField},
+      {"expertSubject", ExpertSubjectField},
+      {"serviceTime", ServiceTimeField},
+      {"queueNumber", QueueNumberField},
+      {"appointmentDate", AppointmentDateField}};
+  return fields.value(name.trimmed(), UnknownField);
+}
+
+QStringList BulkImporter::splitCsvLine(const QString& line) {
+  QStringList fields;
+  QString field;
+  bool quoted = false;
+  for (int i = 0; i < line.size(); ++i) {
+    QChar c = line[i];
+    if (quoted) {
+      if (c != '"') {
+        field += c;
+      } else if (i + 1 < line.size() && line[i + 1] == '"') {
+        field += '"';
+        ++i;
+      } else {
+        quoted = false;
+      }
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == ',') {
+      fields.append(field);
+      field.clear();
+    } else {
+      field += c;
+    }
+  }
+  fields.append(field);
+  return fields;
+}
+
+static void setField(Appointment* appointment, Field field,
+                     const QString& value) {
+  switch (field) {
+    case PatientNameField:
+      appointment->patientName = value.trimmed();
+      break;
+    case GenderField:
+      appointment->gender = value.trimmed();
+      break;
+    case AgeField:
+      appointment->age = value.trimmed().toInt();
+      break;
+    case IdNumberField:
+      appointment->idNumber = value.trimmed();
+      break;
+    case PhoneField:
+      appointment->phone = value.trimmed();
+      break;
+    case DescriptionField:
+      appointment->description = value;
+      break;
+    case ExpertNameField:
+      appointment->expertName = value.trimmed();
+      break;
+    case ExpertSubjectField:
+      appointment->expertSubject = value.trimmed();
+      break;
+    case ServiceTimeField:
+      appointment->serviceTime = value.trimmed();
+      break;
+    case QueueNumberField:
+      appointment->queueNumber = value.trimmed().toInt();
+      break;
+    case AppointmentDateField:
+      appointment->appointmentDate =
+          QDate::fromString(value.trimmed(), "yyyy-MM-dd");
+      break;
+    case UnknownField:
+      break;
+  }
+}
+
+// 不依赖写入顺序的逐行校验；身份证号与电话已由调用方批量校验，
+// 容量与身份证号唯一性留到写入时统一校验
+static QString validateRow(const ParseContext& context,
+                           Appointment* appointment, bool idNumberValid,
+                           bool phoneValid) {
+  if (appointment->patientName.isEmpty()) return "缺少患者姓名";
+  if (!idNumberValid) {
+    return QString("身份证号无效：%1").arg(appointment->idNumber);
+  }
+  if (!phoneValid) {
+    return QString("电话号码无效：%1").arg(appointment->phone);
+  }
+
+  const Expert* expert = context.experts.value(appointment->expertName);
+  if (!expert) return QString("专家不存在：%1").arg(appointment->expertName);
+
+  const QDate& date = appointment->appointmentDate;
+  if (!date.isValid()) return "预约日期无效";
+  if (!expert->isAvailableOnDate(date)) {
+    return QString("专家 %1 在 %2 不出诊")
+        .arg(expert->name)
+        .arg(date.toString("yyyy-MM-dd"));
+  }
+  if (!expert->getAvailableTimeSlotsForDate(date).contains(
+          appointment->serviceTime)) {
+    return QString("时间段不存在：%1").arg(appointment->serviceTime);
+  }
+
+  if (appointment->expertSubject.isEmpty()) {
+    appointment->expertSubject = expert->subject;
+  }
+  return QString();
+}
+
+// 在工作线程中解析并校验一块数据（只读访问上下文）
+static ChunkResult parseChunk(const ParseContext* context,
+                              const QByteArray& data) {
+  ChunkResult result;
+  int start = 0;
+  while (start < data.size()) {
+    int end = data.indexOf('\n', start);
+    if (end < 0) end = data.size();
+    int length = end - start;
+    if (length > 0 && data[end - 1] == '\r') length--;
+
+    int line = result.lineCount++;
+    QString text = QString::fromUtf8(data.constData() + start, length);
+    start = end + 1;
+    if (text.trimmed().isEmpty()) continue;
+
+    ParsedRow row;
+    row.line = line;
+    if (context->csv) {
+      QStringList values = BulkImporter::splitCsvLine(text);
+      int count = qMin(values.size(), context->columns.size());
+      for (int i = 0; i < count; ++i) {
+        setField(&row.appointment, context->columns[i], values[i]);
+      }
+    } else {
+      QJsonDocument doc = QJsonDocument::fromJson(text.toUtf8());
+      if (!doc.isObject()) {
+        row.error = "无效的JSON对象";
+        result.rows.append(row);
+        continue;
+      }
+      row.appointment = AppointmentManager::appointmentFromJson(doc.object());
+    }
+    result.rows.append(row);
+  }
+
+  // 整块的身份证号与电话号码一次批量校验
+  QStringList idNumbers;
+  QStringList phones;
+  for (const ParsedRow& row : result.rows) {
+    idNumbers.append(row.appointment.idNumber);
+    phones.append(row.appointment.phone);
+  }
+  QVector<bool> idNumberValid = InputValidator::validateIdNumbers(idNumbers);
+  QVector<bool> phoneValid = InputValidator::validatePhoneNumbers(phones);
+  for (int i = 0; i < result.rows.size(); ++i) {
+    ParsedRow& row = result.rows[i];
+    if (row.error.isEmpty()) {
+      row.error = validateRow(*context, &row.appointment, idNumberValid[i],
+                              phoneValid[i]);
+    }
+  }
+  return result;
+}
+
+BulkImporter::BulkImporter(ExpertManager* expertMgr,
+                           AppointmentManager* appointmentMgr)
+    : expertManager(expertMgr), appointmentManager(appointmentMgr) {}
+
+bool BulkImporter::importFile(const QString& filename,
+                              BulkImportReport* report, QString* error) {
+  if (!expertManager || !appointmentManager) {
+    *error = "数据管理器未初始化";
+    return false;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    *error = QString("无法打开文件：%1").arg(filename);
+    return false;
+  }
+  QByteArray data = file.readAll();
+  file.close();
+
+  // 压缩导出文件先解压，再按去掉 .qz 后的扩展名判断格式
+  QString formatName = filename;
+  if (formatName.endsWith(".qz", Qt::CaseInsensitive)) {
+    QByteArray raw;
+    if (!BulkExporter::decompress(data, &raw)) {
+      *error = QString("压缩文件格式错误：%1").arg(filename);
+      return false;
+    }
+    data = raw;
+    formatName.chop(3);
+  }
+
+  ParseContext context;
+  context.csv = QFileInfo(formatName).suffix().compare(
+                    "csv", Qt::CaseInsensitive) == 0;
+  for (const Expert& expert : expertManager->experts) {
+    if (!context.experts.contains(expert.name)) {
+      context.experts.insert(expert.name, &expert);
+    }
+  }
+
+  int offset = data.startsWith("\xEF\xBB\xBF") ? 3 : 0;  // 跳过 UTF-8 BOM
+  int headerLines = 0;
+  if (context.csv) {
+    int end = data.indexOf('\n', offset);
+    if (end < 0) end = data.size();
+    QString header =
+        QString::fromUtf8(data.constData() + offset, end - offset).trimmed();
+    for (const QString& name : splitCsvLine(header)) {
+      context.columns.append(fieldFromName(name));
+    }
+    if (!context.columns.contains(PatientNameField) ||
+        !context.columns.contains(ExpertNameField)) {
+      *error = "CSV 表头缺少 patientName 或 expertName 列";
+      return false;
+    }
+    offset = end + 1;
+    headerLines = 1;
+  }
+
+  // 按行边界切块，块数为线程数的数倍以平衡负载
+  int threads = qMax(1, QThread::idealThreadCount());
+  int chunkSize = qMax(64 * 1024, (data.size() - offset) / (threads * 4) + 1);
+  QList<QFuture<ChunkResult>> futures;
+  while (offset < data.size()) {
+    int end = qMin(offset + chunkSize, data.size());
+    if (end < data.size()) {
+      int newline = data.indexOf('\n', end - 1);
+      end = newline < 0 ? data.size() : newline + 1;
+    }
+    // 各块直接引用 data 的内存，data 在所有任务完成前保持有效
+    QByteArray chunk =
+        QByteArray::fromRawData(data.constData() + offset, end - offset);
+    futures.append(QtConcurrent::run(parseChunk, &context, chunk));
+    offset = end;
+  }
+
+  // 按原顺序合并各块结果
+  QList<Appointment> batch;
+  QVector<int> batchLines;
+  int lineBase = headerLines;
+  for (QFuture<ChunkResult>& future : futures) {
+    const ChunkResult result = future.result();
+    for (const ParsedRow& row : result.rows) {
+      int line = lineBase + row.line + 1;
+      report->totalRows++;
+      if (!row.error.isEmpty()) {
+        report->errors.append({line, row.error});
+      } else {
+        batch.append(row.appointment);
+        batchLines.append(line);
+      }
+    }
+    lineBase += result.lineCount;
+  }
+
+  // 一次批量写入，容量与身份证号唯一性在此统一校验
+  QVector<AppointmentManager::AddStatus> results =
+      appointmentManager->addAppointments(batch, expertManager);
+  for (int i = 0; i < results.size(); ++i) {
+    if (results[i] == AppointmentManager::Added) {
+      report->accepted++;
+    } else {
+      report->errors.append(
+          {batchLines[i], AppointmentManager::addStatusText(results[i])});
+    }
+  }
+  std::sort(report->errors.begin(), report->errors.end(),
+            [](const ImportRowError& a, const ImportRowError& b) {
+              return a.line < b.line;
+            });
+
+  report->elapsedMs = timer.elapsed();
+  return true;
+}
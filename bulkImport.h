@@ -0,0 +1,48 @@
+#ifndef BULKIMPORT_H
+#define BULKIMPORT_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "appointmentManager.h"
+#include "expertManager.h"
+
+// 批量导入中某一行的错误
+struct ImportRowError {
+  int line;         // 文件中的行号（从 1 开始）
+  QString message;  // 错误原因
+};
+
+// 批量导入结果
+struct BulkImportReport {
+  int totalRows = 0;  // 数据行数（不含表头与空行）
+  int accepted = 0;   // 成功写入的行数
+  qint64 elapsedMs = 0;
+  QList<ImportRowError> errors;  // 按行号排序
+};
+
+// CSV / NDJSON 预约批量导入：文件按行切块后在线程池中并行解析与校验
+// （身份证号、电话、专家与时间段），再按原顺序经 addAppointments
+// 一次写入，容量与身份证号唯一性在写入时统一校验。
+//
+// CSV 首行为表头，列名与 JSON 字段名一致（patientName、idNumber、
+// phone、expertName、appointmentDate、serviceTime 等），字段可用双引号
+// 包裹；NDJSON 每行一个 JSON 对象。文件扩展名 .csv 按 CSV 解析，其余
+// 按 NDJSON 解析；以 .qz 结尾的文件为 BulkExporter 的压缩导出，先解压。
+class BulkImporter {
+ public:
+  BulkImporter(ExpertManager* expertMgr, AppointmentManager* appointmentMgr);
+
+  bool importFile(const QString& filename, BulkImportReport* report,
+                  QString* error);
+
+  // 拆分一行 CSV，支持双引号包裹字段及 "" 转义（不支持字段内换行）
+  static QStringList splitCsvLine(const QString& line);
+
+ private:
+  ExpertManager* expertManager;
+  AppointmentManager* appointmentManager;
+};
+
+#endif
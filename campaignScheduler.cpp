@@ -0,0 +1,188 @@
+#include "campaignScheduler.h"
+
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QTextStream>
+#include <algorithm>
+#include <vector>
+
+#include "bulkImport.h"
+
+CampaignScheduler::CampaignScheduler(ExpertManager* expertMgr,
+                                     AppointmentManager* appointmentMgr)
+    : expertManager(expertMgr), appointmentManager(appointmentMgr) {}
+
+QList<CampaignOutcome> CampaignScheduler::assign(
+    const QList<CampaignPatient>& patients, const QString& department) const {
+  QList<CampaignOutcome> outcomes;
+  outcomes.reserve(patients.size());
+  for (int i = 0; i < patients.size(); ++i) {
+    CampaignOutcome outcome;
+    outcome.patientIndex = i;
+    outcomes.append(outcome);
+  }
+
+  if (!expertManager || !appointmentManager) {
+    for (auto& outcome : outcomes) outcome.reason = "数据管理器未初始化";
+    return outcomes;
+  }
+
+  QDate today = QDate::currentDate();
+
+  // 每个身份证号只能有一个预约：已有预约（含历史分区与归档）由
+  // hasIdNumber 判断，bookedIds 记录本次已分配的
+  QSet<QString> bookedIds;
+
+  // 剩余名额多者优先，名额相同时下标小者优先，保证结果稳定
+  QVector<SlotState> slotStates;
+  auto lessRemaining = [&slotStates](int a, int b) {
+    if (slotStates[a].remaining != slotStates[b].remaining) {
+      return slotStates[a].remaining < slotStates[b].remaining;
+    }
+    return a > b;
+  };
+
+  // 为每个意向日期建立该科室所有时间段的剩余名额堆
+  QHash<qint64, std::vector<int>> heaps;  // 日期(儒略日) -> 时间段堆
+  const QList<Expert>& experts = expertManager->experts;
+  for (const auto& patient : patients) {
+    for (const QDate& date : patient.preferredDates) {
+      if (date < today || heaps.contains(date.toJulianDay())) continue;
+
+      std::vector<int>& heap = heaps[date.toJulianDay()];
+      for (int e = 0; e < experts.size(); ++e) {
+        const Expert& expert = experts[e];
+        if (!department.isEmpty() && expert.subject != department) continue;
+        if (!expert.isAvailableOnDate(date)) continue;
+
+        for (const QString& slot : expert.getAvailableTimeSlotsForDate(date)) {
+          int occupied =
+              appointmentManager->getSlotOccupancy(expert.name, date, slot);
+          int remaining = expert.getTimeSlotCapacity(slot) - occupied;
+          if (remaining <= 0) continue;
+
+          SlotState state;
+          state.expertIndex = e;
+          state.date = date;
+          state.serviceTime = slot;
+          state.remaining = remaining;
+          heap.push_back(slotStates.size());
+          slotStates.append(state);
+        }
+      }
+      std::make_heap(heap.begin(), heap.end(), lessRemaining);
+    }
+  }
+
+  // 意向日期少的患者选择余地小，先分配
+  QVector<int> order(patients.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&patients](int a, int b) {
+    return patients[a].preferredDates.size() <
+           patients[b].preferredDates.size();
+  });
+
+  for (int i : order) {
+    const CampaignPatient& patient = patients[i];
+    CampaignOutcome& outcome = outcomes[i];
+
+    if (patient.info.idNumber.isEmpty()) {
+      outcome.reason = "缺少身份证号";
+      continue;
+    }
+    if (bookedIds.contains(patient.info.idNumber) ||
+        appointmentManager->hasIdNumber(patient.info.idNumber)) {
+      outcome.reason = "该身份证号已有预约";
+      continue;
+    }
+
+    for (int rank = 0; rank < patient.preferredDates.size(); ++rank) {
+      const QDate& date = patient.preferredDates[rank];
+      auto heapIt = heaps.find(date.toJulianDay());
+      if (heapIt == heaps.end() || heapIt.value().empty()) continue;
+
+      // 取出剩余名额最多的时间段，分配后若仍有名额则放回堆中
+      std::vector<int>& heap = heapIt.value();
+      std::pop_heap(heap.begin(), heap.end(), lessRemaining);
+      SlotState& state = slotStates[heap.back()];
+      const Expert& expert = experts[state.expertIndex];
+
+      Appointment appointment = patient.info;
+      appointment.expertName = expert.name;
+      appointment.expertSubject = expert.subject;
+      appointment.appointmentDate = state.date;
+      appointment.serviceTime = state.serviceTime;
+      appointment.queueNumber = 0;  // 写入时由 addAppointments 分配
+
+      state.remaining--;
+      if (state.remaining > 0) {
+        std::push_heap(heap.begin(), heap.end(), lessRemaining);
+      } else {
+        heap.pop_back();
+      }
+
+      outcome.assigned = true;
+      outcome.preferenceRank = rank;
+      outcome.appointment = appointment;
+      bookedIds.insert(patient.info.idNumber);
+      break;
+    }
+
+    if (!outcome.assigned) {
+      outcome.reason = patient.preferredDates.isEmpty()
+                           ? "未填写意向日期"
+                           : "意向日期均无余号";
+    }
+  }
+
+  return outcomes;
+}
+
+bool CampaignScheduler::loadPatients(const QString& filename,
+                                     QList<CampaignPatient>* patients,
+                                     QString* error) {
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    *error = QString("无法打开文件：%1").arg(filename);
+    return false;
+  }
+
+  QTextStream in(&file);
+  in.setCodec("UTF-8");
+
+  int lineNumber = 0;
+  while (!in.atEnd()) {
+    QString line = in.readLine().trimmed();
+    lineNumber++;
+    if (line.isEmpty()) continue;
+
+    // 与批量导入相同的 CSV 规则：含逗号的字段（如症状、地址）可用双引号
+    // 包裹
+    QStringList fields = BulkImporter::splitCsvLine(line);
+    if (lineNumber == 1 && fields[0].trimmed() == "姓名") continue;
+    if (fields.size() < 6) {
+      *error = QString("第 %1 行字段不足").arg(lineNumber);
+      return false;
+    }
+
+    CampaignPatient patient;
+    patient.info.patientName = fields[0].trimmed();
+    patient.info.gender = fields[1].trimmed();
+    patient.info.age = fields[2].trimmed().toInt();
+    patient.info.idNumber = fields[3].trimmed();
+    patient.info.phone = fields[4].trimmed();
+    patient.info.description = "筛查活动批量预约";
+
+    for (const QString& text : fields[5].split(';', QString::SkipEmptyParts)) {
+      QDate date = QDate::fromString(text.trimmed(), "yyyy-MM-dd");
+      if (!date.isValid()) {
+        *error = QString("第 %1 行日期格式错误：%2").arg(lineNumber).arg(text);
+        return false;
+      }
+      patient.preferredDates.append(date);
+    }
+    patients->append(patient);
+  }
+  return true;
+}
@@ -0,0 +1,58 @@
+#ifndef CAMPAIGNSCHEDULER_H
+#define CAMPAIGNSCHEDULER_H
+
+#include <QDate>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "appointment.h"
+#include "appointmentManager.h"
+#include "expertManager.h"
+
+// 筛查活动中的一位患者：基本信息与按优先级排列的意向日期
+struct CampaignPatient {
+  Appointment info;             // 仅使用患者相关字段
+  QList<QDate> preferredDates;  // 第一个为最优先
+};
+
+// 单个患者的分配结果
+struct CampaignOutcome {
+  int patientIndex = -1;    // 在输入列表中的下标
+  bool assigned = false;
+  int preferenceRank = -1;  // 命中的意向日期序号（从 0 开始）
+  Appointment appointment;  // 分配成功时的完整预约（排队号写入时分配）
+  QString reason;           // 分配失败原因
+};
+
+// 筛查活动批量分配：按意向日期少者优先的顺序贪心分配，每个日期维护
+// 一个按剩余容量排序的时间段大顶堆，每次分配为 O(log 时间段数)。
+class CampaignScheduler {
+ public:
+  CampaignScheduler(ExpertManager* expertMgr,
+                    AppointmentManager* appointmentMgr);
+
+  // 为 department 科室（为空表示全部科室）的患者分配时间段；
+  // 返回与输入一一对应的结果，不修改预约数据
+  QList<CampaignOutcome> assign(const QList<CampaignPatient>& patients,
+                                const QString& department) const;
+
+  // 读取患者名单，每行：姓名,性别,年龄,身份证号,电话,日期1;日期2;...
+  // 日期格式 yyyy-MM-dd，首行为表头时自动跳过；字段可用双引号包裹
+  static bool loadPatients(const QString& filename,
+                           QList<CampaignPatient>* patients,
+                           QString* error);
+
+ private:
+  struct SlotState {
+    int expertIndex;
+    QDate date;
+    QString serviceTime;
+    int remaining;  // 剩余名额
+  };
+
+  ExpertManager* expertManager;
+  AppointmentManager* appointmentManager;
+};
+
+#endif
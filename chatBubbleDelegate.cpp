@@ -0,0 +1,118 @@
+#include "chatBubbleDelegate.h"
+
+#include <QFontMetrics>
+#include <QListView>
+#include <QPainter>
+#include <climits>
+
+#include "chatMessageModel.h"
+
+static const int kMargin = 4;    // 行与气泡之间
+static const int kPadding = 8;   // 气泡与文字之间
+static const int kRadius = 10;
+static const int kTextFlags = Qt::TextWordWrap | Qt::TextWrapAnywhere;
+
+ChatBubbleDelegate::ChatBubbleDelegate(QListView* view)
+    : QStyledItemDelegate(view), listView(view) {}
+
+QString ChatBubbleDelegate::senderText(bool isUser) const {
+  return isUser ? "您:" : "AI助手:";
+}
+
+const ChatBubbleDelegate::Layout& ChatBubbleDelegate::layoutFor(
+    const QModelIndex& index) const {
+  int id = index.data(ChatMessageModel::MessageIdRole).toInt();
+  int revision = index.data(ChatMessageModel::RevisionRole).toInt();
+  int width = listView->viewport()->width();
+
+  auto cached = layouts.constFind(id);
+  if (cached != layouts.constEnd() && cached->width == width &&
+      cached->revision == revision) {
+    return *cached;
+  }
+
+  // 已淘汰消息的排版结果随之清理（编号小于第一行的即已淘汰）
+  if (layouts.size() > 2 * index.model()->rowCount()) {
+    int firstId = index.model()
+                      ->index(0, 0)
+                      .data(ChatMessageModel::MessageIdRole)
+                      .toInt();
+    for (auto it = layouts.begin(); it != layouts.end();) {
+      if (it.key() < firstId) {
+        it = layouts.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  Layout& fresh = layouts[id];
+
+  // 气泡最宽占视图的 3/4
+  QFont bold = listView->font();
+  bold.setBold(true);
+  QFontMetrics senderMetrics(bold);
+  QFontMetrics textMetrics(listView->font());
+  bool isUser = index.data(ChatMessageModel::IsUserRole).toBool();
+  int maxTextWidth = qMax(50, width * 3 / 4 - 2 * kPadding);
+  QRect textRect = textMetrics.boundingRect(
+      QRect(0, 0, maxTextWidth, INT_MAX), kTextFlags,
+      index.data(Qt::DisplayRole).toString());
+  int senderWidth = senderMetrics.horizontalAdvance(senderText(isUser));
+
+  fresh.width = width;
+  fresh.revision = revision;
+  fresh.bubble = QSize(qMax(textRect.width(), senderWidth) + 2 * kPadding,
+                       senderMetrics.height() + textRect.height() +
+                           2 * kPadding);
+  fresh.size = QSize(width, fresh.bubble.height() + 2 * kMargin);
+  return fresh;
+}
+
+QSize ChatBubbleDelegate::sizeHint(const QStyleOptionViewItem&,
+                                   const QModelIndex& index) const {
+  return layoutFor(index).size;
+}
+
+void ChatBubbleDelegate::paint(QPainter* painter,
+                               const QStyleOptionViewItem& option,
+                               const QModelIndex& index) const {
+  const Layout& layout = layoutFor(index);
+  bool isUser = index.data(ChatMessageModel::IsUserRole).toBool();
+
+  QRect bubble(QPoint(0, 0), layout.bubble);
+  bubble.moveTop(option.rect.top() + kMargin);
+  if (isUser) {
+    bubble.moveRight(option.rect.right() - kMargin);
+  } else {
+    bubble.moveLeft(option.rect.left() + kMargin);
+  }
+
+  painter->save();
+  painter->setRenderHint(QPainter::Antialiasing);
+  painter->setPen(Qt::NoPen);
+  painter->setBrush(QColor(isUser ? "#DCF8C6" : "#F5F5F5"));
+  painter->drawRoundedRect(bubble, kRadius, kRadius);
+
+  QRect content = bubble.adjusted(kPadding, kPadding, -kPadding, -kPadding);
+  QFont bold = listView->font();
+  bold.setBold(true);
+  painter->setPen(option.palette.color(QPalette::Text));
+  painter->setFont(bold);
+  painter->drawText(content, Qt::AlignLeft | Qt::AlignTop, senderText(isUser));
+
+  content.setTop(content.top() + QFontMetrics(bold).height());
+  painter->setFont(listView->font());
+  painter->drawText(content, kTextFlags | Qt::AlignLeft | Qt::AlignTop,
+                    index.data(Qt::DisplayRole).toString());
+  painter->restore();
+}
+
+void ChatBubbleDelegate::messageChanged(const QModelIndex& topLeft,
+                                        const QModelIndex& bottomRight) {
+  for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+    QModelIndex index = topLeft.sibling(row, 0);
+    int height = layouts.value(
+        index.data(ChatMessageModel::MessageIdRole).toInt()).size.height();
+    if (layoutFor(index).size.height() != height) emit sizeHintChanged(index);
+  }
+}
@@ -0,0 +1,44 @@
+#ifndef CHATBUBBLEDELEGATE_H
+#define CHATBUBBLEDELEGATE_H
+
+#include <QHash>
+#include <QSize>
+#include <QStyledItemDelegate>
+
+class QListView;
+
+// AI 对话气泡的绘制与尺寸：用户消息靠右（绿色），助手消息靠左（灰色）。
+// 排版结果按消息编号缓存，只有内容修改次数或视图宽度变化时重新计算，
+// 视图重新布局时其余消息只是查表；绘制只发生在可见的行
+class ChatBubbleDelegate : public QStyledItemDelegate {
+  Q_OBJECT
+
+ public:
+  explicit ChatBubbleDelegate(QListView* view);
+
+  void paint(QPainter* painter, const QStyleOptionViewItem& option,
+             const QModelIndex& index) const override;
+  QSize sizeHint(const QStyleOptionViewItem& option,
+                 const QModelIndex& index) const override;
+
+ public slots:
+  // 消息内容变化后调用：高度改变时才通知视图重新布局
+  void messageChanged(const QModelIndex& topLeft,
+                      const QModelIndex& bottomRight);
+
+ private:
+  struct Layout {
+    int width = 0;     // 排版时的视图宽度
+    int revision = -1;
+    QSize bubble;      // 气泡大小（含内边距）
+    QSize size;        // 整行大小
+  };
+
+  QListView* listView;
+  mutable QHash<int, Layout> layouts;  // 消息编号 -> 排版结果
+
+  const Layout& layoutFor(const QModelIndex& index) const;
+  QString senderText(bool isUser) const;
+};
+
+#endif
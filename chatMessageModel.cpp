@@ -0,0 +1,86 @@
+#include "chatMessageModel.h"
+
+ChatMessageModel::ChatMessageModel(int maxMessages, QObject* parent)
+    : QAbstractListModel(parent), firstId(0), limit(qMax(10, maxMessages)) {}
+
+int ChatMessageModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : messages.size();
+}
+
+QVariant ChatMessageModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= messages.size()) return QVariant();
+
+  const Message& message = messages[index.row()];
+  switch (role) {
+    case Qt::DisplayRole:
+      return message.text;
+    case IsUserRole:
+      return message.isUser;
+    case MessageIdRole:
+      return firstId + index.row();
+    case RevisionRole:
+      return message.revision;
+    default:
+      return QVariant();
+  }
+}
+
+void ChatMessageModel::setMaxMessages(int count) {
+  limit = qMax(10, count);
+  trim();
+}
+
+int ChatMessageModel::maxMessages() const { return limit; }
+
+int ChatMessageModel::appendMessage(const QString& text, bool isUser) {
+  Message message;
+  message.text = text;
+  message.isUser = isUser;
+
+  int row = messages.size();
+  beginInsertRows(QModelIndex(), row, row);
+  messages.append(message);
+  endInsertRows();
+
+  int id = firstId + row;
+  trim();
+  return id;
+}
+
+bool ChatMessageModel::setText(int id, const QString& text) {
+  int row = rowOf(id);
+  if (row < 0) return false;
+
+  messages[row].text = text;
+  messages[row].revision++;
+  QModelIndex changed = index(row);
+  emit dataChanged(changed, changed);
+  return true;
+}
+
+bool ChatMessageModel::appendText(int id, const QString& text) {
+  int row = rowOf(id);
+  if (row < 0) return false;
+
+  messages[row].text += text;
+  messages[row].revision++;
+  QModelIndex changed = index(row);
+  emit dataChanged(changed, changed);
+  return true;
+}
+
+int ChatMessageModel::rowOf(int id) const {
+  int row = id - firstId;
+  return (row >= 0 && row < messages.size()) ? row : -1;
+}
+
+// 从最早的消息开始淘汰（QList 删除开头元素不移动其余元素）
+void ChatMessageModel::trim() {
+  int excess = messages.size() - limit;
+  if (excess <= 0) return;
+
+  beginRemoveRows(QModelIndex(), 0, excess - 1);
+  messages.erase(messages.begin(), messages.begin() + excess);
+  firstId += excess;
+  endRemoveRows();
+}
@@ -0,0 +1,50 @@
+#ifndef CHATMESSAGEMODEL_H
+#define CHATMESSAGEMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+
+// AI 对话的消息列表：每条消息一行，纯文本存储。消息以递增编号标识（行号
+// 会因淘汰旧消息而变化）；超过保留条数时从最早的消息开始移除，内存与
+// 视图的布局开销都有上限。流式回答只修改最后一个气泡所在的行
+class ChatMessageModel : public QAbstractListModel {
+  Q_OBJECT
+
+ public:
+  enum Roles {
+    IsUserRole = Qt::UserRole + 1,  // 是否为用户消息（bool）
+    MessageIdRole,                  // 消息编号（int）
+    RevisionRole                    // 内容修改次数（布局缓存据此失效）
+  };
+
+  explicit ChatMessageModel(int maxMessages = 500, QObject* parent = nullptr);
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index,
+                int role = Qt::DisplayRole) const override;
+
+  void setMaxMessages(int count);  // 保留的消息条数（至少 10）
+  int maxMessages() const;
+
+  int appendMessage(const QString& text, bool isUser);  // 返回消息编号
+  // 消息已被淘汰时返回 false
+  bool setText(int id, const QString& text);
+  bool appendText(int id, const QString& text);
+
+ private:
+  struct Message {
+    QString text;
+    bool isUser = false;
+    int revision = 0;
+  };
+
+  QList<Message> messages;
+  int firstId;  // messages 第一条的编号
+  int limit;
+
+  int rowOf(int id) const;  // 已淘汰或不存在时返回 -1
+  void trim();
+};
+
+#endif
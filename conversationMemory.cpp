@@ -0,0 +1,102 @@
+#include "conversationMemory.h"
+
+#include <QJsonObject>
+
+#include "aiContextBuilder.h"
+
+// 每条消息的角色与分隔符大约占用的 token 数
+static const int kMessageOverhead = 4;
+static const int kQuestionChars = 40;  // 摘要中问题保留的字数
+static const int kAnswerChars = 80;    // 摘要中回答保留的字数
+
+static QJsonObject makeMessage(const QString& role, const QString& content) {
+  QJsonObject message;
+  message["role"] = role;
+  message["content"] = content;
+  return message;
+}
+
+ConversationMemory::ConversationMemory(int tokenBudget)
+    : turnTokens(0), summaryTokens(0), budget(qMax(200, tokenBudget)) {}
+
+void ConversationMemory::setTokenBudget(int tokens) {
+  budget = qMax(200, tokens);
+  compact();
+}
+
+int ConversationMemory::tokenBudget() const { return budget; }
+
+void ConversationMemory::addTurn(const QString& question,
+                                 const QString& answer) {
+  Turn turn;
+  turn.question = question;
+  turn.answer = answer;
+  turn.tokens = AIContextBuilder::estimateTokens(question) +
+                AIContextBuilder::estimateTokens(answer) +
+                2 * kMessageOverhead;
+  turns.append(turn);
+  turnTokens += turn.tokens;
+  compact();
+}
+
+void ConversationMemory::clear() {
+  turns.clear();
+  summaryLines.clear();
+  turnTokens = 0;
+  summaryTokens = 0;
+}
+
+QString ConversationMemory::lastQuestion() const {
+  return turns.isEmpty() ? QString() : turns.last().question;
+}
+
+int ConversationMemory::turnCount() const { return turns.size(); }
+
+QJsonArray ConversationMemory::messages(int maxTokens, int* tokens) const {
+  int limit = qMin(maxTokens, budget);
+  int used = 0;
+
+  // 从最近一轮往前取原文，放不下即停止（不跳过中间的轮次）
+  int first = turns.size();
+  while (first > 0 && used + turns[first - 1].tokens <= limit) {
+    first--;
+    used += turns[first].tokens;
+  }
+
+  QJsonArray result;
+  int summaryCost = summaryTokens + kMessageOverhead;
+  if (!summaryLines.isEmpty() && used + summaryCost <= limit) {
+    result.append(makeMessage(
+        "system", "此前对话摘要：\n" + summaryLines.join("\n")));
+    used += summaryCost;
+  }
+  for (int i = first; i < turns.size(); ++i) {
+    result.append(makeMessage("user", turns[i].question));
+    result.append(makeMessage("assistant", turns[i].answer));
+  }
+  if (tokens) *tokens = used;
+  return result;
+}
+
+// 原文最多占预算的 3/4（至少保留最近一轮），其余留给摘要
+void ConversationMemory::compact() {
+  while (turns.size() > 1 && turnTokens > budget * 3 / 4) {
+    Turn oldest = turns.takeFirst();
+    turnTokens -= oldest.tokens;
+    QString line = QString("问：%1 答：%2")
+                       .arg(abbreviate(oldest.question, kQuestionChars))
+                       .arg(abbreviate(oldest.answer, kAnswerChars));
+    summaryLines.append(line);
+    summaryTokens += AIContextBuilder::estimateTokens(line) + 1;
+  }
+  while (!summaryLines.isEmpty() && summaryTokens > budget / 4) {
+    summaryTokens -=
+        AIContextBuilder::estimateTokens(summaryLines.takeFirst()) + 1;
+  }
+}
+
+QString ConversationMemory::abbreviate(const QString& text, int maxChars) {
+  QString simplified = text.simplified();
+  if (simplified.size() <= maxChars) return simplified;
+  return simplified.left(maxChars) + "…";
+}
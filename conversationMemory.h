@@ -0,0 +1,46 @@
+#ifndef CONVERSATIONMEMORY_H
+#define CONVERSATIONMEMORY_H
+
+#include <QJsonArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// AI 助手的对话记忆：最近的几轮问答原文保留，更早的轮次压缩成一行摘要
+// （问题与回答各取开头），摘要也超出预算时丢弃最早的行。每次请求只带
+// 不超过给定 token 数的历史，请求体大小不随对话变长而无限增长。排班与
+// 预约数据不进入记忆，由每轮的检索上下文单独提供
+class ConversationMemory {
+ public:
+  explicit ConversationMemory(int tokenBudget = 1500);
+
+  void setTokenBudget(int tokens);  // 记忆 token 上限（至少 200）
+  int tokenBudget() const;
+
+  void addTurn(const QString& question, const QString& answer);
+  void clear();
+  QString lastQuestion() const;  // 上一轮的问题（追问时补全检索条件）
+  int turnCount() const;         // 原文保留的轮数
+
+  // 作为请求历史的消息（摘要 + 最近的原文轮次，旧在前），总量不超过
+  // maxTokens 与记忆预算；tokens 返回实际估算的 token 数
+  QJsonArray messages(int maxTokens, int* tokens = nullptr) const;
+
+ private:
+  struct Turn {
+    QString question;
+    QString answer;
+    int tokens = 0;
+  };
+
+  QList<Turn> turns;         // 原文保留的轮次（旧在前）
+  QStringList summaryLines;  // 更早轮次的摘要（旧在前）
+  int turnTokens;
+  int summaryTokens;
+  int budget;
+
+  void compact();
+  static QString abbreviate(const QString& text, int maxChars);
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include "departmentRecommender.h"
+
+#include <QFileInfo>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+#include "appointmentArchive.h"
+
+static const double kK1 = 1.2;
+static const double kB = 0.75;
+
+static bool isHan(QChar ch) {
+  return ch.unicode() >= 0x4E00 && ch.unicode() <= 0x9FFF;
+}
+
+Bm25Index::Bm25Index() : totalLength(0) {}
+
+void Bm25Index::clear() {
+  postings.clear();
+  labelLengths.clear();
+  totalLength = 0;
+}
+
+void Bm25Index::add(const QString& label, const QStringList& tokens) {
+  if (label.isEmpty() || tokens.isEmpty()) return;
+  for (const QString& token : tokens) {
+    postings[token][label]++;
+  }
+  labelLengths[label] += tokens.size();
+  totalLength += tokens.size();
+}
+
+QList<Recommendation> Bm25Index::rank(const QStringList& tokens, int limit,
+                                      const QSet<QString>& allowed) const {
+  QList<Recommendation> ranked;
+  if (labelLengths.isEmpty()) return ranked;
+
+  double labelCount = labelLengths.size();
+  double averageLength = double(totalLength) / labelCount;
+  QHash<QString, double> scores;
+  QSet<QString> seen;
+  for (const QString& token : tokens) {
+    if (seen.contains(token)) continue;  // 查询中重复的词只计一次
+    seen.insert(token);
+
+    auto posting = postings.constFind(token);
+    if (posting == postings.constEnd()) continue;
+    double df = posting.value().size();
+    double idf = std::log(1 + (labelCount - df + 0.5) / (df + 0.5));
+    for (auto it = posting.value().constBegin();
+         it != posting.value().constEnd(); ++it) {
+      if (!allowed.isEmpty() && !allowed.contains(it.key())) continue;
+      double tf = it.value();
+      double norm = 1 - kB + kB * labelLengths.value(it.key()) / averageLength;
+      scores[it.key()] += idf * tf * (kK1 + 1) / (tf + kK1 * norm);
+    }
+  }
+
+  for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+    Recommendation recommendation;
+    recommendation.name = it.key();
+    recommendation.score = it.value();
+    ranked.append(recommendation);
+  }
+  std::sort(ranked.begin(), ranked.end(),
+            [](const Recommendation& a, const Recommendation& b) {
+              return a.score > b.score;
+            });
+  ranked = ranked.mid(0, limit);
+
+  double total = 0;
+  for (const Recommendation& recommendation : ranked) {
+    total += recommendation.score;
+  }
+  for (Recommendation& recommendation : ranked) {
+    recommendation.share = total > 0 ? recommendation.score / total : 0;
+  }
+  return ranked;
+}
+
+void RecommenderIndex::add(const Appointment& appointment) {
+  QStringList tokens = DepartmentRecommender::tokenize(appointment.description);
+  if (tokens.isEmpty()) return;
+
+  departments.add(appointment.expertSubject, tokens);
+  experts.add(appointment.expertName, tokens);
+  if (!appointment.expertName.isEmpty()) {
+    expertDepartments.insert(appointment.expertName,
+                             appointment.expertSubject);
+  }
+  samples++;
+}
+
+// 工作线程：source.loaded 是预约列表的隐式共享副本，只读；分区文件与
+// 归档段逐个读取，同一时刻只有一个文件的记录在内存中
+static RecommenderIndex buildIndex(const RecommenderSource& source) {
+  QElapsedTimer timer;
+  timer.start();
+  RecommenderIndex index;
+  for (const Appointment& appointment : source.loaded) {
+    index.add(appointment);
+  }
+
+  // 未载入分区中与内存重复的预约（合并导入或新增到同月）只计一次
+  QSet<QString> months;
+  for (const QString& path : source.partitionFiles) {
+    months.insert(QFileInfo(path).completeBaseName());
+  }
+  QSet<QString> loadedKeys;
+  for (const Appointment& appointment : source.loaded) {
+    if (months.contains(
+            AppointmentManager::partitionKey(appointment.appointmentDate))) {
+      loadedKeys.insert(AppointmentManager::naturalKey(appointment));
+    }
+  }
+  for (const QString& path : source.partitionFiles) {
+    QList<Appointment> records;
+    if (!AppointmentManager::readAppointments(path, &records)) continue;
+    for (const Appointment& record : records) {
+      if (!loadedKeys.contains(AppointmentManager::naturalKey(record))) {
+        index.add(record);
+      }
+    }
+  }
+
+  for (const QString& path : source.segmentFiles) {
+    QList<Appointment> records;
+    if (!AppointmentArchive::readSegment(path, &records)) continue;
+    for (const Appointment& record : records) index.add(record);
+  }
+  qDebug() << "科室推荐索引重建：" << index.samples << "条症状描述，耗时"
+           << timer.elapsed() << "ms";
+  return index;
+}
+
+DepartmentRecommender::DepartmentRecommender(
+    AppointmentManager* appointmentMgr,
+    const AppointmentArchive* appointmentArchive, QObject* parent)
+    : QObject(parent),
+      appointmentManager(appointmentMgr),
+      archive(appointmentArchive),
+      indexedGeneration(0),
+      rebuildGeneration(0) {
+  connect(&watcher, &QFutureWatcher<RecommenderIndex>::finished, this,
+          &DepartmentRecommender::onRebuilt);
+  if (appointmentManager) {
+    connect(appointmentManager, &AppointmentManager::appointmentsAdded, this,
+            &DepartmentRecommender::onAppointmentsAdded);
+    connect(appointmentManager, &AppointmentManager::appointmentsReset, this,
+            &DepartmentRecommender::onAppointmentsReset);
+    startRebuild();
+  }
+}
+
+DepartmentRecommender::~DepartmentRecommender() { watcher.waitForFinished(); }
+
+QStringList DepartmentRecommender::tokenize(const QString& text) {
+  QStringList tokens;
+  QString word;
+  QChar previous;
+  for (QChar ch : text) {
+    if (isHan(ch)) {
+      if (!word.isEmpty()) {
+        tokens.append(word);
+        word.clear();
+      }
+      tokens.append(QString(ch));
+      if (isHan(previous)) tokens.append(QString(previous) + ch);
+    } else if (ch.isLetterOrNumber()) {
+      word.append(ch.toLower());
+    } else if (!word.isEmpty()) {
+      tokens.append(word);
+      word.clear();
+    }
+    previous = ch;
+  }
+  if (!word.isEmpty()) tokens.append(word);
+  return tokens;
+}
+
+QList<Recommendation> DepartmentRecommender::recommendDepartments(
+    const QString& symptoms, int limit) {
+  return index.departments.rank(tokenize(symptoms), limit, QSet<QString>());
+}
+
+QList<Recommendation> DepartmentRecommender::recommendExperts(
+    const QString& symptoms, const QString& department, int limit) {
+  QSet<QString> allowed;
+  if (!department.isEmpty()) {
+    for (auto it = index.expertDepartments.constBegin();
+         it != index.expertDepartments.constEnd(); ++it) {
+      if (it.value() == department) allowed.insert(it.key());
+    }
+    if (allowed.isEmpty()) return QList<Recommendation>();
+  }
+  return index.experts.rank(tokenize(symptoms), limit, allowed);
+}
+
+int DepartmentRecommender::sampleCount() const { return index.samples; }
+
+void DepartmentRecommender::onAppointmentsAdded(int first, int count) {
+  // 重建中的快照不含新增的预约，完成后会按变更代号再重建一次；这里先加入
+  // 当前索引，使新样本立即可用
+  const QList<Appointment>& appointments =
+      appointmentManager->getAllAppointments();
+  for (int i = first; i < first + count && i < appointments.size(); ++i) {
+    index.add(appointments[i]);
+  }
+  if (!watcher.isRunning()) {
+    indexedGeneration = appointmentManager->generation();
+  }
+}
+
+void DepartmentRecommender::onAppointmentsReset() {
+  // 批量新增时 appointmentsAdded 先于 appointmentsReset 发出，已增量处理
+  if (appointmentManager->generation() != indexedGeneration) startRebuild();
+}
+
+void DepartmentRecommender::startRebuild() {
+  if (watcher.isRunning()) return;  // 完成后按变更代号决定是否再次重建
+  rebuildGeneration = appointmentManager->generation();
+  RecommenderSource source;
+  source.loaded = appointmentManager->getAllAppointments();
+  source.partitionFiles = appointmentManager->unloadedPartitionFiles();
+  if (archive) source.segmentFiles = archive->segmentFiles();
+  watcher.setFuture(QtConcurrent::run(buildIndex, source));
+}
+
+void DepartmentRecommender::onRebuilt() {
+  index = watcher.result();
+  indexedGeneration = rebuildGeneration;
+  // 重建期间预约又有变化（含新增）：按最新快照再重建一次
+  if (appointmentManager->generation() != indexedGeneration) startRebuild();
+}
@@ -0,0 +1,101 @@
+#ifndef DEPARTMENTRECOMMENDER_H
+#define DEPARTMENTRECOMMENDER_H
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "appointmentManager.h"
+
+class AppointmentArchive;
+
+// 一条推荐结果
+struct Recommendation {
+  QString name;        // 科室或专家
+  double score = 0;    // BM25 得分
+  double share = 0;    // 在返回结果中的得分占比（0~1）
+};
+
+// 按标签（科室/专家）聚合的 BM25 倒排索引：每个标签的全部描述视为一篇
+// 文档，只支持追加
+class Bm25Index {
+ public:
+  Bm25Index();
+
+  void clear();
+  void add(const QString& label, const QStringList& tokens);
+  // 得分最高的 limit 个标签；allowed 非空时只在其中选择
+  QList<Recommendation> rank(const QStringList& tokens, int limit,
+                             const QSet<QString>& allowed) const;
+
+ private:
+  QHash<QString, QHash<QString, int>> postings;  // 词 -> {标签 -> 词频}
+  QHash<QString, int> labelLengths;              // 标签 -> 总词数
+  qint64 totalLength;
+};
+
+// 一份完整的推荐索引（可在工作线程中建立后整体替换）
+struct RecommenderIndex {
+  Bm25Index departments;
+  Bm25Index experts;
+  QHash<QString, QString> expertDepartments;  // 专家 -> 科室
+  int samples = 0;
+
+  void add(const Appointment& appointment);
+};
+
+// 重建索引的数据来源：内存中预约的快照，加上仍留在磁盘上的未载入历史
+// 分区与归档段（由工作线程逐个读取，不载入 AppointmentManager）
+struct RecommenderSource {
+  QList<Appointment> loaded;
+  QStringList partitionFiles;
+  QStringList segmentFiles;
+};
+
+// 症状 -> 科室/专家推荐：以历史预约的症状描述（Appointment::description）
+// 为样本、所约科室与专家为标签建立 BM25 索引，完全在本地计算。样本包括
+// 内存中的预约、未载入的历史分区与归档段。新增预约通过 appointmentsAdded
+// 增量加入；预约被删除、修改或整体替换时在工作线程中按快照重建，完成后
+// 整体替换，重建期间查询继续使用旧索引
+class DepartmentRecommender : public QObject {
+  Q_OBJECT
+
+ public:
+  // archive 可为空（不使用归档样本）
+  DepartmentRecommender(AppointmentManager* appointmentMgr,
+                        const AppointmentArchive* appointmentArchive,
+                        QObject* parent = nullptr);
+  ~DepartmentRecommender();
+
+  QList<Recommendation> recommendDepartments(const QString& symptoms,
+                                             int limit = 3);
+  // department 非空时只推荐该科室的专家
+  QList<Recommendation> recommendExperts(const QString& symptoms,
+                                         const QString& department = QString(),
+                                         int limit = 3);
+  int sampleCount() const;  // 已索引的症状描述数
+
+  // 分词：汉字取单字与相邻两字，字母数字按连续串（小写）
+  static QStringList tokenize(const QString& text);
+
+ private slots:
+  void onAppointmentsAdded(int first, int count);
+  void onAppointmentsReset();
+  void onRebuilt();
+
+ private:
+  AppointmentManager* appointmentManager;
+  const AppointmentArchive* archive;
+  RecommenderIndex index;
+  quint64 indexedGeneration;     // 索引对应的预约数据变更代号
+  quint64 rebuildGeneration;     // 正在重建的快照对应的变更代号
+  QFutureWatcher<RecommenderIndex> watcher;  // 正在进行的后台重建
+
+  void startRebuild();  // 按当前预约快照在工作线程中重建（已在重建时跳过）
+};
+
+#endif
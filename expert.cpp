@@ -1,9 +1,15 @@
 #include "expert.h"
 
-Expert::Expert() : age(0) {}
+// 全局递增的排班代号，保证不同专家、不同修改得到的代号互不相同
+static quint64 nextScheduleGeneration = 1;
+
+Expert::Expert() : age(0), scheduleGeneration(0) { touchSchedule(); }
+
+void Expert::touchSchedule() { scheduleGeneration = nextScheduleGeneration++; }
 
 void Expert::setTimeSlotCapacity(const QString& timeSlot, int capacity) {
   timeSlotCapacity[timeSlot] = capacity;
+  touchSchedule();
 }
 
 int Expert::getTimeSlotCapacity(const QString& timeSlot) const {
@@ -12,6 +18,7 @@ int Expert::getTimeSlotCapacity(const QString& timeSlot) const {
 
 void Expert::removeTimeSlotCapacity(const QString& timeSlot) {
   timeSlotCapacity.remove(timeSlot);
+  touchSchedule();
 }
 
 // 新判断某日期是否出诊
@@ -132,4 +139,25 @@ QStringList Expert::getSpecialTimeSlotsForDate(const QDate& date) const {
   }
 
   return result;
-}
\ No newline at end of file
+}
+
+// 设为停诊日：移除该日期的特殊时间段并加入停诊日期列表
+bool Expert::closeOnDate(const QDate& date) {
+  if (closedDates.contains(date)) return false;
+
+  QString dateStr = date.toString("MM-dd：");
+  QStringList timeSlotsToRemove;
+  for (const QString& timeSlot : serviceTimes) {
+    if (timeSlot.startsWith(dateStr)) {
+      timeSlotsToRemove.append(timeSlot);
+    }
+  }
+  for (const QString& timeSlot : timeSlotsToRemove) {
+    serviceTimes.removeOne(timeSlot);
+    timeSlotCapacity.remove(timeSlot);
+  }
+
+  closedDates.append(date);
+  touchSchedule();
+  return true;
+}
@@ -19,9 +19,12 @@ class Expert {
   QList<QDate> scheduleDates;  // 特殊出诊日期
   QList<QDate> closedDates;    // 特殊停诊日期
   QMap<QString, int> timeSlotCapacity;
+  quint64 scheduleGeneration;  // 排班变更代号（每次修改排班后递增，用于缓存失效）
 
   Expert();
 
+  void touchSchedule();  // 标记排班已变更（直接修改排班列表后需调用）
+
   void setTimeSlotCapacity(const QString& timeSlot, int capacity);
   int getTimeSlotCapacity(const QString& timeSlot) const;
   void removeTimeSlotCapacity(const QString& timeSlot);
@@ -35,6 +38,7 @@ class Expert {
       const QDate& date) const;  // 检查某日期是否有特殊时间安排
   QStringList getSpecialTimeSlotsForDate(
       const QDate& date) const;  // 获取特殊出诊日的所有时间段
+  bool closeOnDate(const QDate& date);  // 设为停诊日（已是停诊日返回false）
 };
 
 #endif
\ No newline at end of file
@@ -15,16 +15,20 @@
 #include "ui_expertDialog.h"
 
 ExpertDialog::ExpertDialog(Expert* expert, AppointmentManager* appointmentMgr,
-                           QWidget* parent)
+                           const AppointmentArchive* archive, QWidget* parent)
     : QDialog(parent),
       ui(new Ui::ExpertDialog),
       currentExpert(expert),
       appointmentManager(appointmentMgr),
-      appointmentModel(new QStandardItemModel(this)) {
+      appointmentModel(new QStandardItemModel(this)),
+      availabilityCalendar(appointmentMgr, 61),
+      historyModel(new QStandardItemModel(this)),
+      visitHistory(appointmentMgr, archive) {
   ui->setupUi(this);
   setupUI();
   loadExpertInfo();
   setupAppointmentTable();
+  setupHistoryTable();
   loadAppointments();
   loadServiceTimes();
   loadScheduleDates();
@@ -105,6 +109,79 @@ void ExpertDialog::setupAppointmentTable() {
   ui->appointmentTable->setColumnWidth(5, 200);  // 症状描述
   ui->appointmentTable->setColumnWidth(6, 80);   // 排队号
   ui->appointmentTable->setColumnWidth(7, 80);   // 状态
+
+  // 选中预约时在“就诊历史”页查询该患者的既往就诊；用上下键快速移动
+  // 选中行时只在停下后查询一次
+  historyTimer.setSingleShot(true);
+  historyTimer.setInterval(200);
+  connect(&historyTimer, &QTimer::timeout, this,
+          [this]() { showVisitHistory(ui->historyIdInput->text().trimmed()); });
+  connect(ui->appointmentTable->selectionModel(),
+          &QItemSelectionModel::currentRowChanged, this,
+          &ExpertDialog::onAppointmentSelected);
+}
+
+void ExpertDialog::setupHistoryTable() {
+  historyModel->setHorizontalHeaderLabels(
+      {"就诊日期", "时间段", "专家", "科室", "患者姓名", "症状描述"});
+
+  ui->historyTable->setModel(historyModel);
+  ui->historyTable->setAlternatingRowColors(true);
+  ui->historyTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+  ui->historyTable->horizontalHeader()->setStretchLastSection(true);
+  ui->historyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+  ui->historyTable->setColumnWidth(0, 100);  // 就诊日期
+  ui->historyTable->setColumnWidth(1, 110);  // 时间段
+  ui->historyTable->setColumnWidth(2, 80);   // 专家
+  ui->historyTable->setColumnWidth(3, 80);   // 科室
+  ui->historyTable->setColumnWidth(4, 80);   // 患者姓名
+
+  connect(ui->historyIdInput, &QLineEdit::returnPressed, this,
+          &ExpertDialog::on_historySearchBtn_clicked);
+}
+
+void ExpertDialog::on_historySearchBtn_clicked() {
+  historyTimer.stop();
+  showVisitHistory(ui->historyIdInput->text().trimmed());
+}
+
+void ExpertDialog::onAppointmentSelected() {
+  QModelIndex current = ui->appointmentTable->currentIndex();
+  if (!current.isValid()) return;
+
+  QString idNumber =
+      appointmentModel->index(current.row(), 0).data(Qt::UserRole).toString();
+  if (idNumber.isEmpty()) return;
+
+  ui->historyIdInput->setText(idNumber);
+  historyTimer.start();  // 重新计时
+}
+
+void ExpertDialog::showVisitHistory(const QString& idNumber) {
+  historyModel->removeRows(0, historyModel->rowCount());
+  if (idNumber.isEmpty()) {
+    ui->historyStatusLabel->setText("请输入患者身份证号");
+    return;
+  }
+
+  qint64 elapsedMs = 0;
+  QList<Appointment> visits = visitHistory.lookup(idNumber, &elapsedMs);
+  for (int row = 0; row < visits.size(); ++row) {
+    const Appointment& visit = visits[row];
+    QString date = visit.appointmentDate.toString("yyyy-MM-dd");
+    historyModel->setItem(row, 0, new QStandardItem(date));
+    historyModel->setItem(row, 1, new QStandardItem(visit.serviceTime));
+    historyModel->setItem(row, 2, new QStandardItem(visit.expertName));
+    historyModel->setItem(row, 3, new QStandardItem(visit.expertSubject));
+    historyModel->setItem(row, 4, new QStandardItem(visit.patientName));
+    historyModel->setItem(row, 5, new QStandardItem(visit.description));
+  }
+
+  ui->historyStatusLabel->setText(
+      QString("共 %1 次就诊记录（查询耗时 %2 ms）")
+          .arg(visits.size())
+          .arg(elapsedMs));
 }
 
 void ExpertDialog::loadAppointments() { updateAppointmentTable(); }
@@ -123,8 +200,9 @@ void ExpertDialog::updateAppointmentTable() {
 
   for (const auto& appointment : appointments) {
     if (appointment.expertName == currentExpert->name) {
-      appointmentModel->setItem(row, 0,
-                                new QStandardItem(appointment.patientName));
+      QStandardItem* nameItem = new QStandardItem(appointment.patientName);
+      nameItem->setData(appointment.idNumber, Qt::UserRole);  // 查询就诊历史用
+      appointmentModel->setItem(row, 0, nameItem);
       appointmentModel->setItem(row, 1, new QStandardItem(appointment.gender));
       appointmentModel->setItem(
           row, 2, new QStandardItem(QString::number(appointment.age)));
@@ -180,55 +258,25 @@ void ExpertDialog::loadScheduleDates() {
 void ExpertDialog::updateCalendarDisplay() {
   if (!currentExpert) return;
 
-  // 先清除所有日期格式
-  ui->calendar->setDateTextFormat(QDate(), QTextCharFormat());
+  QVector<QTextCharFormat> formats(AvailabilityCalendar::DayStateCount);
 
-  // 高亮显示出诊日期
-  QTextCharFormat outFormat;
-  outFormat.setBackground(QColor(144, 238, 144));  // 浅绿色背景
-  outFormat.setForeground(QColor(0, 100, 0));      // 深绿色文字
+  // 出诊日期：浅绿色背景，深绿色文字
+  formats[AvailabilityCalendar::Special].setBackground(QColor(144, 238, 144));
+  formats[AvailabilityCalendar::Special].setForeground(QColor(0, 100, 0));
 
-  for (const QDate& date : currentExpert->scheduleDates) {
-    ui->calendar->setDateTextFormat(date, outFormat);
-  }
-
-  // 高亮显示停诊日期
-  QTextCharFormat closedFormat;
-  closedFormat.setBackground(QColor(255, 128, 128));  // 浅红色背景
-  closedFormat.setForeground(QColor(200, 0, 0));      // 深红色文字
-  
-  for (const QDate& date : currentExpert->closedDates) {
-    ui->calendar->setDateTextFormat(date, closedFormat);
-  }
+  // 停诊日期：浅红色背景，深红色文字
+  formats[AvailabilityCalendar::Closed].setBackground(QColor(255, 128, 128));
+  formats[AvailabilityCalendar::Closed].setForeground(QColor(200, 0, 0));
 
-  // 标记常规出诊日期
-  QDate startDate = QDate::currentDate();
-  QDate endDate = startDate.addDays(60);  // 显示未来60天
+  // 常规出诊日期：浅蓝色背景
+  formats[AvailabilityCalendar::Regular].setBackground(QColor(220, 240, 255));
 
-  QTextCharFormat regularFormat;
-  regularFormat.setBackground(QColor(220, 240, 255));  // 浅蓝色背景
+  // 已约满日期：浅橙色背景，深橙色文字
+  formats[AvailabilityCalendar::Full].setBackground(QColor(255, 218, 170));
+  formats[AvailabilityCalendar::Full].setForeground(QColor(170, 85, 0));
 
-  for (QDate date = startDate; date <= endDate; date = date.addDays(1)) {
-    QString dayOfWeek = Expert::getDayOfWeekString(date);
-
-    // 如果已经是特殊出诊或停诊日，则跳过
-    if (currentExpert->scheduleDates.contains(date) ||
-        currentExpert->closedDates.contains(date))
-      continue;
-
-    // 检查该星期几是否有安排
-    bool hasSchedule = false;
-    for (const QString& timeSlot : currentExpert->serviceTimes) {
-      if (timeSlot.startsWith(dayOfWeek)) {
-        hasSchedule = true;
-        break;
-      }
-    }
-
-    if (hasSchedule) {
-      ui->calendar->setDateTextFormat(date, regularFormat);
-    }
-  }
+  // 显示未来60天，由日历缓存一次性批量写入
+  availabilityCalendar.render(ui->calendar, *currentExpert, formats);
 }
 
 // 修改日历点击事件处理
@@ -353,6 +401,7 @@ void ExpertDialog::on_cancelScheduleBtn_clicked() {
     QMessageBox::information(this, "提示", "该日期不是特殊出诊日或停诊日！");
     return;
   }
+  currentExpert->touchSchedule();
 
   // 更新日历显示
   updateCalendarDisplay();
@@ -374,29 +423,12 @@ void ExpertDialog::on_setClosedBtn_clicked() {
     return;
   }
 
-  // 检查是否已经是停诊日
-  if (currentExpert->closedDates.contains(selectedDate)) {
+  // 移除该日期的服务时间段并添加停诊安排
+  if (!currentExpert->closeOnDate(selectedDate)) {
     QMessageBox::information(this, "提示", "该日期已经设置为停诊日！");
     return;
   }
 
-  // 移除该日期的服务时间段（以MM-dd开头）
-  QString datePrefix = selectedDate.toString("MM-dd：");
-  QStringList timeSlotsToRemove;
-  for (const QString& timeSlot : currentExpert->serviceTimes) {
-    if (timeSlot.startsWith(datePrefix)) {
-      timeSlotsToRemove.append(timeSlot);
-    }
-  }
-
-  for (const QString& timeSlot : timeSlotsToRemove) {
-    currentExpert->serviceTimes.removeOne(timeSlot);
-    currentExpert->removeTimeSlotCapacity(timeSlot);
-  }
-
-  // 添加停诊安排
-  currentExpert->closedDates.append(selectedDate);
-
   // 更新日历显示
   updateCalendarDisplay();
 
@@ -438,73 +470,34 @@ bool ExpertDialog::hasTimeConflict(const QString& newTimeSlot) {
   if (!currentExpert) return false;
 
   // 解析新时间段
-  QStringList parts = newTimeSlot.split("：");
-  if (parts.size() != 2) return false;
+  TimeSlotRange newRange;
+  if (!TimeSlotRange::parse(newTimeSlot, &newRange)) return false;
 
-  QString newWeekday = parts[0].trimmed();
-  QString newTimeRange = parts[1].trimmed();
+  // 通过区间索引查找同一天内重叠的时间段
+  timeSlotIndex.ensureBuilt(*currentExpert);
+  QStringList conflictingSlots = timeSlotIndex.findOverlaps(newRange);
 
-  QStringList newTimeParts = newTimeRange.split("-");
-  if (newTimeParts.size() != 2) return false;
-
-  QTime newStart = QTime::fromString(newTimeParts[0].trimmed(), "HH:mm");
-  QTime newEnd = QTime::fromString(newTimeParts[1].trimmed(), "HH:mm");
-
-  if (!newStart.isValid() || !newEnd.isValid()) return false;
-
-  // 查找同一天的冲突时间段
-  QStringList conflictingSlots;
-  QTime mergedStart = newStart;
-  QTime mergedEnd = newEnd;
+  int mergedStart = newRange.startMinute;
+  int mergedEnd = newRange.endMinute;
   int maxCapacity = currentExpert->getTimeSlotCapacity(newTimeSlot);
 
-  for (const QString& existingSlot : currentExpert->serviceTimes) {
-    QStringList existingParts = existingSlot.split("：");
-    if (existingParts.size() != 2) continue;
-
-    QString existingWeekday = existingParts[0].trimmed();
+  for (const QString& existingSlot : conflictingSlots) {
+    TimeSlotRange existingRange;
+    if (!TimeSlotRange::parse(existingSlot, &existingRange)) continue;
 
-    // 如果不是同一天，跳过
-    if (newWeekday != existingWeekday) continue;
+    // 扩展合并的时间范围
+    mergedStart = qMin(mergedStart, existingRange.startMinute);
+    mergedEnd = qMax(mergedEnd, existingRange.endMinute);
 
-    QString existingTimeRange = existingParts[1].trimmed();
-    QStringList existingTimeParts = existingTimeRange.split("-");
-    if (existingTimeParts.size() != 2) continue;
-
-    QTime existingStart =
-        QTime::fromString(existingTimeParts[0].trimmed(), "HH:mm");
-    QTime existingEnd =
-        QTime::fromString(existingTimeParts[1].trimmed(), "HH:mm");
-
-    if (!existingStart.isValid() || !existingEnd.isValid()) continue;
-
-    // 检查是否有时间重叠
-    if (!(newEnd <= existingStart || newStart >= existingEnd)) {
-      // 有重叠，记录冲突的时间段
-      conflictingSlots.append(existingSlot);
-
-      // 扩展合并的时间范围
-      if (existingStart < mergedStart) {
-        mergedStart = existingStart;
-      }
-      if (existingEnd > mergedEnd) {
-        mergedEnd = existingEnd;
-      }
-
-      // 取最大容量
-      int existingCapacity = currentExpert->getTimeSlotCapacity(existingSlot);
-      if (existingCapacity > maxCapacity) {
-        maxCapacity = existingCapacity;
-      }
-    }
+    // 取最大容量
+    maxCapacity =
+        qMax(maxCapacity, currentExpert->getTimeSlotCapacity(existingSlot));
   }
 
   // 如果有冲突，进行合并
   if (!conflictingSlots.isEmpty()) {
-    QString mergedSlot = QString("%1：%2-%3")
-                             .arg(newWeekday)
-                             .arg(mergedStart.toString("HH:mm"))
-                             .arg(mergedEnd.toString("HH:mm"));
+    QString mergedSlot =
+        TimeSlotRange::format(newRange.dayKey, mergedStart, mergedEnd);
 
     // 询问用户是否要合并
     QString conflictInfo = conflictingSlots.join(", ");
@@ -596,40 +589,38 @@ void ExpertDialog::mergeTimeSlots(const QStringList& conflictingSlots,
                                   const QString& mergedSlot, int maxCapacity) {
   if (!currentExpert) return;
 
-  // 统计所有被合并时间段的预约数量
-  int totalAppointments = 0;
-  QStringList affectedSlots = conflictingSlots;
-  // 注意：不要将newTimeSlot添加到affectedSlots中，因为它还没有预约
+  // 被合并时间段的预约数与合并后今后单日最多人数，均由专家时间段
+  // 索引给出；newTimeSlot 还没有预约，不参与统计与重命名
+  QHash<QString, QString> renames;
+  for (const QString& slot : conflictingSlots) {
+    renames.insert(slot, mergedSlot);
+  }
 
+  int totalAppointments = 0;
+  int peakAppointments = 0;
   if (appointmentManager) {
     for (const QString& slot : conflictingSlots) {
-      auto expertAppointments =
-          appointmentManager->getAppointmentsByExpert(currentExpert->name);
-      for (const auto& appointment : expertAppointments) {
-        if (appointment.serviceTime == slot) {
-          totalAppointments++;
-        }
-      }
+      totalAppointments +=
+          appointmentManager->countInSlot(currentExpert->name, slot);
     }
+    peakAppointments = appointmentManager->peakDailyOccupancy(
+        currentExpert->name, conflictingSlots, QDate::currentDate());
   }
 
   // 检查合并后的容量是否足够
-  if (totalAppointments > maxCapacity) {
+  if (peakAppointments > maxCapacity) {
     QMessageBox::warning(
         this, "合并失败",
-        QString("合并后的时间段已有 %1 个预约，但最大容量只有 %2 人！\n"
-                "请先调整预约或增加容量。")
-            .arg(totalAppointments)
+        QString("合并后的时间段今后单日最多有 %1 个预约，但最大容量只有 "
+                "%2 人！\n请先调整预约或增加容量。")
+            .arg(peakAppointments)
             .arg(maxCapacity));
     return;
   }
 
-  // 批量更新预约的服务时间
+  // 一次批量更新所有受影响预约的服务时间
   if (appointmentManager) {
-    for (const QString& slot : conflictingSlots) {
-      appointmentManager->updateServiceTimeForExpert(currentExpert->name, slot,
-                                                     mergedSlot);
-    }
+    appointmentManager->remapServiceTimes(currentExpert->name, renames);
   }
 
   // 移除所有冲突的时间段
@@ -682,21 +673,18 @@ void ExpertDialog::on_setCapacityBtn_clicked() {
       currentCapacity, 1, 100, 1, &ok);
 
   if (ok) {
-    // 检查新容量是否小于当前预约数
+    // 容量只约束今天及以后的预约：新容量不能小于其中单日最多的人数
     int appointmentCount = 0;
     if (appointmentManager) {
-      for (const auto& appointment : appointmentManager->getAllAppointments()) {
-        if (appointment.expertName == currentExpert->name &&
-            appointment.serviceTime == timeSlot) {
-          appointmentCount++;
-        }
-      }
+      appointmentCount = appointmentManager->peakDailyOccupancy(
+          currentExpert->name, QStringList() << timeSlot,
+          QDate::currentDate());
     }
 
     if (newCapacity < appointmentCount) {
       QMessageBox::warning(
           this, "容量不足",
-          QString("该时间段已有 %1 个预约，不能将容量设置为 %2！")
+          QString("该时间段今后单日最多已有 %1 个预约，不能将容量设置为 %2！")
               .arg(appointmentCount)
               .arg(newCapacity));
       return;
@@ -770,20 +758,16 @@ void ExpertDialog::on_deleteServiceTimeBtn_clicked() {
   QString displayText = currentItem->text();
   QString timeSlot = displayText.split(" (")[0];  // 提取时间段部分
 
-  // 检查该时间段是否有预约
+  // 检查该时间段今天及以后是否还有预约（已就诊的历史预约不影响删除）
   int appointmentCount = 0;
   if (appointmentManager) {
-    for (const auto& appointment : appointmentManager->getAllAppointments()) {
-      if (appointment.expertName == currentExpert->name &&
-          appointment.serviceTime == timeSlot) {
-        appointmentCount++;
-      }
-    }
+    appointmentCount = appointmentManager->countInSlot(
+        currentExpert->name, timeSlot, QDate::currentDate());
   }
 
   if (appointmentCount > 0) {
     QMessageBox::warning(this, "无法删除",
-                         QString("该时间段已有 %1 个预约，无法删除！\n"
+                         QString("该时间段今后还有 %1 个预约，无法删除！\n"
                                  "请先联系患者修改预约。")
                              .arg(appointmentCount));
     return;
@@ -7,9 +7,13 @@
 #include <QListWidgetItem>
 #include <QMessageBox>
 #include <QStandardItemModel>
+#include <QTimer>
 
 #include "appointmentManager.h"
+#include "availabilityCalendar.h"
 #include "expert.h"
+#include "timeSlotIndex.h"
+#include "visitHistory.h"
 
 namespace Ui {
 class ExpertDialog;  // 界面指针类（由 Qt Designer 生成）
@@ -21,8 +25,9 @@ class ExpertDialog : public QDialog {
  public:
   explicit ExpertDialog(
       Expert* expert, AppointmentManager* appointmentMgr,
+      const AppointmentArchive* archive = nullptr,
       QWidget* parent =
-          nullptr);  // 构造函数：使用指定专家与预约管理器初始化对话框
+          nullptr);  // 构造函数：使用指定专家、预约管理器与归档初始化对话框
   ~ExpertDialog();   // 析构函数：释放对话框资源
 
  private slots:
@@ -34,18 +39,26 @@ class ExpertDialog : public QDialog {
   void on_deleteServiceTimeBtn_clicked();  // 删除服务时间段按钮点击处理槽
   void on_changePasswordBtn_clicked();     // 修改密码按钮点击处理槽
   void on_setCapacityBtn_clicked();        // 设置时段容量按钮点击处理槽
+  void on_setClosedBtn_clicked();          // 设置停诊日期按钮点击处理槽
+  void on_historySearchBtn_clicked();      // 就诊历史查询按钮点击处理槽
   void on_serviceTimeList_itemDoubleClicked(
       QListWidgetItem* item);  // 服务时间列表项双击处理槽
   void on_calendar_clicked(
       const QDate& date);         // 日历点击处理槽，参数为所选日期
   void loadAppointments();        // 加载并显示该专家的预约数据
   void updateAppointmentTable();  // 刷新预约表格数据的显示
+  void onAppointmentSelected();   // 选中预约时查询该患者的就诊历史
 
  private:
   Ui::ExpertDialog* ui;                    // 指向 UI 对象的指针
   Expert* currentExpert;                   // 当前正在编辑/查看的专家对象指针
   AppointmentManager* appointmentManager;  // 预约管理器指针（用于读写预约数据）
   QStandardItemModel* appointmentModel;    // 用于展示预约列表的模型
+  AvailabilityCalendar availabilityCalendar;  // 出诊日历缓存（按排班代号失效）
+  TimeSlotIndex timeSlotIndex;  // 时间段区间索引（用于冲突检测）
+  QStandardItemModel* historyModel;  // 就诊历史表格的模型
+  VisitHistory visitHistory;         // 就诊历史查询（预约数据 + 归档）
+  QTimer historyTimer;  // 选中预约后延迟查询，键盘连续移动时只查最后一条
 
   void setupUI();            // 初始化并绑定界面元素
   void loadExpertInfo();     // 将 currentExpert 的信息加载到界面表单中
@@ -54,7 +67,8 @@ class ExpertDialog : public QDialog {
   void loadScheduleDates();  // 加载并显示专家的排班日期
   void setFormReadOnly(bool readOnly);  // 设置表单可编辑性（只读或可编辑）
   void setupAppointmentTable();         // 配置预约表格的列与模型
-  void on_setClosedBtn_clicked();       // 设置专家休诊/关闭日期的按钮处理槽
+  void setupHistoryTable();             // 配置就诊历史表格的列与模型
+  void showVisitHistory(const QString& idNumber);  // 查询并显示就诊历史
   void updateCalendarDisplay();         // 根据排班/关闭日期更新日历显示
   bool isValidTimeFormat(const QString& timeStr);  // 校验时间字符串格式是否有效
   bool hasTimeConflict(
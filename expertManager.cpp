@@ -1,8 +1,8 @@
 #include "expertManager.h"
 
-ExpertManager::ExpertManager() {
-  
-}
+#include <QHash>
+
+ExpertManager::ExpertManager() : rosterGeneration(0) {}
 
 Expert* ExpertManager::findExpertById(const QString& id) {
   for (auto& expert : experts) {
@@ -11,6 +11,13 @@ Expert* ExpertManager::findExpertById(const QString& id) {
   return nullptr;
 }
 
+Expert* ExpertManager::findExpertByName(const QString& name) {
+  for (auto& expert : experts) {
+    if (expert.name == name) return &expert;
+  }
+  return nullptr;
+}
+
 bool ExpertManager::verifyExpert(const QString& id, const QString& password) {
   Expert* expert = findExpertById(id);
   return expert && expert->password == password;
@@ -23,46 +30,7 @@ bool ExpertManager::saveToFile(const QString& filename) const {
 
   // 将所有专家信息转换为JSON对象
   for (const Expert& expert : experts) {
-    QJsonObject expertObj;
-    expertObj["id"] = expert.id;
-    expertObj["name"] = expert.name;
-    expertObj["password"] = expert.password;
-    expertObj["gender"] = expert.gender;
-    expertObj["age"] = expert.age;
-    expertObj["title"] = expert.title;
-    expertObj["subject"] = expert.subject;
-
-    // 处理服务时间
-    QJsonArray timeArray;
-    for (const QString& time : expert.serviceTimes) {
-      timeArray.append(time);
-    }
-    expertObj["serviceTimes"] = timeArray;
-
-    // 处理出诊日期
-    QJsonArray dateArray;
-    for (const QDate& date : expert.scheduleDates) {
-      dateArray.append(date.toString("yyyy-MM-dd"));
-    }
-    expertObj["scheduleDates"] = dateArray;
-
-    // 处理停诊日期
-    QJsonArray closedArray;
-    for (const QDate& date : expert.closedDates) {
-      closedArray.append(date.toString("yyyy-MM-dd"));
-    }
-    expertObj["closedDates"] = closedArray;
-
-    // 处理时间段容量
-    QJsonObject capacityObj;
-    QMapIterator<QString, int> it(expert.timeSlotCapacity);
-    while (it.hasNext()) {
-      it.next();
-      capacityObj[it.key()] = it.value();
-    }
-    expertObj["timeSlotCapacity"] = capacityObj;
-
-    expertArray.append(expertObj);
+    expertArray.append(expertToJson(expert));
   }
 
   // 创建JSON文档
@@ -123,56 +91,164 @@ bool ExpertManager::loadFromFile(const QString& filename) {
   for (const QJsonValue& value : expertArray) {
     if (!value.isObject()) continue;
 
-    QJsonObject obj = value.toObject();
-    Expert expert;
-
-    expert.id = obj["id"].toString();
-    expert.name = obj["name"].toString();
-    expert.password = obj["password"].toString();
-    expert.gender = obj["gender"].toString();
-    expert.age = obj["age"].toInt();
-    expert.title = obj["title"].toString();
-    expert.subject = obj["subject"].toString();
-
-    // 加载服务时间
-    QJsonArray timeArray = obj["serviceTimes"].toArray();
-    for (const QJsonValue& timeValue : timeArray) {
-      expert.serviceTimes.append(timeValue.toString());
+    experts.append(expertFromJson(value.toObject()));
+  }
+  markChanged();
+
+  qDebug() << "成功从文件加载" << experts.size() << "个专家信息：" << filename;
+  return true;
+}
+
+QJsonObject ExpertManager::expertToJson(const Expert& expert) {
+  QJsonObject expertObj;
+  expertObj["id"] = expert.id;
+  expertObj["name"] = expert.name;
+  expertObj["password"] = expert.password;
+  expertObj["gender"] = expert.gender;
+  expertObj["age"] = expert.age;
+  expertObj["title"] = expert.title;
+  expertObj["subject"] = expert.subject;
+
+  // 处理服务时间
+  QJsonArray timeArray;
+  for (const QString& time : expert.serviceTimes) {
+    timeArray.append(time);
+  }
+  expertObj["serviceTimes"] = timeArray;
+
+  // 处理出诊日期
+  QJsonArray dateArray;
+  for (const QDate& date : expert.scheduleDates) {
+    dateArray.append(date.toString("yyyy-MM-dd"));
+  }
+  expertObj["scheduleDates"] = dateArray;
+
+  // 处理停诊日期
+  QJsonArray closedArray;
+  for (const QDate& date : expert.closedDates) {
+    closedArray.append(date.toString("yyyy-MM-dd"));
+  }
+  expertObj["closedDates"] = closedArray;
+
+  // 处理时间段容量
+  QJsonObject capacityObj;
+  QMapIterator<QString, int> it(expert.timeSlotCapacity);
+  while (it.hasNext()) {
+    it.next();
+    capacityObj[it.key()] = it.value();
+  }
+  expertObj["timeSlotCapacity"] = capacityObj;
+
+  return expertObj;
+}
+
+Expert ExpertManager::expertFromJson(const QJsonObject& obj) {
+  Expert expert;
+
+  expert.id = obj["id"].toString();
+  expert.name = obj["name"].toString();
+  expert.password = obj["password"].toString();
+  expert.gender = obj["gender"].toString();
+  expert.age = obj["age"].toInt();
+  expert.title = obj["title"].toString();
+  expert.subject = obj["subject"].toString();
+
+  // 加载服务时间
+  QJsonArray timeArray = obj["serviceTimes"].toArray();
+  for (const QJsonValue& timeValue : timeArray) {
+    expert.serviceTimes.append(timeValue.toString());
+  }
+
+  // 加载出诊日期
+  QJsonArray dateArray = obj["scheduleDates"].toArray();
+  for (const QJsonValue& dateValue : dateArray) {
+    QDate date = QDate::fromString(dateValue.toString(), "yyyy-MM-dd");
+    if (date.isValid()) {
+      expert.scheduleDates.append(date);
     }
+  }
 
-    // 加载出诊日期
-    QJsonArray dateArray = obj["scheduleDates"].toArray();
-    for (const QJsonValue& dateValue : dateArray) {
-      QDate date = QDate::fromString(dateValue.toString(), "yyyy-MM-dd");
-      if (date.isValid()) {
-        expert.scheduleDates.append(date);
-      }
+  // 加载停诊日期
+  QJsonArray closedArray = obj["closedDates"].toArray();
+  for (const QJsonValue& dateValue : closedArray) {
+    QDate date = QDate::fromString(dateValue.toString(), "yyyy-MM-dd");
+    if (date.isValid()) {
+      expert.closedDates.append(date);
     }
+  }
+
+  // 加载时间段容量
+  QJsonObject capacityObj = obj["timeSlotCapacity"].toObject();
+  for (const QString& key : capacityObj.keys()) {
+    expert.setTimeSlotCapacity(key, capacityObj[key].toInt());
+  }
+
+  return expert;
+}
 
-    // 加载停诊日期
-    QJsonArray closedArray = obj["closedDates"].toArray();
-    for (const QJsonValue& dateValue : closedArray) {
-      QDate date = QDate::fromString(dateValue.toString(), "yyyy-MM-dd");
-      if (date.isValid()) {
-        expert.closedDates.append(date);
-      }
+bool ExpertManager::mergeFromFile(const QString& filename,
+                                  MergeSummary* summary) {
+  JsonArrayReader reader(filename);
+  if (!reader.open()) {
+    qDebug() << reader.errorString();
+    return false;
+  }
+
+  // 以专家编号为键与现有数据做哈希连接
+  QHash<QString, int> indexById;
+  for (int i = 0; i < experts.size(); ++i) {
+    indexById.insert(experts[i].id, i);
+  }
+
+  QList<Expert> inserts;
+  QHash<int, Expert> updates;
+  QJsonObject obj;
+  while (reader.next(&obj)) {
+    Expert incoming = expertFromJson(obj);
+    if (incoming.id.isEmpty()) {
+      summary->rejected++;
+      summary->messages.append(QString("专家 %1 缺少编号").arg(incoming.name));
+      continue;
     }
 
-    // 加载时间段容量
-    QJsonObject capacityObj = obj["timeSlotCapacity"].toObject();
-    for (const QString& key : capacityObj.keys()) {
-      expert.setTimeSlotCapacity(key, capacityObj[key].toInt());
+    auto it = indexById.constFind(incoming.id);
+    if (it == indexById.constEnd()) {
+      indexById.insert(incoming.id, experts.size() + inserts.size());
+      inserts.append(incoming);
+    } else if (it.value() >= experts.size()) {
+      inserts[it.value() - experts.size()] = incoming;  // 文件内重复，以后者为准
+    } else if (expertToJson(experts[it.value()]) !=
+               expertToJson(incoming)) {
+      updates.insert(it.value(), incoming);
+    } else {
+      summary->unchanged++;
     }
+  }
+  if (reader.hasError()) {
+    qDebug() << "合并导入专家数据出错：" << reader.errorString();
+    return false;
+  }
 
-    experts.append(expert);
+  // 文件完整读取后再一次性写入
+  for (auto it = updates.constBegin(); it != updates.constEnd(); ++it) {
+    experts[it.key()] = it.value();
   }
+  experts.append(inserts);
+  summary->inserted = inserts.size();
+  summary->updated = updates.size();
 
-  qDebug() << "成功从文件加载" << experts.size() << "个专家信息：" << filename;
+  if (summary->inserted > 0 || summary->updated > 0) markChanged();
+  qDebug() << "合并导入专家数据：" << summary->toText();
   return true;
 }
 
 void ExpertManager::updateExpert(int index, const Expert& updatedExpert) {
   if (index >= 0 && index < experts.size()) {
     experts[index] = updatedExpert;
+    markChanged();
   }
-}
\ No newline at end of file
+}
+
+quint64 ExpertManager::generation() const { return rosterGeneration; }
+
+void ExpertManager::markChanged() { ++rosterGeneration; }
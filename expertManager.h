@@ -12,6 +12,7 @@
 
 #include "expert.h"
 #include "expertManager.h"
+#include "jsonImport.h"
 
 class ExpertManager {
  public:
@@ -19,10 +20,22 @@ class ExpertManager {
   QList<Expert> experts;
 
   Expert* findExpertById(const QString& id);
+  Expert* findExpertByName(const QString& name);
   bool verifyExpert(const QString& id, const QString& password);
   bool saveToFile(const QString& filename) const;
   bool loadFromFile(const QString& filename);
+  // 合并导入：按专家编号新增或更新，不删除文件中没有的专家
+  bool mergeFromFile(const QString& filename, MergeSummary* summary);
   void updateExpert(int index, const Expert& updatedExpert);
+
+  quint64 generation() const;  // 专家名单变更代号（增删专家、改名改科室后递增）
+  void markChanged();          // 直接修改 experts 列表后调用
+
+  static QJsonObject expertToJson(const Expert& expert);
+  static Expert expertFromJson(const QJsonObject& obj);
+
+ private:
+  quint64 rosterGeneration;
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "inputValidator.h"
+
+#include <QByteArray>
+#include <QDate>
+#include <cstring>
+
+#include "inputValidatorKernels.h"
+
+#if defined(_MSC_VER) && (defined(INPUTVALIDATOR_SSE41) || \
+                          defined(INPUTVALIDATOR_AVX2))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+static const int kIdLength = 18;
+static const int kPhoneStride = 16;  // 合法电话号码最长 13 位
+
+// GB 11643 前 17 位加权系数与校验码
+static const int kIdWeights[17] = {7, 9,  10, 5, 8, 4, 2, 1, 6,
+                                   3, 7, 9, 10, 5, 8, 4, 2};
+static const char kCheckCodes[11] = {'1', '0', 'X', '9', '8', '7',
+                                     '6', '5', '4', '3', '2'};
+
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// 复制为单字节字符，含非 ASCII 字符时返回 false
+static bool toAscii(const QString& text, char* out) {
+  const QChar* chars = text.constData();
+  for (int i = 0; i < text.size(); ++i) {
+    ushort c = chars[i].unicode();
+    if (c >= 0x80) return false;
+    out[i] = static_cast<char>(c);
+  }
+  return true;
+}
+
+// 连续数字的数值（调用方保证均为数字）
+static int digitsValue(const char* p, int count) {
+  int value = 0;
+  for (int i = 0; i < count; ++i) value = value * 10 + (p[i] - '0');
+  return value;
+}
+
+// 前 17 位的加权和，含非数字字符时返回 -1
+static int idChecksumScalar(const char* p) {
+  int sum = 0;
+  for (int i = 0; i < 17; ++i) {
+    if (!isDigit(p[i])) return -1;
+    sum += (p[i] - '0') * kIdWeights[i];
+  }
+  return sum;
+}
+
+// 在已算出加权和的基础上校验出生日期（0-150 岁）与校验码
+static bool finishIdCheck(const char* p, int sum, const QDate& today) {
+  if (sum < 0) return false;
+
+  QDate birth(digitsValue(p + 6, 4), digitsValue(p + 10, 2),
+              digitsValue(p + 12, 2));
+  if (!birth.isValid()) return false;
+  int age = birth.daysTo(today) / 365;
+  if (age < 0 || age > 150) return false;
+
+  char check = p[17] == 'x' ? 'X' : p[17];
+  return kCheckCodes[sum % 11] == check;
+}
+
+// mask 第 i 位表示第 i 个字符为数字
+static inline bool digitsAt(quint32 mask, int from, int count) {
+  quint32 bits = ((1u << count) - 1) << from;
+  return (mask & bits) == bits;
+}
+
+static quint32 digitMaskScalar(const char* p, int length) {
+  quint32 mask = 0;
+  for (int i = 0; i < length; ++i) {
+    if (isDigit(p[i])) mask |= 1u << i;
+  }
+  return mask;
+}
+
+static bool checkPhone(const char* p, int length, quint32 mask) {
+  if (length < 10) return false;
+
+  // 手机号码：1 开头，第二位 3-9，共 11 位数字
+  if (length == 11 && p[0] == '1' && p[1] >= '3' && p[1] <= '9' &&
+      digitsAt(mask, 2, 9)) {
+    return true;
+  }
+
+  // 400 电话：400 加可选的 -，再加 7 位数字
+  if (p[0] == '4' && p[1] == '0' && p[2] == '0') {
+    int tail = p[3] == '-' ? 4 : 3;
+    return length - tail == 7 && digitsAt(mask, tail, 7);
+  }
+
+  // 固定电话：0 加 2-3 位区号，可选的 -，再加 7-8 位号码
+  if (p[0] == '0') {
+    for (int dash = 3; dash <= 4; ++dash) {
+      if (p[dash] == '-') {
+        int tail = length - dash - 1;
+        return (tail == 7 || tail == 8) && digitsAt(mask, 1, dash - 1) &&
+               digitsAt(mask, dash + 1, tail);
+      }
+    }
+    return length <= 12 && digitsAt(mask, 1, length - 1);
+  }
+  return false;
+}
+
+// 批量内核：按 CPU 在运行时选择（编译进来的内核才可选）
+enum BatchKernel { ScalarKernel, Sse41Kernel, Avx2Kernel };
+
+static BatchKernel detectBatchKernel() {
+#if defined(__GNUC__) && (defined(INPUTVALIDATOR_SSE41) || \
+                          defined(INPUTVALIDATOR_AVX2))
+  __builtin_cpu_init();
+#if defined(INPUTVALIDATOR_AVX2) && defined(INPUTVALIDATOR_SSE41)
+  if (__builtin_cpu_supports("avx2")) return Avx2Kernel;
+#endif
+#if defined(INPUTVALIDATOR_SSE41)
+  if (__builtin_cpu_supports("sse4.1")) return Sse41Kernel;
+#endif
+#elif defined(_MSC_VER) && (defined(INPUTVALIDATOR_SSE41) || \
+                            defined(INPUTVALIDATOR_AVX2))
+  int info[4];
+  __cpuid(info, 1);
+  bool sse41 = (info[2] & (1 << 19)) != 0;
+  bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+  __cpuidex(info, 7, 0);
+  bool avx2 = osSavesAvx && (info[1] & (1 << 5)) != 0;
+#if defined(INPUTVALIDATOR_AVX2) && defined(INPUTVALIDATOR_SSE41)
+  if (avx2 && sse41) return Avx2Kernel;
+#endif
+#if defined(INPUTVALIDATOR_SSE41)
+  if (sse41) return Sse41Kernel;
+#endif
+  Q_UNUSED(avx2);
+#endif
+  return ScalarKernel;
+}
+
+// 只检测一次（局部静态变量的初始化是线程安全的）
+static BatchKernel batchKernel() {
+  static const BatchKernel kernel = detectBatchKernel();
+  return kernel;
+}
+
+bool InputValidator::isValidIdNumber(const QString& idNumber) {
+  if (idNumber.length() != kIdLength) {
+    return false;
+  }
+
+  char bytes[kIdLength];
+  if (!toAscii(idNumber, bytes)) {
+    return false;
+  }
+  return finishIdCheck(bytes, idChecksumScalar(bytes), QDate::currentDate());
+}
+
+bool InputValidator::isValidPhoneNumber(const QString& phone) {
+  if (phone.length() > kPhoneStride) {
+    return false;
+  }
+
+  char bytes[kPhoneStride];
+  if (!toAscii(phone, bytes)) {
+    return false;
+  }
+  return checkPhone(bytes, phone.length(),
+                    digitMaskScalar(bytes, phone.length()));
+}
+
+QVector<bool> InputValidator::validateIdNumbers(const QStringList& idNumbers) {
+  const int count = idNumbers.size();
+
+  // 打包为连续的定长记录；长度或字符不符的记录保持全零，必然校验失败
+  QByteArray packed(count * kIdLength, '\0');
+  char* base = packed.data();
+  for (int i = 0; i < count; ++i) {
+    char* record = base + i * kIdLength;
+    const QString& idNumber = idNumbers[i];
+    if (idNumber.length() != kIdLength || !toAscii(idNumber, record)) {
+      std::memset(record, 0, kIdLength);
+    }
+  }
+
+  QVector<int> sums(count);
+  int* sum = sums.data();
+  int i = 0;
+  BatchKernel kernel = batchKernel();
+#if defined(INPUTVALIDATOR_AVX2)
+  if (kernel == Avx2Kernel) {
+    i = InputValidatorKernels::idChecksumsAvx2(base, count, sum);
+  }
+#endif
+#if defined(INPUTVALIDATOR_SSE41)
+  // AVX2 余下的奇数条也由 SSE4.1 内核处理
+  if (kernel != ScalarKernel) {
+    InputValidatorKernels::idChecksumsSse41(base + i * kIdLength, count - i,
+                                            sum + i);
+    i = count;
+  }
+#endif
+  for (; i < count; ++i) sum[i] = idChecksumScalar(base + i * kIdLength);
+
+  // 出生日期与校验码逐条检查，当前日期只取一次
+  QDate today = QDate::currentDate();
+  QVector<bool> results(count);
+  for (i = 0; i < count; ++i) {
+    results[i] = finishIdCheck(base + i * kIdLength, sum[i], today);
+  }
+  return results;
+}
+
+QVector<bool> InputValidator::validatePhoneNumbers(const QStringList& phones) {
+  const int count = phones.size();
+
+  // 打包为 16 字节定长记录，过长或含非 ASCII 字符的记录长度记为 0
+  QByteArray packed(count * kPhoneStride, '\0');
+  char* base = packed.data();
+  QVector<int> lengths(count, 0);
+  for (int i = 0; i < count; ++i) {
+    const QString& phone = phones[i];
+    if (phone.length() <= kPhoneStride &&
+        toAscii(phone, base + i * kPhoneStride)) {
+      lengths[i] = phone.length();
+    }
+  }
+
+  QVector<quint32> masks(count);
+  quint32* mask = masks.data();
+  int i = 0;
+  BatchKernel kernel = batchKernel();
+#if defined(INPUTVALIDATOR_AVX2)
+  if (kernel == Avx2Kernel) {
+    i = InputValidatorKernels::digitMasksAvx2(base, count, mask);
+  }
+#endif
+#if defined(INPUTVALIDATOR_SSE41)
+  // AVX2 余下的奇数条也由 SSE4.1 内核处理
+  if (kernel != ScalarKernel) {
+    InputValidatorKernels::digitMasksSse41(base + i * kPhoneStride, count - i,
+                                           mask + i);
+    i = count;
+  }
+#endif
+  for (; i < count; ++i) {
+    mask[i] = digitMaskScalar(base + i * kPhoneStride, kPhoneStride);
+  }
+
+  QVector<bool> results(count);
+  for (i = 0; i < count; ++i) {
+    results[i] = checkPhone(base + i * kPhoneStride, lengths[i], mask[i]);
+  }
+  return results;
+}
+
+QString InputValidator::genderFromIdNumber(const QString& idNumber) {
+  if (idNumber.length() != kIdLength) {
+    return "";
+  }
+  int genderCode = idNumber.at(16).digitValue();
+  return genderCode % 2 == 1 ? "男" : "女";
+}
+
+int InputValidator::ageFromIdNumber(const QString& idNumber) {
+  if (idNumber.length() != kIdLength) {
+    return 0;
+  }
+
+  QDate birth(idNumber.midRef(6, 4).toInt(), idNumber.midRef(10, 2).toInt(),
+              idNumber.midRef(12, 2).toInt());
+  if (!birth.isValid()) {
+    return 0;
+  }
+  return birth.daysTo(QDate::currentDate()) / 365;
+}
+
+QString InputValidator::batchKernelName() {
+  switch (batchKernel()) {
+    case Avx2Kernel:
+      return "AVX2";
+    case Sse41Kernel:
+      return "SSE4.1";
+    default:
+      return "标量";
+  }
+}
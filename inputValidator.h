@@ -0,0 +1,30 @@
+#ifndef INPUTVALIDATOR_H
+#define INPUTVALIDATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 患者输入校验（身份证号、电话号码），不使用正则表达式，可在多个线程中
+// 同时调用。批量接口供导入与完整性检查使用：运行时按 CPU 选择 AVX2 /
+// SSE4.1 内核一次处理多条记录，其余平台退回逐条校验，结果一致。
+class InputValidator {
+ public:
+  // 18 位身份证号：格式、出生日期（0-150 岁）与 GB 11643 校验码
+  static bool isValidIdNumber(const QString& idNumber);
+  // 手机号、固定电话（区号可带 -）或 400 电话
+  static bool isValidPhoneNumber(const QString& phone);
+
+  // 批量校验，返回值与输入一一对应
+  static QVector<bool> validateIdNumbers(const QStringList& idNumbers);
+  static QVector<bool> validatePhoneNumbers(const QStringList& phones);
+
+  // 从身份证号读取性别与年龄，长度不符时返回空串 / 0
+  static QString genderFromIdNumber(const QString& idNumber);
+  static int ageFromIdNumber(const QString& idNumber);
+
+  // 当前使用的批量内核名称（"AVX2"、"SSE4.1" 或 "标量"）
+  static QString batchKernelName();
+};
+
+#endif
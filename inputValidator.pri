@@ -0,0 +1,24 @@
+# 输入校验模块：批量内核按文件单独加 SIMD 编译选项（Qt 的 simd.prf 生成
+# 额外编译器），其余代码仍按基线指令集编译，运行时再按 CPU 选择内核。
+# 主程序与 tests/ 下的基准测试共用此文件。
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/inputValidator.cpp
+
+HEADERS += \
+    $$PWD/inputValidator.h \
+    $$PWD/inputValidatorKernels.h
+
+contains(QT_ARCH, x86_64)|contains(QT_ARCH, i386) {
+    CONFIG += simd
+    !isEmpty(QMAKE_CFLAGS_SSE4_1) {
+        DEFINES += INPUTVALIDATOR_SSE41
+        SSE4_1_SOURCES += $$PWD/inputValidatorSse41.cpp
+    }
+    # AVX2 内核剩余的奇数条由 SSE4.1 内核处理，两者需同时可用
+    !isEmpty(QMAKE_CFLAGS_SSE4_1):!isEmpty(QMAKE_CFLAGS_AVX2) {
+        DEFINES += INPUTVALIDATOR_AVX2
+        AVX2_SOURCES += $$PWD/inputValidatorAvx2.cpp
+    }
+}
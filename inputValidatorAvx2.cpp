@@ -0,0 +1,68 @@
+// 本文件以 AVX2 指令集编译（见 inputValidator.pri），只在运行时确认
+// CPU 支持后调用
+#include <immintrin.h>
+
+#include "inputValidatorKernels.h"
+
+static const int kIdLength = 18;
+static const int kPhoneStride = 16;
+
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// 两条记录分别放入 256 位寄存器的高低两半同时处理
+static inline __m256i loadDigitPair(const char* a, const char* b) {
+  __m256i pair = _mm256_inserti128_si256(
+      _mm256_castsi128_si256(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(a))),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)), 1);
+  return _mm256_sub_epi8(pair, _mm256_set1_epi8('0'));
+}
+
+// 为数字的字节对应位为 1（低 16 位为第一条记录）
+static inline quint32 digitMask(__m256i digits) {
+  __m256i lanes = _mm256_cmpeq_epi8(
+      _mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+  return static_cast<quint32>(_mm256_movemask_epi8(lanes));
+}
+
+int InputValidatorKernels::idChecksumsAvx2(const char* records, int count,
+                                           int* sums) {
+  const __m256i weights = _mm256_setr_epi8(
+      7, 9, 10, 5, 8, 4, 2, 1, 6, 3, 7, 9, 10, 5, 8, 4, 7, 9, 10, 5, 8, 4, 2,
+      1, 6, 3, 7, 9, 10, 5, 8, 4);
+  int i = 0;
+  for (; i + 1 < count; i += 2) {
+    const char* a = records + i * kIdLength;
+    const char* b = a + kIdLength;
+    __m256i digits = loadDigitPair(a, b);
+    quint32 mask = digitMask(digits);
+
+    __m256i total = _mm256_madd_epi16(_mm256_maddubs_epi16(digits, weights),
+                                      _mm256_set1_epi16(1));
+    total = _mm256_hadd_epi32(total, total);
+    total = _mm256_hadd_epi32(total, total);
+
+    // 第 17 位的权重为 2
+    sums[i] = -1;
+    if ((mask & 0xFFFF) == 0xFFFF && isDigit(a[16])) {
+      sums[i] = _mm256_extract_epi32(total, 0) + (a[16] - '0') * 2;
+    }
+    sums[i + 1] = -1;
+    if ((mask >> 16) == 0xFFFF && isDigit(b[16])) {
+      sums[i + 1] = _mm256_extract_epi32(total, 4) + (b[16] - '0') * 2;
+    }
+  }
+  return i;
+}
+
+int InputValidatorKernels::digitMasksAvx2(const char* records, int count,
+                                          quint32* masks) {
+  int i = 0;
+  for (; i + 1 < count; i += 2) {
+    const char* a = records + i * kPhoneStride;
+    quint32 pair = digitMask(loadDigitPair(a, a + kPhoneStride));
+    masks[i] = pair & 0xFFFF;
+    masks[i + 1] = pair >> 16;
+  }
+  return i;
+}
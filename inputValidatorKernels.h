@@ -0,0 +1,24 @@
+#ifndef INPUTVALIDATORKERNELS_H
+#define INPUTVALIDATORKERNELS_H
+
+#include <QtGlobal>
+
+// 批量校验的 SIMD 内核，输入为 InputValidator 打包好的定长记录（身份证号
+// 每条 18 字节，电话号码每条 16 字节）。各指令集的内核在单独的编译单元中
+// 以对应的编译选项（-msse4.1 / -mavx2）编译，只能在 InputValidator 运行时
+// 确认 CPU 支持后调用
+namespace InputValidatorKernels {
+
+// 前 17 位的加权和，含非数字字符时为 -1
+void idChecksumsSse41(const char* records, int count, int* sums);
+// 每条记录 16 个字符是否为数字的位掩码
+void digitMasksSse41(const char* records, int count, quint32* masks);
+
+// AVX2 每次处理两条记录，返回已处理的条数（偶数），其余由 SSE4.1 内核
+// 处理
+int idChecksumsAvx2(const char* records, int count, int* sums);
+int digitMasksAvx2(const char* records, int count, quint32* masks);
+
+}  // namespace InputValidatorKernels
+
+#endif
@@ -0,0 +1,49 @@
+// 本文件以 SSE4.1 指令集编译（见 inputValidator.pri），只在运行时确认
+// CPU 支持后调用
+#include <smmintrin.h>
+
+#include "inputValidatorKernels.h"
+
+static const int kIdLength = 18;
+static const int kPhoneStride = 16;
+
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// 16 字节中为数字的字节置 0xFF（减 '0' 后按无符号数不超过 9）
+static inline __m128i digitLanes(__m128i digits) {
+  return _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+}
+
+static inline __m128i loadDigits(const char* p) {
+  return _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)),
+                      _mm_set1_epi8('0'));
+}
+
+void InputValidatorKernels::idChecksumsSse41(const char* records, int count,
+                                             int* sums) {
+  const __m128i weights =
+      _mm_setr_epi8(7, 9, 10, 5, 8, 4, 2, 1, 6, 3, 7, 9, 10, 5, 8, 4);
+  for (int i = 0; i < count; ++i) {
+    const char* p = records + i * kIdLength;
+    __m128i digits = loadDigits(p);
+    if (!_mm_test_all_ones(digitLanes(digits)) || !isDigit(p[16])) {
+      sums[i] = -1;
+      continue;
+    }
+
+    // 字节乘加到 16 位，再两两相加到 32 位，最后水平求和
+    __m128i total = _mm_madd_epi16(_mm_maddubs_epi16(digits, weights),
+                                   _mm_set1_epi16(1));
+    total = _mm_hadd_epi32(total, total);
+    total = _mm_hadd_epi32(total, total);
+    sums[i] = _mm_cvtsi128_si32(total) + (p[16] - '0') * 2;
+  }
+}
+
+void InputValidatorKernels::digitMasksSse41(const char* records, int count,
+                                            quint32* masks) {
+  for (int i = 0; i < count; ++i) {
+    __m128i digits = loadDigits(records + i * kPhoneStride);
+    masks[i] = static_cast<quint32>(_mm_movemask_epi8(digitLanes(digits)));
+  }
+}
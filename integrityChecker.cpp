@@ -0,0 +1,454 @@
+#include "integrityChecker.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPair>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+#include "inputValidator.h"
+
+namespace {
+
+// 各工作线程共享的只读上下文
+struct CheckContext {
+  const QList<Appointment>* appointments = nullptr;
+  const AppointmentManager* appointmentManager = nullptr;
+  QHash<QString, const Expert*> experts;  // 专家姓名 -> 专家
+};
+
+}  // namespace
+
+static IntegrityIssue appointmentIssue(IntegrityIssue::Kind kind, int index,
+                                       const Appointment& appointment,
+                                       const QString& detail) {
+  IntegrityIssue issue;
+  issue.kind = kind;
+  issue.appointmentIndexes.append(index);
+  issue.expertName = appointment.expertName;
+  issue.date = appointment.appointmentDate;
+  issue.serviceTime = appointment.serviceTime;
+  issue.detail = detail;
+  return issue;
+}
+
+// 逐条检查 [begin, end) 范围内的预约
+static QList<IntegrityIssue> checkAppointments(const CheckContext* context,
+                                               int begin, int end) {
+  const QList<Appointment>& appointments = *context->appointments;
+  QList<IntegrityIssue> issues;
+
+  QStringList idNumbers;
+  QStringList phones;
+  for (int i = begin; i < end; ++i) {
+    idNumbers.append(appointments[i].idNumber);
+    phones.append(appointments[i].phone);
+  }
+  QVector<bool> idNumberValid = InputValidator::validateIdNumbers(idNumbers);
+  QVector<bool> phoneValid = InputValidator::validatePhoneNumbers(phones);
+
+  // 专家+日期 -> 当日时间段（块内大量预约落在相同的专家与日期上）
+  QHash<QPair<const Expert*, qint64>, QStringList> slotCache;
+
+  for (int i = begin; i < end; ++i) {
+    const Appointment& appointment = appointments[i];
+    if (!idNumberValid[i - begin]) {
+      issues.append(appointmentIssue(IntegrityIssue::InvalidIdNumber, i,
+                                     appointment, appointment.idNumber));
+    }
+    if (!phoneValid[i - begin]) {
+      issues.append(appointmentIssue(IntegrityIssue::InvalidPhone, i,
+                                     appointment, appointment.phone));
+    }
+
+    const QDate& date = appointment.appointmentDate;
+    if (!date.isValid()) {
+      issues.append(appointmentIssue(IntegrityIssue::InvalidDate, i,
+                                     appointment, "日期无法解析"));
+    }
+
+    const Expert* expert = context->experts.value(appointment.expertName);
+    if (!expert) {
+      issues.append(appointmentIssue(IntegrityIssue::MissingExpert, i,
+                                     appointment, appointment.expertName));
+      continue;
+    }
+    if (appointment.expertSubject != expert->subject) {
+      issues.append(appointmentIssue(
+          IntegrityIssue::SubjectMismatch, i, appointment,
+          QString("%1，应为 %2")
+              .arg(appointment.expertSubject, expert->subject)));
+    }
+    if (!date.isValid()) continue;
+
+    auto key = qMakePair(expert, date.toJulianDay());
+    auto it = slotCache.find(key);
+    if (it == slotCache.end()) {
+      QStringList slotsOfDay;
+      if (expert->isAvailableOnDate(date)) {
+        slotsOfDay = expert->getAvailableTimeSlotsForDate(date);
+      }
+      it = slotCache.insert(key, slotsOfDay);
+    }
+    if (!it.value().contains(appointment.serviceTime)) {
+      issues.append(appointmentIssue(
+          IntegrityIssue::UnknownServiceTime, i, appointment,
+          it.value().isEmpty() ? "专家当日不出诊" : "不在当日排班中"));
+    }
+  }
+  return issues;
+}
+
+// 按日期检查时间段：人数与容量、排队号唯一
+static QList<IntegrityIssue> checkSlots(const CheckContext* context,
+                                        const QList<QDate>& dates) {
+  const QList<Appointment>& appointments = *context->appointments;
+  QList<IntegrityIssue> issues;
+
+  for (const QDate& date : dates) {
+    // 当日预约由日期索引给出，再按专家+时间段分组
+    QHash<QString, QVector<int>> groups;
+    for (int index : context->appointmentManager->appointmentIndexesOn(date)) {
+      const Appointment& appointment = appointments[index];
+      groups[appointment.expertName + QChar(0x1f) + appointment.serviceTime]
+          .append(index);
+    }
+
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+      const QVector<int>& indexes = it.value();
+      const Appointment& first = appointments[indexes.first()];
+
+      IntegrityIssue issue;
+      issue.appointmentIndexes = indexes;
+      issue.expertName = first.expertName;
+      issue.date = date;
+      issue.serviceTime = first.serviceTime;
+
+      // 已约人数取自占用索引，与专家的时间段容量核对
+      const Expert* expert = context->experts.value(first.expertName);
+      if (expert) {
+        int occupied = context->appointmentManager->getSlotOccupancy(
+            first.expertName, date, first.serviceTime);
+        int capacity = expert->getTimeSlotCapacity(first.serviceTime);
+        if (occupied > capacity) {
+          issue.kind = IntegrityIssue::OverCapacity;
+          issue.detail =
+              QString("已约 %1 人，容量 %2").arg(occupied).arg(capacity);
+          issues.append(issue);
+        }
+      }
+
+      QSet<int> queueNumbers;
+      QList<int> duplicated;
+      for (int index : indexes) {
+        int queueNumber = appointments[index].queueNumber;
+        if (queueNumbers.contains(queueNumber)) {
+          duplicated.append(queueNumber);
+        }
+        queueNumbers.insert(queueNumber);
+      }
+      if (!duplicated.isEmpty()) {
+        issue.kind = IntegrityIssue::DuplicateQueueNumber;
+        QStringList numbers;
+        for (int queueNumber : duplicated) {
+          numbers.append(QString::number(queueNumber));
+        }
+        issue.detail = QString("重复排队号：%1").arg(numbers.join("、"));
+        issues.append(issue);
+      }
+    }
+  }
+  return issues;
+}
+
+int IntegrityReport::count(IntegrityIssue::Kind kind) const {
+  int total = 0;
+  for (const IntegrityIssue& issue : issues) {
+    if (issue.kind == kind) total++;
+  }
+  return total;
+}
+
+QString IntegrityReport::summaryText() const {
+  QString text = QString("检查专家 %1 位、预约 %2 条，用时 %3 毫秒。\n")
+                     .arg(expertsChecked)
+                     .arg(appointmentsChecked)
+                     .arg(elapsedMs);
+  if (isClean()) return text + "未发现问题。";
+
+  text += QString("发现 %1 个问题：\n").arg(issues.size());
+  for (int kind = IntegrityIssue::DuplicateExpertId;
+       kind <= IntegrityIssue::DuplicateQueueNumber; ++kind) {
+    int n = count(static_cast<IntegrityIssue::Kind>(kind));
+    if (n > 0) {
+      text += QString("  %1：%2\n")
+                  .arg(IntegrityChecker::kindText(
+                      static_cast<IntegrityIssue::Kind>(kind)))
+                  .arg(n);
+    }
+  }
+  return text;
+}
+
+QString IntegrityReport::detailText(int limit) const {
+  QStringList lines;
+  for (const IntegrityIssue& issue : issues) {
+    if (lines.size() >= limit) {
+      lines.append(QString("……其余 %1 条省略").arg(issues.size() - limit));
+      break;
+    }
+    QString line = QString("[%1] ").arg(IntegrityChecker::kindText(issue.kind));
+    if (!issue.appointmentIndexes.isEmpty()) {
+      QStringList rows;
+      for (int index : issue.appointmentIndexes) {
+        rows.append(QString::number(index + 1));
+      }
+      line += QString("预约第 %1 条 ").arg(rows.join(","));
+    }
+    line += issue.expertName;
+    if (issue.date.isValid()) line += " " + issue.date.toString("yyyy-MM-dd");
+    if (!issue.serviceTime.isEmpty()) line += " " + issue.serviceTime;
+    lines.append(line + "：" + issue.detail);
+  }
+  return lines.join("\n");
+}
+
+QJsonObject IntegrityReport::toJson() const {
+  QJsonObject counts;
+  for (int kind = IntegrityIssue::DuplicateExpertId;
+       kind <= IntegrityIssue::DuplicateQueueNumber; ++kind) {
+    int n = count(static_cast<IntegrityIssue::Kind>(kind));
+    if (n > 0) {
+      counts[IntegrityChecker::kindName(
+          static_cast<IntegrityIssue::Kind>(kind))] = n;
+    }
+  }
+
+  QJsonArray items;
+  for (const IntegrityIssue& issue : issues) {
+    QJsonObject obj;
+    obj["kind"] = IntegrityChecker::kindName(issue.kind);
+    QJsonArray indexes;
+    for (int index : issue.appointmentIndexes) indexes.append(index);
+    obj["appointments"] = indexes;
+    obj["expertName"] = issue.expertName;
+    if (issue.date.isValid()) {
+      obj["date"] = issue.date.toString("yyyy-MM-dd");
+    }
+    if (!issue.serviceTime.isEmpty()) obj["serviceTime"] = issue.serviceTime;
+    obj["detail"] = issue.detail;
+    obj["repairable"] = IntegrityChecker::isRepairable(issue.kind);
+    items.append(obj);
+  }
+
+  QJsonObject root;
+  root["checkedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+  root["experts"] = expertsChecked;
+  root["appointments"] = appointmentsChecked;
+  root["elapsedMs"] = static_cast<double>(elapsedMs);
+  root["clean"] = isClean();
+  root["counts"] = counts;
+  root["issues"] = items;
+  return root;
+}
+
+bool IntegrityReport::saveToFile(const QString& filename) const {
+  QFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qDebug() << "无法写入完整性检查报告：" << filename;
+    return false;
+  }
+  file.write(QJsonDocument(toJson()).toJson());
+  file.close();
+  return true;
+}
+
+IntegrityChecker::IntegrityChecker(ExpertManager* expertMgr,
+                                   AppointmentManager* appointmentMgr)
+    : expertManager(expertMgr), appointmentManager(appointmentMgr) {}
+
+IntegrityReport IntegrityChecker::check() const {
+  IntegrityReport report;
+  if (!expertManager || !appointmentManager) return report;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  CheckContext context;
+  context.appointments = &appointmentManager->getAllAppointments();
+  context.appointmentManager = appointmentManager;
+
+  // 专家数据：编号与姓名唯一，同时建立姓名索引
+  QSet<QString> expertIds;
+  for (const Expert& expert : expertManager->experts) {
+    if (expertIds.contains(expert.id)) {
+      IntegrityIssue issue;
+      issue.kind = IntegrityIssue::DuplicateExpertId;
+      issue.expertName = expert.name;
+      issue.detail = expert.id;
+      report.issues.append(issue);
+    }
+    expertIds.insert(expert.id);
+
+    if (context.experts.contains(expert.name)) {
+      IntegrityIssue issue;
+      issue.kind = IntegrityIssue::DuplicateExpertName;
+      issue.expertName = expert.name;
+      issue.detail = expert.id;
+      report.issues.append(issue);
+    } else {
+      context.experts.insert(expert.name, &expert);
+    }
+  }
+
+  // 预约按下标分块，时间段按日期分组，块数为线程数的数倍以平衡负载
+  const int total = context.appointments->size();
+  int threads = qMax(1, QThread::idealThreadCount());
+  int chunkSize = qMax(4096, total / (threads * 4) + 1);
+
+  QList<QFuture<QList<IntegrityIssue>>> futures;
+  for (int begin = 0; begin < total; begin += chunkSize) {
+    futures.append(QtConcurrent::run(checkAppointments, &context, begin,
+                                     qMin(begin + chunkSize, total)));
+  }
+
+  QList<QDate> dates = appointmentManager->appointmentDates();
+  std::sort(dates.begin(), dates.end());
+  QList<QDate> group;
+  int groupSize = 0;
+  for (const QDate& date : dates) {
+    group.append(date);
+    groupSize += appointmentManager->appointmentIndexesOn(date).size();
+    if (groupSize >= chunkSize) {
+      futures.append(QtConcurrent::run(checkSlots, &context, group));
+      group.clear();
+      groupSize = 0;
+    }
+  }
+  if (!group.isEmpty()) {
+    futures.append(QtConcurrent::run(checkSlots, &context, group));
+  }
+
+  QList<IntegrityIssue> appointmentIssues;
+  for (QFuture<QList<IntegrityIssue>>& future : futures) {
+    appointmentIssues.append(future.result());
+  }
+  std::stable_sort(appointmentIssues.begin(), appointmentIssues.end(),
+                   [](const IntegrityIssue& a, const IntegrityIssue& b) {
+                     return a.appointmentIndexes.first() <
+                            b.appointmentIndexes.first();
+                   });
+  report.issues.append(appointmentIssues);
+
+  report.expertsChecked = expertManager->experts.size();
+  report.appointmentsChecked = total;
+  report.elapsedMs = timer.elapsed();
+  qDebug() << "完整性检查完成：问题" << report.issues.size() << "个，用时"
+           << report.elapsedMs << "毫秒";
+  return report;
+}
+
+int IntegrityChecker::repair(const IntegrityReport& report) {
+  if (!expertManager || !appointmentManager) return 0;
+
+  const QList<Appointment>& appointments =
+      appointmentManager->getAllAppointments();
+  QHash<int, Appointment> updates;
+
+  for (const IntegrityIssue& issue : report.issues) {
+    if (issue.kind == IntegrityIssue::SubjectMismatch) {
+      int index = issue.appointmentIndexes.first();
+      Expert* expert = expertManager->findExpertByName(issue.expertName);
+      if (!expert || index >= appointments.size()) continue;
+      Appointment appointment = updates.value(index, appointments[index]);
+      appointment.expertSubject = expert->subject;
+      updates.insert(index, appointment);
+    } else if (issue.kind == IntegrityIssue::DuplicateQueueNumber) {
+      // 按原排队号（相同时按录入顺序）重新编号为 1..n
+      QVector<int> indexes;
+      for (int index : issue.appointmentIndexes) {
+        if (index < appointments.size()) indexes.append(index);
+      }
+      std::sort(indexes.begin(), indexes.end(), [&](int a, int b) {
+        if (appointments[a].queueNumber != appointments[b].queueNumber) {
+          return appointments[a].queueNumber < appointments[b].queueNumber;
+        }
+        return a < b;
+      });
+      for (int i = 0; i < indexes.size(); ++i) {
+        if (appointments[indexes[i]].queueNumber == i + 1) continue;
+        Appointment appointment =
+            updates.value(indexes[i], appointments[indexes[i]]);
+        appointment.queueNumber = i + 1;
+        updates.insert(indexes[i], appointment);
+      }
+    }
+  }
+
+  return appointmentManager->updateAppointments(updates);
+}
+
+QString IntegrityChecker::kindName(IntegrityIssue::Kind kind) {
+  switch (kind) {
+    case IntegrityIssue::DuplicateExpertId:
+      return "duplicateExpertId";
+    case IntegrityIssue::DuplicateExpertName:
+      return "duplicateExpertName";
+    case IntegrityIssue::MissingExpert:
+      return "missingExpert";
+    case IntegrityIssue::InvalidDate:
+      return "invalidDate";
+    case IntegrityIssue::UnknownServiceTime:
+      return "unknownServiceTime";
+    case IntegrityIssue::SubjectMismatch:
+      return "subjectMismatch";
+    case IntegrityIssue::InvalidIdNumber:
+      return "invalidIdNumber";
+    case IntegrityIssue::InvalidPhone:
+      return "invalidPhone";
+    case IntegrityIssue::OverCapacity:
+      return "overCapacity";
+    case IntegrityIssue::DuplicateQueueNumber:
+      return "duplicateQueueNumber";
+  }
+  return QString();
+}
+
+QString IntegrityChecker::kindText(IntegrityIssue::Kind kind) {
+  switch (kind) {
+    case IntegrityIssue::DuplicateExpertId:
+      return "专家编号重复";
+    case IntegrityIssue::DuplicateExpertName:
+      return "专家姓名重复";
+    case IntegrityIssue::MissingExpert:
+      return "专家不存在";
+    case IntegrityIssue::InvalidDate:
+      return "预约日期无效";
+    case IntegrityIssue::UnknownServiceTime:
+      return "时间段不在排班中";
+    case IntegrityIssue::SubjectMismatch:
+      return "科室与专家不一致";
+    case IntegrityIssue::InvalidIdNumber:
+      return "身份证号无效";
+    case IntegrityIssue::InvalidPhone:
+      return "电话号码无效";
+    case IntegrityIssue::OverCapacity:
+      return "时间段超出容量";
+    case IntegrityIssue::DuplicateQueueNumber:
+      return "排队号重复";
+  }
+  return QString();
+}
+
+bool IntegrityChecker::isRepairable(IntegrityIssue::Kind kind) {
+  return kind == IntegrityIssue::SubjectMismatch ||
+         kind == IntegrityIssue::DuplicateQueueNumber;
+}
@@ -0,0 +1,74 @@
+#ifndef INTEGRITYCHECKER_H
+#define INTEGRITYCHECKER_H
+
+#include <QDate>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "appointmentManager.h"
+#include "expertManager.h"
+
+// 一条数据完整性问题
+struct IntegrityIssue {
+  enum Kind {
+    DuplicateExpertId = 0,  // 专家编号重复
+    DuplicateExpertName,    // 专家姓名重复（预约按姓名关联，无法区分）
+    MissingExpert,          // 预约引用的专家不存在
+    InvalidDate,            // 预约日期无效
+    UnknownServiceTime,     // 时间段不在专家当日排班中
+    SubjectMismatch,        // 预约科室与专家科室不一致
+    InvalidIdNumber,        // 身份证号校验失败
+    InvalidPhone,           // 电话号码无效
+    OverCapacity,           // 时间段预约人数超过容量
+    DuplicateQueueNumber    // 同一时间段排队号重复
+  };
+
+  Kind kind;
+  QVector<int> appointmentIndexes;  // 涉及的预约下标（专家问题为空）
+  QString expertName;
+  QDate date;
+  QString serviceTime;
+  QString detail;
+};
+
+// 完整性检查结果
+struct IntegrityReport {
+  int expertsChecked = 0;
+  int appointmentsChecked = 0;
+  qint64 elapsedMs = 0;
+  QList<IntegrityIssue> issues;  // 专家问题在前，预约问题按下标排序
+
+  bool isClean() const { return issues.isEmpty(); }
+  int count(IntegrityIssue::Kind kind) const;
+  QString summaryText() const;  // 各类问题数量
+  QString detailText(int limit = 200) const;  // 问题明细（最多 limit 条）
+  QJsonObject toJson() const;   // 机器可读的完整报告
+  bool saveToFile(const QString& filename) const;  // 以 JSON 写出报告
+};
+
+// 专家与预约数据的完整性检查：预约按下标分块、时间段按日期分组，
+// 在线程池中并行扫描，通过专家姓名索引与预约的日期/占用索引交叉核对。
+// 只检查已载入内存的预约分区；检查期间只读访问两个管理器，调用方需保证
+// 数据不被同时修改。
+class IntegrityChecker {
+ public:
+  IntegrityChecker(ExpertManager* expertMgr,
+                   AppointmentManager* appointmentMgr);
+
+  IntegrityReport check() const;
+  // 自动修复可安全修复的问题（科室不一致、排队号重复），需紧接在 check()
+  // 之后调用；只发出一次变更通知，返回被修改的预约数
+  int repair(const IntegrityReport& report);
+
+  static QString kindName(IntegrityIssue::Kind kind);  // 报告中的英文标识
+  static QString kindText(IntegrityIssue::Kind kind);  // 界面显示的说明
+  static bool isRepairable(IntegrityIssue::Kind kind);
+
+ private:
+  ExpertManager* expertManager;
+  AppointmentManager* appointmentManager;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#include "jsonImport.h"
+
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+static const int kChunkSize = 64 * 1024;
+
+QString MergeSummary::toText() const {
+  QString text = QString("新增 %1 条，更新 %2 条，未变化 %3 条，跳过 %4 条")
+                     .arg(inserted)
+                     .arg(updated)
+                     .arg(unchanged)
+                     .arg(rejected);
+  if (!messages.isEmpty()) {
+    // 原因较多时只列出前若干条
+    const int maxLines = 20;
+    text += "\n" + messages.mid(0, maxLines).join("\n");
+    if (messages.size() > maxLines) {
+      text += QString("\n……等共 %1 条").arg(messages.size());
+    }
+  }
+  return text;
+}
+
+JsonArrayReader::JsonArrayReader(const QString& filename)
+    : file(filename), pos(0) {}
+
+bool JsonArrayReader::open() {
+  if (!file.open(QIODevice::ReadOnly)) {
+    fail(QString("无法打开文件: %1").arg(file.fileName()));
+    return false;
+  }
+
+  // 跳过 UTF-8 BOM
+  if (ensure(2) && buffer.startsWith("\xEF\xBB\xBF")) pos = 3;
+
+  if (!skipWhitespace(false) || buffer[pos] != '[') {
+    fail("无效的JSON格式：需要数组");
+    return false;
+  }
+  pos++;
+  return true;
+}
+
+bool JsonArrayReader::next(QJsonObject* object) {
+  while (error.isEmpty()) {
+    if (!skipWhitespace(true)) {
+      fail("文件意外结束");
+      return false;
+    }
+    if (buffer[pos] == ']') return false;  // 数组结束
+
+    char first = buffer[pos];
+    int end = 0;
+    if (!scanValue(&end)) return false;
+
+    QByteArray bytes = buffer.mid(pos, end - pos);
+    pos = end;
+    if (pos > kChunkSize) {
+      buffer.remove(0, pos);
+      pos = 0;
+    }
+
+    // 与整体加载保持一致：非对象元素直接跳过
+    if (first != '{') continue;
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(bytes, &parseError);
+    if (!doc.isObject()) {
+      fail(QString("无效的JSON对象：%1").arg(parseError.errorString()));
+      return false;
+    }
+    *object = doc.object();
+    return true;
+  }
+  return false;
+}
+
+bool JsonArrayReader::hasError() const { return !error.isEmpty(); }
+
+QString JsonArrayReader::errorString() const { return error; }
+
+bool JsonArrayReader::ensure(int index) {
+  while (index >= buffer.size()) {
+    if (file.atEnd()) return false;
+    QByteArray chunk = file.read(kChunkSize);
+    if (chunk.isEmpty()) return false;
+    buffer.append(chunk);
+  }
+  return true;
+}
+
+bool JsonArrayReader::skipWhitespace(bool skipCommas) {
+  while (ensure(pos)) {
+    char c = buffer[pos];
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+        (skipCommas && c == ',')) {
+      pos++;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool JsonArrayReader::scanValue(int* end) {
+  int depth = 0;
+  bool inString = false;
+  bool escaped = false;
+
+  for (int i = pos;; ++i) {
+    if (!ensure(i)) {
+      fail("文件意外结束");
+      return false;
+    }
+
+    char c = buffer[i];
+    if (inString) {
+      if (escaped) {
+        escaped = false;
+      } else if (c == '\\') {
+        escaped = true;
+      } else if (c == '"') {
+        inString = false;
+        if (depth == 0) {
+          *end = i + 1;
+          return true;
+        }
+      }
+    } else if (c == '"') {
+      inString = true;
+    } else if (c == '{' || c == '[') {
+      depth++;
+    } else if (c == '}' || c == ']') {
+      if (depth == 0) {  // 数组结束，当前为标量值
+        *end = i;
+        return true;
+      }
+      if (--depth == 0) {
+        *end = i + 1;
+        return true;
+      }
+    } else if (c == ',' && depth == 0) {
+      *end = i;
+      return true;
+    }
+  }
+}
+
+void JsonArrayReader::fail(const QString& message) {
+  if (error.isEmpty()) error = message;
+}
@@ -0,0 +1,44 @@
+#ifndef JSONIMPORT_H
+#define JSONIMPORT_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+// 合并导入的差异统计
+struct MergeSummary {
+  int inserted = 0;   // 新增记录数
+  int updated = 0;    // 内容有变化而更新的记录数
+  int unchanged = 0;  // 与现有记录完全一致的记录数
+  int rejected = 0;   // 校验未通过而跳过的记录数
+  QStringList messages;  // 被跳过记录的原因
+
+  QString toText() const;  // 汇总为一段提示文字
+};
+
+// 流式读取 JSON 数组文件：按块读入，每次只解析数组中的一个元素，
+// 内存占用与单条记录大小相关而与文件大小无关。
+class JsonArrayReader {
+ public:
+  explicit JsonArrayReader(const QString& filename);
+
+  bool open();                     // 打开文件并定位到数组开头
+  bool next(QJsonObject* object);  // 读取下一个对象，读完或出错时返回false
+  bool hasError() const;
+  QString errorString() const;
+
+ private:
+  QFile file;
+  QByteArray buffer;  // 已读入但尚未消费的数据
+  int pos;            // buffer 中的当前位置
+  QString error;
+
+  bool ensure(int index);  // 保证 buffer 中至少有 index + 1 个字节
+  bool skipWhitespace(bool skipCommas);
+  bool scanValue(int* end);  // 找到当前位置开始的一个 JSON 值的结束位置
+  void fail(const QString& message);
+};
+
+#endif
@@ -0,0 +1,238 @@
+#include "localIntentMatcher.h"
+
+#include <QStringList>
+
+#include "availabilityIndex.h"
+
+static const int kMaxAnswerDates = 7;
+
+// 分诊问句中的固定说法与常见虚词：不是症状，推荐前从问题中去掉，以免
+// 参与 BM25 打分
+static const QStringList kTriageWords = {"挂什么科", "挂哪个科", "挂哪科",
+                                         "看什么科", "看哪个科", "什么科室",
+                                         "哪个科室", "推荐科室"};
+static const QStringList kTriageFillers = {"请问", "应该", "需要", "我",
+                                           "该", "要", "去", "吗", "呢"};
+
+static bool containsAny(const QString& text, const QStringList& words) {
+  for (const QString& word : words) {
+    if (text.contains(word)) return true;
+  }
+  return false;
+}
+
+static QString dateText(const QDate& date) {
+  return QString("%1（%2）")
+      .arg(date.toString("yyyy-MM-dd"))
+      .arg(Expert::getDayOfWeekString(date));
+}
+
+LocalIntentMatcher::LocalIntentMatcher(ExpertManager* expertMgr,
+                                       AppointmentManager* appointmentMgr,
+                                       DepartmentRecommender* recommender,
+                                       AvailabilityIndex* availability)
+    : expertManager(expertMgr),
+      appointmentManager(appointmentMgr),
+      departmentRecommender(recommender),
+      availabilityIndex(availability) {}
+
+LocalAnswer LocalIntentMatcher::answer(const QString& query,
+                                       const QueryEntities& entities) const {
+  LocalAnswer result;
+  // 分诊问题（没有指定专家或科室）：按历史预约的症状描述推荐科室
+  if (departmentRecommender && entities.expertNames.isEmpty() &&
+      entities.departments.isEmpty() && containsAny(query, kTriageWords)) {
+    return recommend(query);
+  }
+  if (!expertManager || entities.dates.isEmpty()) return result;
+
+  // 需要推理或建议的问题交给远程模型
+  static const QStringList kOpenEnded = {"推荐", "哪个好", "哪位好", "症状",
+                                         "怎么", "为什么", "应该", "区别",
+                                         "建议", "比较"};
+  if (containsAny(query, kOpenEnded)) return result;
+
+  // 费用、位置等问题即使提到日期和科室也不是出诊/余号查询（“明天外科
+  // 挂号费多少钱”、“外科门诊在几楼”）
+  static const QStringList kOtherTopics = {"费", "钱", "价格", "报销",
+                                           "在哪", "几楼", "怎么走", "地址"};
+  if (containsAny(query, kOtherTopics)) return result;
+
+  // 只认明确的出诊 / 余号说法，“号”“多少”“门诊”这类单字或泛称不算
+  static const QStringList kDutyWords = {"出诊", "上班", "坐诊", "值班",
+                                         "在吗", "在不在"};
+  static const QStringList kSlotWords = {
+      "余号", "剩余号", "剩下的号", "还有号", "有号吗", "几个号", "多少号",
+      "多少个号", "名额", "能约", "可以约", "能挂", "约满", "挂得上", "号满"};
+  bool askDuty = containsAny(query, kDutyWords);
+  bool askSlots = containsAny(query, kSlotWords);
+  if (!askDuty && !askSlots) return result;
+
+  QList<QDate> dates = entities.dates.mid(0, kMaxAnswerDates);
+  QStringList lines;
+
+  if (!entities.expertNames.isEmpty()) {
+    // 专家出诊 / 余号
+    for (const QString& name : entities.expertNames) {
+      Expert* expert = expertManager->findExpertByName(name);
+      if (!expert) continue;
+      for (const QDate& date : dates) {
+        int remaining = 0;
+        lines.append(describeExpertDay(*expert, date, &remaining));
+      }
+    }
+    result.intent = askSlots ? "remainingSlots" : "expertOnDuty";
+  } else if (!entities.departments.isEmpty()) {
+    // 科室余号：“心内科”同时命中“内科”时只保留更具体的科室
+    QStringList departments;
+    for (const QString& department : entities.departments) {
+      bool covered = false;
+      for (const QString& other : entities.departments) {
+        if (other != department && other.contains(department)) covered = true;
+      }
+      if (!covered) departments.append(department);
+    }
+
+    for (const QString& department : departments) {
+      for (const QDate& date : dates) {
+        // 只问余号且日期在余号索引窗口内时，由位图直接给出仍有余号的
+        // 专家，不逐个检查该科室的全部专家
+        if (askSlots && !askDuty && availabilityIndex &&
+            availabilityIndex->covers(date)) {
+          lines.append(describeFreeExperts(department, date));
+          continue;
+        }
+
+        QStringList expertLines;
+        int onDuty = 0;
+        int total = 0;
+        for (const Expert& expert : expertManager->experts) {
+          if (expert.subject != department ||
+              !expert.isAvailableOnDate(date)) {
+            continue;
+          }
+          int remaining = 0;
+          expertLines.append("  " +
+                             describeExpertDay(expert, date, &remaining));
+          onDuty++;
+          total += remaining;
+        }
+        if (onDuty == 0) {
+          lines.append(QString("%1 %2 没有专家出诊。")
+                           .arg(department)
+                           .arg(dateText(date)));
+        } else {
+          lines.append(QString("%1 %2 共 %3 位专家出诊，剩余 %4 个号：")
+                           .arg(department)
+                           .arg(dateText(date))
+                           .arg(onDuty)
+                           .arg(total));
+          lines.append(expertLines);
+        }
+      }
+    }
+    result.intent = "remainingSlots";
+  } else {
+    return result;  // 没有提到专家或科室
+  }
+
+  if (lines.isEmpty()) return result;
+  result.matched = true;
+  result.text = lines.join("\n");
+  return result;
+}
+
+// 按问题中的症状推荐科室与各科室最匹配的专家；去掉分诊说法后没有症状，
+// 或没有相似的历史症状时交给远程模型
+LocalAnswer LocalIntentMatcher::recommend(const QString& query) const {
+  LocalAnswer result;
+  QString symptoms = query;
+  for (const QString& word : kTriageWords) symptoms.remove(word);
+  for (const QString& word : kTriageFillers) symptoms.remove(word);
+  if (DepartmentRecommender::tokenize(symptoms).isEmpty()) return result;
+
+  QList<Recommendation> departments =
+      departmentRecommender->recommendDepartments(symptoms);
+  if (departments.isEmpty()) return result;
+
+  QStringList lines;
+  lines.append("根据历史预约中相似症状的就诊情况，建议挂以下科室：");
+  for (const Recommendation& department : departments) {
+    QString line = QString("  %1（匹配度 %2%）")
+                       .arg(department.name)
+                       .arg(qRound(department.share * 100));
+    QStringList names;
+    for (const Recommendation& expert : departmentRecommender->recommendExperts(
+             symptoms, department.name, 2)) {
+      names.append(expert.name);
+    }
+    if (!names.isEmpty()) line += "，可选专家：" + names.join("、");
+    lines.append(line);
+  }
+  lines.append("以上仅为按历史预约统计的参考，不能代替医生诊断。");
+
+  result.matched = true;
+  result.intent = "recommendDepartment";
+  result.text = lines.join("\n");
+  return result;
+}
+
+// 某科室某日仍有余号的专家（由余号索引给出）及各自的时间段余号
+QStringList LocalIntentMatcher::describeFreeExperts(const QString& department,
+                                                    const QDate& date) const {
+  QStringList expertLines;
+  int total = 0;
+  for (const QString& name : availabilityIndex->freeExperts(date, department)) {
+    Expert* expert = expertManager->findExpertByName(name);
+    if (!expert) continue;
+    int remaining = 0;
+    expertLines.append("  " + describeExpertDay(*expert, date, &remaining));
+    total += remaining;
+  }
+
+  if (expertLines.isEmpty()) {
+    return QStringList() << QString("%1 %2 没有可预约的号（无专家出诊或均已"
+                                    "约满）。")
+                                .arg(department)
+                                .arg(dateText(date));
+  }
+  QStringList lines;
+  lines.append(QString("%1 %2 有 %3 位专家还有号，共剩余 %4 个号：")
+                   .arg(department)
+                   .arg(dateText(date))
+                   .arg(expertLines.size())
+                   .arg(total));
+  lines.append(expertLines);
+  return lines;
+}
+
+// 某专家某日的出诊情况与各时间段余号
+QString LocalIntentMatcher::describeExpertDay(const Expert& expert,
+                                              const QDate& date,
+                                              int* remaining) const {
+  *remaining = 0;
+  if (!expert.isAvailableOnDate(date)) {
+    return QString("%1 %2 不出诊。").arg(expert.name).arg(dateText(date));
+  }
+
+  QStringList slotTexts;
+  for (const QString& timeSlot : expert.getAvailableTimeSlotsForDate(date)) {
+    int capacity = expert.getTimeSlotCapacity(timeSlot);
+    int booked = appointmentManager ? appointmentManager->getSlotOccupancy(
+                                          expert.name, date, timeSlot)
+                                    : 0;
+    int left = qMax(0, capacity - booked);
+    *remaining += left;
+    if (left > 0) {
+      slotTexts.append(QString("%1 剩余 %2 个号").arg(timeSlot).arg(left));
+    } else {
+      slotTexts.append(QString("%1 已约满").arg(timeSlot));
+    }
+  }
+  return QString("%1（%2 %3）%4 出诊：%5")
+      .arg(expert.name)
+      .arg(expert.subject)
+      .arg(expert.title)
+      .arg(dateText(date))
+      .arg(slotTexts.join("；"));
+}
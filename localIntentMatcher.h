@@ -0,0 +1,50 @@
+#ifndef LOCALINTENTMATCHER_H
+#define LOCALINTENTMATCHER_H
+
+#include <QDate>
+#include <QString>
+
+#include "aiContextBuilder.h"
+#include "appointmentManager.h"
+#include "departmentRecommender.h"
+#include "expertManager.h"
+
+class AvailabilityIndex;
+
+// 本地直接回答的结果
+struct LocalAnswer {
+  bool matched = false;
+  QString intent;  // expertOnDuty / remainingSlots / recommendDepartment
+  QString text;    // 回答内容（纯文本）
+};
+
+// 本地意图匹配：识别确定性的出诊/余号查询（“张三周三出诊吗”、“外科明天
+// 还有几个号”），直接由专家排班与预约占用索引作答，不经过远程模型。
+// 只依赖两个管理器与已识别的实体，可脱离界面与网络单独调用。提供
+// recommender 时，“头痛发烧挂什么科”这类分诊问题也按历史预约本地推荐；
+// 提供 availability（主窗口的余号索引）时，科室余号直接由位图给出
+class LocalIntentMatcher {
+ public:
+  LocalIntentMatcher(ExpertManager* expertMgr,
+                     AppointmentManager* appointmentMgr,
+                     DepartmentRecommender* recommender = nullptr,
+                     AvailabilityIndex* availability = nullptr);
+
+  // 无法确定作答时返回 matched = false，由远程模型回答
+  LocalAnswer answer(const QString& query,
+                     const QueryEntities& entities) const;
+
+ private:
+  ExpertManager* expertManager;
+  AppointmentManager* appointmentManager;
+  DepartmentRecommender* departmentRecommender;
+  AvailabilityIndex* availabilityIndex;
+
+  LocalAnswer recommend(const QString& query) const;
+  QStringList describeFreeExperts(const QString& department,
+                                  const QDate& date) const;
+  QString describeExpertDay(const Expert& expert, const QDate& date,
+                            int* remaining) const;
+};
+
+#endif
@@ -7,6 +7,8 @@
 #include <QLineEdit>
 #include <QMenu>
 #include <QMessageBox>
+#include <QNetworkAccessManager>
+#include <QPushButton>
 #include <QSettings>
 #include <QSslSocket>
 #include <QStandardItemModel>
@@ -15,8 +17,15 @@
 
 #include "adminDialog.h"
 #include "aiChatDialog.h"
+#include "aiResponseCache.h"
+#include "appointmentArchive.h"
+#include "availabilityIndex.h"
+#include "bulkExport.h"
+#include "departmentRecommender.h"
 #include "expertDialog.h"
+#include "integrityChecker.h"
 #include "patientDialog.h"
+#include "retentionManager.h"
 #include "ui_mainwindow.h"
 
 MainWindow::MainWindow(QWidget* parent)
@@ -24,10 +33,18 @@ MainWindow::MainWindow(QWidget* parent)
       ui(new Ui::MainWindow),
       expertManager(nullptr),
       appointmentManager(nullptr),
+      availabilityIndex(nullptr),
+      appointmentArchive(nullptr),
+      retentionManager(nullptr),
+      aiNetworkManager(nullptr),
+      aiResponseCache(nullptr),
+      departmentRecommender(nullptr),
       adminPassword(loadAdminPassword()) {  
   ui->setupUi(this);
   setupManagers();
   autoImportData();
+  runStartupIntegrityCheck();
+  retentionManager->start();
   setupUI();
 
   connect(qApp, &QApplication::aboutToQuit, this,
@@ -40,6 +57,9 @@ MainWindow::MainWindow(QWidget* parent)
 
 MainWindow::~MainWindow() {
   delete ui;
+  delete retentionManager;  // 先等待后台归档结束
+  delete appointmentArchive;
+  delete aiResponseCache;
   delete expertManager;
   delete appointmentManager;
 }
@@ -48,6 +68,44 @@ void MainWindow::setupManagers() {
   expertManager = new ExpertManager();
   appointmentManager = new AppointmentManager();
   // appointmentManager->initializeDefaultData();
+
+  // 余号索引的滚动窗口天数可通过配置调整（默认60天）
+  QSettings settings("HospitalApp", "AppointmentSystem");
+  int horizonDays = settings.value("availabilityHorizonDays", 60).toInt();
+  availabilityIndex = new AvailabilityIndex(expertManager, appointmentManager,
+                                            horizonDays, this);
+
+  // 超过保留天数的预约在后台移入归档（默认 0，不归档）。已归档的预约只在
+  // 就诊记录中可见，导出、关键字查询与完整性检查都不包含，界面上会提示
+  appointmentArchive = new AppointmentArchive();
+  appointmentArchive->open("resource/archive");
+  appointmentManager->setArchive(appointmentArchive);
+  int retentionDays = settings.value("retentionDays", 0).toInt();
+  retentionManager = new RetentionManager(
+      appointmentManager, appointmentArchive, retentionDays, this);
+  connect(retentionManager, &RetentionManager::monthArchived, this,
+          [this](const QString&, int) { saveData(); });
+
+  // AI 助手共用一个网络管理器，关闭再打开对话框时复用已建立的连接
+  aiNetworkManager = new QNetworkAccessManager(this);
+  // 重复问题的回答缓存（默认200条，有效期10分钟）
+  aiResponseCache = new AIResponseCache(
+      "resource/aiResponseCache.json",
+      settings.value("aiCacheEntries", 200).toInt(),
+      settings.value("aiCacheTtlMinutes", 10).toInt());
+
+  // 按历史预约（含未载入分区与归档）的症状描述推荐科室与专家（本地
+  // 索引，随新预约增量更新）
+  departmentRecommender = new DepartmentRecommender(
+      appointmentManager, appointmentArchive, this);
+}
+
+AppointmentArchive* MainWindow::getArchive() const {
+  return appointmentArchive;
+}
+
+AvailabilityIndex* MainWindow::getAvailabilityIndex() const {
+  return availabilityIndex;
 }
 
 void MainWindow::setupUI() {
@@ -155,13 +213,14 @@ bool MainWindow::validateInput(const QString& input, const QString& fieldName,
 }
 
 void MainWindow::openPatientDialog() {
-  PatientDialog dialog(expertManager, appointmentManager, this);
+  PatientDialog dialog(expertManager, appointmentManager,
+                       departmentRecommender, this);
   dialog.setModal(true);
   dialog.exec();
 }
 
 void MainWindow::openExpertDialog(Expert* expert) {
-  ExpertDialog dialog(expert, appointmentManager, this);
+  ExpertDialog dialog(expert, appointmentManager, appointmentArchive, this);
   dialog.exec();
 }
 
@@ -283,21 +342,45 @@ void MainWindow::importData() {
     return;
   }
 
-  int result = QMessageBox::question(
-      this, "导入确认", "导入数据将覆盖当前所有数据，确定要继续吗？",
-      QMessageBox::Yes | QMessageBox::No);
-
-  if (result != QMessageBox::Yes) {
+  // 选择导入方式：合并保留现有数据，覆盖则整体替换
+  QMessageBox modeBox(QMessageBox::Question, "导入方式",
+                      "合并导入：按专家编号/预约信息新增或更新，保留现有数据\n"
+                      "覆盖导入：用文件内容替换当前所有数据",
+                      QMessageBox::Cancel, this);
+  QPushButton* mergeBtn =
+      modeBox.addButton("合并导入", QMessageBox::AcceptRole);
+  QPushButton* replaceBtn =
+      modeBox.addButton("覆盖导入", QMessageBox::DestructiveRole);
+  modeBox.exec();
+  bool merge = modeBox.clickedButton() == mergeBtn;
+  if (!merge && modeBox.clickedButton() != replaceBtn) {
     return;
   }
 
+  if (!merge) {
+    int result = QMessageBox::question(
+        this, "导入确认", "导入数据将覆盖当前所有数据，确定要继续吗？",
+        QMessageBox::Yes | QMessageBox::No);
+
+    if (result != QMessageBox::Yes) {
+      return;
+    }
+  }
+
   QString defaultDir = QDir::homePath();
   QString expertFilename = QFileDialog::getOpenFileName(
       this, "导入专家数据", defaultDir, "JSON文件 (*.json);;所有文件 (*)");
 
   if (!expertFilename.isEmpty()) {
-    if (expertManager->loadFromFile(expertFilename)) {
-      QMessageBox::information(this, "成功", "专家数据导入成功！");
+    MergeSummary summary;
+    bool imported =
+        merge ? expertManager->mergeFromFile(expertFilename, &summary)
+              : expertManager->loadFromFile(expertFilename);
+    if (imported) {
+      QMessageBox::information(
+          this, "成功",
+          merge ? "专家数据合并完成！\n" + summary.toText()
+                : QString("专家数据导入成功！"));
     } else {
       QMessageBox::warning(this, "失败", "专家数据导入失败！");
     }
@@ -307,8 +390,16 @@ void MainWindow::importData() {
       this, "导入预约数据", defaultDir, "JSON文件 (*.json);;所有文件 (*)");
 
   if (!appointmentFilename.isEmpty()) {
-    if (appointmentManager->loadFromFile(appointmentFilename)) {
-      QMessageBox::information(this, "成功", "预约数据导入成功！");
+    MergeSummary summary;
+    bool imported =
+        merge ? appointmentManager->mergeFromFile(appointmentFilename,
+                                                  expertManager, &summary)
+              : appointmentManager->loadFromFile(appointmentFilename);
+    if (imported) {
+      QMessageBox::information(
+          this, "成功",
+          merge ? "预约数据合并完成！\n" + summary.toText()
+                : QString("预约数据导入成功！"));
     } else {
       QMessageBox::warning(this, "失败", "预约数据导入失败！");
     }
@@ -342,11 +433,24 @@ void MainWindow::exportData() {
 
   QString appointmentFilename = QFileDialog::getSaveFileName(
       this, "导出预约数据", defaultDir + "/appointments.json",
-      "JSON文件 (*.json);;所有文件 (*)");
+      "JSON文件 (*.json);;CSV文件 (*.csv);;NDJSON文件 (*.ndjson);;"
+      "压缩CSV (*.csv.qz);;压缩NDJSON (*.ndjson.qz);;所有文件 (*)");
 
   if (!appointmentFilename.isEmpty()) {
-    if (appointmentManager->saveToFile(appointmentFilename)) {
-      QMessageBox::information(this, "成功", "预约数据导出成功！");
+    // 流式导出，格式与压缩由扩展名决定；导出包含全部历史，尚未载入的
+    // 历史分区直接从磁盘读出，不载入内存
+    BulkExporter exporter(appointmentManager);
+    int count = 0;
+    QString error;
+    bool exported = exporter.exportToFile(
+        appointmentFilename, ExportOptions::fromFilename(appointmentFilename),
+        &count, &error);
+    if (exported) {
+      QString note = appointmentArchive->exclusionNote();
+      QMessageBox::information(
+          this, "成功",
+          note.isEmpty() ? QString("预约数据导出成功！")
+                         : "预约数据导出成功！\n" + note);
     } else {
       QMessageBox::warning(this, "失败", "预约数据导出失败！");
     }
@@ -354,7 +458,10 @@ void MainWindow::exportData() {
 }
 
 void MainWindow::openAIChat() {
-  AIChatDialog* dlg = new AIChatDialog(expertManager, appointmentManager, this);
+  AIChatDialog* dlg =
+      new AIChatDialog(expertManager, appointmentManager, aiNetworkManager,
+                       aiResponseCache, departmentRecommender,
+                       availabilityIndex, this);
   dlg->setAttribute(Qt::WA_DeleteOnClose);
   dlg->show();
 }
@@ -362,6 +469,7 @@ void MainWindow::openAIChat() {
 void MainWindow::autoImportData() {
   const QString expertsFilePath = "resource/experts.json";
   const QString appointmentsFilePath = "resource/appointments.json";
+  const QString appointmentsPartitionDir = "resource/appointments";
 
   // 加载专家数据
   QFile expertsFile(expertsFilePath);
@@ -396,13 +504,27 @@ void MainWindow::autoImportData() {
     }
   }
 
-  // 加载预约数据
+  // 加载预约数据：优先读取按月分区目录，只立即载入当月及以后的分区，
+  // 历史分区在查询需要时再载入
+  QDate today = QDate::currentDate();
+  if (appointmentManager->loadPartitions(
+          appointmentsPartitionDir, QDate(today.year(), today.month(), 1))) {
+    qDebug() << "预约数据从分区目录加载成功：" << appointmentsPartitionDir;
+    return;
+  }
+
+  // 尚未分区：读取单文件后立即迁移为分区存储
   QFile appointmentsFile(appointmentsFilePath);
   if (appointmentsFile.exists() &&
       appointmentsFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
     // 如果文件存在且可以打开，直接加载
     if (appointmentManager->loadFromFile(appointmentsFilePath)) {
       qDebug() << "预约数据从文件加载成功：" << appointmentsFilePath;
+      appointmentsFile.close();
+      if (appointmentManager->savePartitions(appointmentsPartitionDir)) {
+        QFile::rename(appointmentsFilePath, appointmentsFilePath + ".migrated");
+        qDebug() << "预约数据已迁移到分区目录：" << appointmentsPartitionDir;
+      }
     } else {
       qDebug() << "预约数据从文件加载失败：" << appointmentsFilePath;
       // 尝试从资源文件加载
@@ -421,8 +543,8 @@ void MainWindow::autoImportData() {
       if (!dir.exists("resource")) {
         dir.mkpath("resource");
       }
-      if (appointmentManager->saveToFile(appointmentsFilePath)) {
-        qDebug() << "预约数据已保存到文件：" << appointmentsFilePath;
+      if (appointmentManager->savePartitions(appointmentsPartitionDir)) {
+        qDebug() << "预约数据已保存到分区目录：" << appointmentsPartitionDir;
       }
     } else {
       qDebug() << "预约数据从资源文件加载失败";
@@ -430,9 +552,40 @@ void MainWindow::autoImportData() {
   }
 }
 
-void MainWindow::onApplicationAboutToQuit() {
+// 启动时的数据完整性检查：命令行参数 --check-integrity 或配置项
+// checkIntegrityOnStartup 开启，--repair-integrity 同时自动修复
+void MainWindow::runStartupIntegrityCheck() {
+  QStringList arguments = QCoreApplication::arguments();
+  bool repair = arguments.contains("--repair-integrity");
+  QSettings settings("HospitalApp", "AppointmentSystem");
+  if (!repair && !arguments.contains("--check-integrity") &&
+      !settings.value("checkIntegrityOnStartup", false).toBool()) {
+    return;
+  }
+
+  const QString reportFilePath = "resource/integrity_report.json";
+  IntegrityChecker checker(expertManager, appointmentManager);
+  IntegrityReport report = checker.check();
+  report.saveToFile(reportFilePath);
+  qDebug().noquote() << report.summaryText();
+  if (report.isClean()) return;
+
+  QString message = report.summaryText();
+  QString note = appointmentArchive->exclusionNote();
+  if (!note.isEmpty()) message += "\n" + note;
+  if (repair) {
+    int repaired = checker.repair(report);
+    if (repaired > 0) saveData();
+    message += QString("\n已自动修复 %1 条预约。").arg(repaired);
+  }
+  QMessageBox::warning(this, "数据完整性检查",
+                       message + "\n详细报告：" + reportFilePath);
+}
+
+bool MainWindow::saveData() {
   const QString expertsFilePath = "resource/experts.json";
-  const QString appointmentsFilePath = "resource/appointments.json";
+  const QString appointmentsPartitionDir = "resource/appointments";
+  bool success = true;
 
   // 确保目录存在
   QDir dir;
@@ -446,19 +599,29 @@ void MainWindow::onApplicationAboutToQuit() {
       qDebug() << "专家数据成功保存到：" << expertsFilePath;
     } else {
       qDebug() << "专家数据保存失败：" << expertsFilePath;
+      success = false;
     }
   }
 
   // 保存预约数据
   if (appointmentManager) {
-    if (appointmentManager->saveToFile(appointmentsFilePath)) {
-      qDebug() << "预约数据成功保存到：" << appointmentsFilePath;
+    if (appointmentManager->savePartitions(appointmentsPartitionDir)) {
+      qDebug() << "预约数据成功保存到：" << appointmentsPartitionDir;
     } else {
-      qDebug() << "预约数据保存失败：" << appointmentsFilePath;
+      qDebug() << "预约数据保存失败：" << appointmentsPartitionDir;
+      success = false;
     }
   }
+  return success;
+}
+
+void MainWindow::onApplicationAboutToQuit() {
+  const QString expertsFilePath = "resource/experts.json";
+  const QString appointmentsPartitionDir = "resource/appointments";
+
+  saveData();
   qDebug() << "保存时 QDir::currentPath() =" << QDir::currentPath();
   qDebug() << "将尝试保存到：" << QFileInfo(expertsFilePath).absoluteFilePath();
   qDebug() << "将尝试保存到："
-           << QFileInfo(appointmentsFilePath).absoluteFilePath();
+           << QFileInfo(appointmentsPartitionDir).absoluteFilePath();
 }
@@ -16,6 +16,12 @@ class Expert;
 class ExpertManager;
 class AppointmentManager;
 class AIChatDialog;
+class AvailabilityIndex;
+class AppointmentArchive;
+class RetentionManager;
+class QNetworkAccessManager;
+class AIResponseCache;
+class DepartmentRecommender;
 
 class MainWindow : public QMainWindow {
   Q_OBJECT
@@ -29,6 +35,15 @@ class MainWindow : public QMainWindow {
   bool changeAdminPassword(const QString& oldPassword,
                            const QString& newPassword);
 
+  // 专家余号位图索引（供管理员/分诊查询某日仍有余号的专家）
+  AvailabilityIndex* getAvailabilityIndex() const;
+
+  // 历史预约归档（超过保留期的预约由 RetentionManager 移入）
+  AppointmentArchive* getArchive() const;
+
+  // 将专家与预约数据写回 resource 目录（批量操作完成后统一落盘）
+  bool saveData();
+
  private slots:
   // UI 事件槽（由 UI 元件触发）
   void on_roleComboBox_currentIndexChanged(int index);
@@ -54,11 +69,18 @@ class MainWindow : public QMainWindow {
   ExpertManager* expertManager;  // 专家数据管理器（负责读写/查询专家数据）
   AppointmentManager*
       appointmentManager;     // 预约数据管理器（负责读写/查询预约数据）
+  AvailabilityIndex* availabilityIndex;  // 日期 × 专家 余号位图索引
+  AppointmentArchive* appointmentArchive;  // 历史预约归档（按月压缩段）
+  RetentionManager* retentionManager;      // 后台归档超过保留期的预约
+  QNetworkAccessManager* aiNetworkManager;  // AI 助手共享的网络连接
+  AIResponseCache* aiResponseCache;         // AI 回答缓存（保存到文件）
+  DepartmentRecommender* departmentRecommender;  // 症状 -> 科室推荐
   QString adminPassword;      // 管理员密码（程序启动时加载）
   bool isDialogOpen = false;  // 防止重复打开对话框的标志
 
   // 数据与界面相关的私有方法
   void autoImportData();     // 启动时自动导入数据（资源或项目文件）
+  void runStartupIntegrityCheck();  // 启动时按开关检查数据完整性
   void setupUI();            // 初始化界面元素
   void setupManagers();      // 创建并初始化 manager（expert/appointment）
   void setupRoleComboBox();  // 填充角色选择下拉框
@@ -3,18 +3,21 @@
 #include <QDate>
 #include <QDebug>
 #include <QMessageBox>
-#include <QRegularExpression>
 
 #include "appointmentManager.h"
+#include "inputValidator.h"
 #include "ui_PatientDialog.h"
 
 PatientDialog::PatientDialog(ExpertManager* expertMgr,
                              AppointmentManager* appointmentMgr,
+                             DepartmentRecommender* recommender,
                              QWidget* parent)
     : QDialog(parent),
       ui(new Ui::PatientDialog),
       expertManager(expertMgr),
-      appointmentManager(appointmentMgr) {
+      appointmentManager(appointmentMgr),
+      availabilityCalendar(appointmentMgr, 60),
+      departmentRecommender(recommender) {
   ui->setupUi(this);
 
   // 设置日期范围（今天到未来60天）
@@ -51,6 +54,18 @@ PatientDialog::PatientDialog(ExpertManager* expertMgr,
           &PatientDialog::on_idInput_textChanged);
   connect(ui->phoneInput, &QLineEdit::textChanged, this,
           &PatientDialog::on_phoneInput_textChanged);
+
+  // 输入症状时按历史预约推荐科室（停止输入 300ms 后）
+  recommendTimer.setSingleShot(true);
+  recommendTimer.setInterval(300);
+  connect(&recommendTimer, &QTimer::timeout, this,
+          &PatientDialog::updateRecommendation);
+  connect(ui->symptomsText, &QTextEdit::textChanged, this,
+          [this]() { recommendTimer.start(); });
+  if (!departmentRecommender) {
+    ui->recommendLabel->hide();
+    ui->applyRecommendButton->hide();
+  }
 }
 
 PatientDialog::~PatientDialog() { delete ui; }
@@ -61,7 +76,7 @@ void PatientDialog::on_idInput_textChanged() {
 
   // 实时验证身份证格式
   if (idNumber.length() == 18) {
-    if (isValidIdNumber(idNumber)) {
+    if (InputValidator::isValidIdNumber(idNumber)) {
       // 身份证有效，自动填充年龄和性别
       updateAgeAndGender(idNumber);
       ui->idInput->setStyleSheet("");  // 清除错误样式
@@ -89,7 +104,7 @@ void PatientDialog::on_phoneInput_textChanged() {
   QString phone = ui->phoneInput->text().trimmed();
 
   if (!phone.isEmpty()) {
-    if (isValidPhoneNumber(phone)) {
+    if (InputValidator::isValidPhoneNumber(phone)) {
       ui->phoneInput->setStyleSheet("");  // 清除错误样式
     } else {
       ui->phoneInput->setStyleSheet("QLineEdit { border: 2px solid red; }");
@@ -99,98 +114,10 @@ void PatientDialog::on_phoneInput_textChanged() {
   }
 }
 
-// 验证身份证号是否合法
-bool PatientDialog::isValidIdNumber(const QString& idNumber) {
-  if (idNumber.length() != 18) {
-    return false;
-  }
-
-  // 检查前17位是否为数字
-  QRegularExpression re("^\\d{17}[\\dXx]$");
-  if (!re.match(idNumber).hasMatch()) {
-    return false;
-  }
-
-  // 验证出生日期
-  QString birthDate = idNumber.mid(6, 8);
-  QDate birth = QDate::fromString(birthDate, "yyyyMMdd");
-  if (!birth.isValid()) {
-    return false;
-  }
-
-  // 验证年龄合理性（0-150岁）
-  QDate today = QDate::currentDate();
-  int age = birth.daysTo(today) / 365;
-  if (age < 0 || age > 150) {
-    return false;
-  }
-
-  // 验证校验码
-  const int weights[] = {7, 9, 10, 5, 8, 4, 2, 1, 6, 3, 7, 9, 10, 5, 8, 4, 2};
-  const char checkCodes[] = {'1', '0', 'X', '9', '8', '7',
-                             '6', '5', '4', '3', '2'};
-
-  int sum = 0;
-  for (int i = 0; i < 17; ++i) {
-    sum += idNumber[i].digitValue() * weights[i];
-  }
-
-  char expectedCheck = checkCodes[sum % 11];
-  char actualCheck = idNumber[17].toUpper().toLatin1();
-
-  return expectedCheck == actualCheck;
-}
-
-// 验证电话号码是否合法
-bool PatientDialog::isValidPhoneNumber(const QString& phone) {
-  // 手机号码：1开头，11位数字
-  QRegularExpression mobileRe("^1[3-9]\\d{9}$");
-
-  // 固定电话：区号+号码，支持多种格式
-  QRegularExpression landlineRe("^0\\d{2,3}-?\\d{7,8}$");
-
-  // 400电话等特殊号码
-  QRegularExpression specialRe("^400-?\\d{7}$");
-
-  return mobileRe.match(phone).hasMatch() ||
-         landlineRe.match(phone).hasMatch() ||
-         specialRe.match(phone).hasMatch();
-}
-
-// 从身份证号获取性别
-QString PatientDialog::getGenderFromId(const QString& idNumber) {
-  if (idNumber.length() != 18) {
-    return "";
-  }
-  QChar genderChar = idNumber.at(16);
-  int genderCode = genderChar.digitValue();
-  bool isMale = (genderCode % 2 == 1);
-  return isMale ? "男" : "女";
-}
-
-// 从身份证号获取年龄
-int PatientDialog::getAgeFromId(const QString& idNumber) {
-  if (idNumber.length() != 18) {
-    return 0;
-  }
-
-  QString birthDate = idNumber.mid(6, 8);
-  QDate birth = QDate::fromString(birthDate, "yyyyMMdd");
-
-  if (!birth.isValid()) {
-    return 0;
-  }
-
-  QDate today = QDate::currentDate();
-  int age = birth.daysTo(today) / 365;
-
-  return age;
-}
-
 // 更新年龄和性别
 void PatientDialog::updateAgeAndGender(const QString& idNumber) {
-  QString gender = getGenderFromId(idNumber);
-  int age = getAgeFromId(idNumber);
+  QString gender = InputValidator::genderFromIdNumber(idNumber);
+  int age = InputValidator::ageFromIdNumber(idNumber);
 
   ui->genderInput->setText(gender);  // 使用输入框显示性别
   ui->ageSpinBox->setValue(age);
@@ -216,18 +143,8 @@ void PatientDialog::loadExpertsByDepartment(const QString& department) {
 
   for (const auto& expert : expertManager->experts) {
     if (expert.subject == department) {
-      // 检查专家是否有可用预约日期
-      bool hasAvailableDates = false;
-      QDate currentDate = QDate::currentDate();
-
-      // 检查未来60天
-      for (int i = 0; i < 60; i++) {
-        QDate date = currentDate.addDays(i);
-        if (expert.isAvailableOnDate(date)) {
-          hasAvailableDates = true;
-          break;
-        }
-      }
+      // 检查专家未来60天是否有未约满的出诊日（读取日历缓存）
+      bool hasAvailableDates = availabilityCalendar.hasBookableDate(expert);
 
       // 只添加有可用日期的专家，并显示职称
       if (hasAvailableDates) {
@@ -273,86 +190,41 @@ void PatientDialog::updateAvailableDates() {
   // 禁用所有日期的事件处理器
   ui->appointmentDateEdit->disconnect();
 
-  // 更新日期选择控件
-  QDate today = QDate::currentDate();
-
-  // 创建自定义日历模型
+  // 按日历缓存批量设置日期格式
   QCalendarWidget* calendar = ui->appointmentDateEdit->calendarWidget();
   if (calendar) {
-    // 清除所有日期格式
-    calendar->setDateTextFormat(QDate(), QTextCharFormat());
-
-    // 设置特殊出诊日期格式（浅绿色背景，深绿色文字）
-    QTextCharFormat specialScheduleFormat;
-    specialScheduleFormat.setBackground(QColor(144, 238, 144));  // 浅绿色背景
-    specialScheduleFormat.setForeground(QColor(0, 100, 0));  // 深绿色文字
-
-    // 设置特殊停诊日期格式（浅红色背景，深红色文字）
-    QTextCharFormat closedFormat;
-    closedFormat.setBackground(QColor(255, 182, 193));  // 浅红色背景
-    closedFormat.setForeground(QColor(139, 0, 0));      // 深红色文字
-
-    // 设置常规出诊日期格式（浅蓝色背景）
-    QTextCharFormat regularFormat;
-    regularFormat.setBackground(QColor(173, 216, 230));  // 浅蓝色背景
-
-    // 设置不可用日期格式（灰色）
-    QTextCharFormat unavailableFormat;
-    unavailableFormat.setForeground(QColor(180, 180, 180));  // 灰色
-
-    // 检查未来60天
-    for (int i = 0; i < 60; i++) {
-      QDate date = today.addDays(i);
-
-      if (selectedExpert->scheduleDates.contains(date)) {
-        // 特殊出诊日
-        calendar->setDateTextFormat(date, specialScheduleFormat);
-      } else if (selectedExpert->closedDates.contains(date)) {
-        // 特殊停诊日
-        calendar->setDateTextFormat(date, closedFormat);
-      } else {
-        // 检查是否为常规出诊日
-        QString dayOfWeek = Expert::getDayOfWeekString(date);
-        bool isRegularScheduled = false;
-
-        for (const QString& timeSlot : selectedExpert->serviceTimes) {
-          if (timeSlot.startsWith(dayOfWeek)) {
-            isRegularScheduled = true;
-            break;
-          }
-        }
-
-        if (isRegularScheduled) {
-          // 常规出诊日
-          calendar->setDateTextFormat(date, regularFormat);
-        } else {
-          // 不可用日期
-          calendar->setDateTextFormat(date, unavailableFormat);
-        }
-      }
-    }
+    QVector<QTextCharFormat> formats(AvailabilityCalendar::DayStateCount);
+
+    // 特殊出诊日期格式（浅绿色背景，深绿色文字）
+    formats[AvailabilityCalendar::Special].setBackground(QColor(144, 238, 144));
+    formats[AvailabilityCalendar::Special].setForeground(QColor(0, 100, 0));
+
+    // 特殊停诊日期格式（浅红色背景，深红色文字）
+    formats[AvailabilityCalendar::Closed].setBackground(QColor(255, 182, 193));
+    formats[AvailabilityCalendar::Closed].setForeground(QColor(139, 0, 0));
+
+    // 常规出诊日期格式（浅蓝色背景）
+    formats[AvailabilityCalendar::Regular].setBackground(QColor(173, 216, 230));
+
+    // 已约满日期格式（浅橙色背景，深橙色文字）
+    formats[AvailabilityCalendar::Full].setBackground(QColor(255, 218, 170));
+    formats[AvailabilityCalendar::Full].setForeground(QColor(170, 85, 0));
+
+    // 不可用日期格式（灰色）
+    formats[AvailabilityCalendar::Unavailable].setForeground(
+        QColor(180, 180, 180));
+
+    availabilityCalendar.render(calendar, *selectedExpert, formats);
   }
 
-  // 如果当前选择的日期在有效范围内且专家可预约，则保持选择
-  if (currentSelectedDate >= today &&
-      currentSelectedDate <= today.addDays(60) &&
-      selectedExpert->isAvailableOnDate(currentSelectedDate)) {
+  // 如果当前选择的日期在有效范围内且专家可预约（出诊且未约满），则保持选择
+  if (availabilityCalendar.isBookable(*selectedExpert, currentSelectedDate)) {
     ui->appointmentDateEdit->setDate(currentSelectedDate);
   } else {
-    // 否则，找到第一个可用日期
-    QDate firstAvailableDate = today;
-    bool foundAvailable = false;
-
-    for (int i = 0; i < 60; i++) {
-      QDate date = today.addDays(i);
-      if (selectedExpert->isAvailableOnDate(date)) {
-        firstAvailableDate = date;
-        foundAvailable = true;
-        break;
-      }
-    }
-
-    if (foundAvailable) {
+    // 否则，找到第一个未约满的出诊日
+    QDate firstAvailableDate =
+        availabilityCalendar.firstBookableDate(*selectedExpert);
+    if (firstAvailableDate.isValid()) {
       ui->appointmentDateEdit->setDate(firstAvailableDate);
     }
   }
@@ -422,13 +294,8 @@ void PatientDialog::loadServiceTimesByDate(const QString& expertName,
 
     if (isMatchingSlot) {
       // 统计该时间段的当前预约数
-      int count = 0;
-      for (const Appointment& a : appointmentManager->getAllAppointments()) {
-        if (a.expertName == expertName && a.serviceTime == timeSlot &&
-            a.appointmentDate == date) {
-          ++count;
-        }
-      }
+      int count =
+          appointmentManager->getSlotOccupancy(expertName, date, timeSlot);
 
       int capacity = selectedExpert->getTimeSlotCapacity(timeSlot);
       if (count < capacity) {
@@ -452,6 +319,53 @@ void PatientDialog::on_departmentCombo_currentIndexChanged(int index) {
   }
 }
 
+// 按症状描述刷新推荐科室（本地索引，不访问网络）
+void PatientDialog::updateRecommendation() {
+  if (!departmentRecommender) return;
+
+  recommendedDepartment.clear();
+  recommendedExpert.clear();
+  QString symptoms = ui->symptomsText->toPlainText().trimmed();
+  QList<Recommendation> departments;
+  if (!symptoms.isEmpty()) {
+    departments = departmentRecommender->recommendDepartments(symptoms);
+  }
+  if (departments.isEmpty()) {
+    ui->recommendLabel->clear();
+    ui->applyRecommendButton->setEnabled(false);
+    return;
+  }
+
+  QStringList parts;
+  for (const Recommendation& department : departments) {
+    parts.append(QString("%1（%2%）")
+                     .arg(department.name)
+                     .arg(qRound(department.share * 100)));
+  }
+  QString text = "推荐科室：" + parts.join("、");
+
+  recommendedDepartment = departments.first().name;
+  QList<Recommendation> experts = departmentRecommender->recommendExperts(
+      symptoms, recommendedDepartment, 1);
+  if (!experts.isEmpty()) {
+    recommendedExpert = experts.first().name;
+    text += QString("；推荐专家：%1").arg(recommendedExpert);
+  }
+  ui->recommendLabel->setText(text);
+  ui->applyRecommendButton->setEnabled(
+      ui->departmentCombo->findText(recommendedDepartment) >= 0);
+}
+
+// 选中推荐的科室，专家可预约时一并选中
+void PatientDialog::on_applyRecommendButton_clicked() {
+  int departmentIndex = ui->departmentCombo->findText(recommendedDepartment);
+  if (departmentIndex < 0) return;
+  ui->departmentCombo->setCurrentIndex(departmentIndex);
+
+  int expertIndex = ui->expertCombo->findData(recommendedExpert);
+  if (expertIndex >= 0) ui->expertCombo->setCurrentIndex(expertIndex);
+}
+
 // 修改提交按钮处理逻辑，增加日期处理
 void PatientDialog::on_submitButton_clicked() {
   // 验证身份证
@@ -461,7 +375,7 @@ void PatientDialog::on_submitButton_clicked() {
     return;
   }
 
-  if (!isValidIdNumber(idNumber)) {
+  if (!InputValidator::isValidIdNumber(idNumber)) {
     QMessageBox::warning(this, "提示", "请输入有效的身份证号！");
     ui->idInput->setFocus();
     return;
@@ -474,7 +388,7 @@ void PatientDialog::on_submitButton_clicked() {
     return;
   }
 
-  if (!isValidPhoneNumber(phone)) {
+  if (!InputValidator::isValidPhoneNumber(phone)) {
     QMessageBox::warning(
         this, "提示",
         "请输入有效的电话号码！\n支持格式：\n• 手机号：13812345678\n• "
@@ -483,17 +397,6 @@ void PatientDialog::on_submitButton_clicked() {
     return;
   }
 
-  if (appointmentManager) {
-    for (const Appointment& a : appointmentManager->getAllAppointments()) {
-      if (a.idNumber == idNumber) {
-        QMessageBox::warning(this, "提示",
-                              "该身份证号已有预约记录，不能重复预约！");
-        return;
-        
-      }
-    }
-  }
-
   // 收集输入内容
   Appointment appointment;
   appointment.patientName = ui->nameInput->text().trimmed();
@@ -530,56 +433,20 @@ void PatientDialog::on_submitButton_clicked() {
     return;
   }
 
-  // 查找专家对象
-  Expert* selectedExpert = nullptr;
-  for (auto& expert : expertManager->experts) {
-    if (expert.name == appointment.expertName) {
-      selectedExpert = &expert;
-      break;
-    }
-  }
-
-  if (!selectedExpert) {
-    QMessageBox::warning(this, "错误", "找不到选择的专家信息！");
-    return;
-  }
-
-  // 验证专家在该日期是否出诊
-  if (!selectedExpert->isAvailableOnDate(appointment.appointmentDate)) {
-    QMessageBox::warning(
-        this, "错误",
-        QString("专家 %1 在 %2 没有出诊安排！")
-            .arg(appointment.expertName)
-            .arg(appointment.appointmentDate.toString("yyyy年MM月dd日")));
-    return;
-  }
-
-  // 统计该专家该日期该时间段已有预约人数
-  int count = 0;
-  for (const Appointment& a : appointmentManager->getAllAppointments()) {
-    if (a.expertName == appointment.expertName &&
-        a.serviceTime == appointment.serviceTime &&
-        a.appointmentDate == appointment.appointmentDate) {
-      ++count;
-    }
-  }
-
-  // 使用专家设置的容量
-  int maxCapacity =
-      selectedExpert->getTimeSlotCapacity(appointment.serviceTime);
-  if (count >= maxCapacity) {
-    QMessageBox::warning(this, "提示",
-                         QString("该时间段预约已满！\n当前预约：%"
-                                 "1人\n最大容量：%2人\n请选择其他时间段！")
-                             .arg(count)
-                             .arg(maxCapacity));
+  if (!appointmentManager) {
+    QMessageBox::warning(this, "错误", "预约管理器未初始化！");
     return;
   }
 
-  appointment.queueNumber = count + 1;
-
-  if (appointmentManager) {
-    if (appointmentManager->addAppointment(appointment)) {
+  // 排队号、身份证号唯一、出诊与容量均由批量接口统一分配与校验
+  QList<Appointment> added;
+  AppointmentManager::AddStatus status =
+      appointmentManager->addAppointments({appointment}, expertManager,
+                                          &added)
+          .first();
+  switch (status) {
+    case AppointmentManager::Added:
+      appointment.queueNumber = added.first().queueNumber;
       QMessageBox::information(
           this, "成功",
           QString(
@@ -590,11 +457,34 @@ void PatientDialog::on_submitButton_clicked() {
               .arg(appointment.serviceTime)
               .arg(appointment.queueNumber));
       on_cancelButton_clicked();
-    } else {
-      QMessageBox::warning(this, "失败", "预约失败，请稍后重试！");
+      break;
+    case AppointmentManager::DuplicateIdNumber:
+      QMessageBox::warning(this, "提示",
+                           "该身份证号已有预约记录，不能重复预约！");
+      break;
+    case AppointmentManager::ExpertNotFound:
+      QMessageBox::warning(this, "错误", "找不到选择的专家信息！");
+      break;
+    case AppointmentManager::ExpertUnavailable:
+      QMessageBox::warning(
+          this, "错误",
+          QString("专家 %1 在 %2 没有出诊安排！")
+              .arg(appointment.expertName)
+              .arg(appointment.appointmentDate.toString("yyyy年MM月dd日")));
+      break;
+    case AppointmentManager::SlotFull: {
+      Expert* expert = expertManager->findExpertByName(appointment.expertName);
+      QMessageBox::warning(
+          this, "提示",
+          QString("该时间段预约已满！\n当前预约：%1人\n最大容量：%2人\n"
+                  "请选择其他时间段！")
+              .arg(appointmentManager->getSlotOccupancy(
+                  appointment.expertName, appointment.appointmentDate,
+                  appointment.serviceTime))
+              .arg(expert ? expert->getTimeSlotCapacity(appointment.serviceTime)
+                          : 0));
+      break;
     }
-  } else {
-    QMessageBox::warning(this, "错误", "预约管理器未初始化！");
   }
 }
 
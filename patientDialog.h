@@ -3,8 +3,11 @@
 
 #include <QDialog> 
 #include <QCalendarWidget>
+#include <QTimer>
 
 #include "appointmentManager.h"
+#include "availabilityCalendar.h"
+#include "departmentRecommender.h"
 #include "expertManager.h"
 
 QT_BEGIN_NAMESPACE
@@ -17,8 +20,10 @@ class PatientDialog : public QDialog {
   Q_OBJECT
 
  public:
+  // recommender 可为空（不显示科室推荐）
   explicit PatientDialog(ExpertManager* expertMgr,
                          AppointmentManager* appointmentMgr,
+                         DepartmentRecommender* recommender = nullptr,
                          QWidget* parent = nullptr);
   ~PatientDialog();
 
@@ -30,16 +35,19 @@ class PatientDialog : public QDialog {
   void on_phoneInput_textChanged();
   void on_expertCombo_currentIndexChanged(int index);
   void on_appointmentDateEdit_dateChanged(const QDate& date);
+  void on_applyRecommendButton_clicked();  // 选中推荐的科室与专家
+  void updateRecommendation();             // 按症状描述刷新推荐
 
  public:
   Ui::PatientDialog* ui;
   ExpertManager* expertManager;
   AppointmentManager* appointmentManager;
+  AvailabilityCalendar availabilityCalendar;  // 专家出诊日历缓存
+  DepartmentRecommender* departmentRecommender;
+  QString recommendedDepartment;  // 当前推荐的首选科室
+  QString recommendedExpert;      // 首选科室中最匹配的专家
+  QTimer recommendTimer;  // 症状输入停顿后再刷新推荐，连续输入时只算一次
 
-  bool isValidIdNumber(const QString& idNumber);
-  bool isValidPhoneNumber(const QString& phone);
-  QString getGenderFromId(const QString& idNumber);
-  int getAgeFromId(const QString& idNumber);
   void updateAgeAndGender(const QString& idNumber);
   void loadDepartments();
   void loadExperts(const QString& department);
@@ -0,0 +1,139 @@
+#include "retentionManager.h"
+
+#include <QApplication>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QtConcurrent>
+
+static const int kStepIntervalMs = 1000;          // 两个月之间的间隔
+static const int kIdleIntervalMs = 3600 * 1000;   // 无可归档数据时的复查间隔
+
+RetentionManager::RetentionManager(AppointmentManager* appointmentMgr,
+                                   AppointmentArchive* archive,
+                                   int retentionDays, QObject* parent)
+    : QObject(parent),
+      appointmentManager(appointmentMgr),
+      archive(archive),
+      retentionDays(retentionDays),
+      pendingGeneration(0),
+      segmentReady(false) {
+  timer.setSingleShot(true);
+  connect(&timer, &QTimer::timeout, this, &RetentionManager::step);
+  connect(&watcher, &QFutureWatcher<bool>::finished, this,
+          &RetentionManager::onSegmentWritten);
+}
+
+RetentionManager::~RetentionManager() {
+  // 等待正在写入的段完成；尚未启用的暂存段作废，预约下次启动时再归档
+  watcher.waitForFinished();
+  if (!pendingMonth.isEmpty() && archive) {
+    archive->discardSegment(pendingMonth);
+  }
+}
+
+void RetentionManager::start() {
+  if (retentionDays <= 0 || !appointmentManager || !archive) return;
+  timer.start(kStepIntervalMs);
+}
+
+void RetentionManager::step() {
+  if (watcher.isRunning()) return;
+
+  // 有模态对话框时暂缓，避免对话框持有的预约下标失效
+  if (QApplication::activeModalWidget()) {
+    timer.start(kStepIntervalMs);
+    return;
+  }
+
+  if (segmentReady) {
+    applyPending();
+    return;
+  }
+
+  pendingCutoff = QDate::currentDate().addDays(-retentionDays);
+  pendingMonth = appointmentManager->oldestPartitionBefore(pendingCutoff);
+  if (pendingMonth.isEmpty()) {
+    timer.start(kIdleIntervalMs);
+    return;
+  }
+
+  // 变更代号在载入分区之后读取，载入本身不算作快照后的修改
+  pendingRecords = appointmentManager->appointmentsToArchive(pendingMonth,
+                                                             pendingCutoff);
+  pendingGeneration = appointmentManager->generation();
+  if (pendingRecords.isEmpty()) {
+    pendingMonth.clear();
+    timer.start(kIdleIntervalMs);
+    return;
+  }
+
+  watcher.setFuture(QtConcurrent::run(archive,
+                                      &AppointmentArchive::writeSegment,
+                                      pendingMonth, pendingRecords,
+                                      &pendingIndex));
+}
+
+void RetentionManager::onSegmentWritten() {
+  if (!watcher.result()) {
+    qDebug() << "归档失败，稍后重试：" << pendingMonth;
+    archive->discardSegment(pendingMonth);
+    pendingMonth.clear();
+    pendingRecords.clear();
+    timer.start(kIdleIntervalMs);
+    return;
+  }
+
+  // 归档段已落盘，随后（无模态对话框时）再从预约数据中移除
+  segmentReady = true;
+  step();
+}
+
+void RetentionManager::applyPending() {
+  segmentReady = false;
+  QString month = pendingMonth;
+  bool stillCurrent = pendingStillCurrent();
+  pendingMonth.clear();
+
+  if (!stillCurrent) {
+    // 写盘期间该月的预约被修改或删除：丢弃写好的段，下一步重新取快照
+    qDebug() << "归档期间预约有变化，重新归档：" << month;
+    archive->discardSegment(month);
+    pendingRecords.clear();
+    timer.start(kStepIntervalMs);
+    return;
+  }
+  if (!archive->installSegment(pendingIndex)) {
+    pendingRecords.clear();
+    timer.start(kIdleIntervalMs);
+    return;
+  }
+
+  int removed = appointmentManager->removeArchived(pendingRecords);
+  qDebug() << "已归档" << month << "的预约" << pendingRecords.size() << "个";
+  pendingRecords.clear();
+  emit monthArchived(month, removed);
+  timer.start(kStepIntervalMs);
+}
+
+// 预约数据未变化时快照必然有效；有变化时重新取该月的预约，逐条比较内容
+bool RetentionManager::pendingStillCurrent() {
+  if (appointmentManager->generation() == pendingGeneration) return true;
+
+  QList<Appointment> current =
+      appointmentManager->appointmentsToArchive(pendingMonth, pendingCutoff);
+  if (current.size() != pendingRecords.size()) return false;
+
+  QStringList before;
+  QStringList after;
+  for (int i = 0; i < current.size(); ++i) {
+    before.append(QString::fromUtf8(
+        QJsonDocument(AppointmentManager::appointmentToJson(pendingRecords[i]))
+            .toJson(QJsonDocument::Compact)));
+    after.append(QString::fromUtf8(
+        QJsonDocument(AppointmentManager::appointmentToJson(current[i]))
+            .toJson(QJsonDocument::Compact)));
+  }
+  before.sort();
+  after.sort();
+  return before == after;
+}
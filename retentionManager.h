@@ -0,0 +1,53 @@
+#ifndef RETENTIONMANAGER_H
+#define RETENTIONMANAGER_H
+
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+#include "appointmentArchive.h"
+#include "appointmentManager.h"
+
+// 保留策略：只在内存中保留最近 retentionDays 天（及以后）的预约，更早的
+// 预约在后台逐月移入归档。每一步只处理一个月：压缩写入归档段在工作
+// 线程中进行，写盘成功后再从预约数据中移除，中途退出不会丢失数据。
+// 写盘期间预约数据若有变化（按变更代号判断），重新取该月的预约比较，
+// 不一致时丢弃写好的段并重新归档，不会按过期的快照移除预约。
+class RetentionManager : public QObject {
+  Q_OBJECT
+
+ public:
+  RetentionManager(AppointmentManager* appointmentMgr,
+                   AppointmentArchive* archive, int retentionDays,
+                   QObject* parent = nullptr);
+  ~RetentionManager();
+
+  void start();  // 开始后台归档（retentionDays <= 0 时不启用）
+
+ signals:
+  // 一个月的预约已归档并从预约数据中移除（需要保存预约数据）
+  void monthArchived(const QString& month, int count);
+
+ private slots:
+  void step();
+  void onSegmentWritten();
+
+ private:
+  AppointmentManager* appointmentManager;
+  AppointmentArchive* archive;
+  int retentionDays;
+  QTimer timer;                       // 下一步的触发（单次）
+  QFutureWatcher<bool> watcher;       // 正在写入的归档段
+  QString pendingMonth;               // 正在归档的月份
+  QDate pendingCutoff;                // 本次归档的截止日期
+  QList<Appointment> pendingRecords;  // 正在归档的预约
+  quint64 pendingGeneration;          // 取快照时的预约数据变更代号
+  ArchiveSegmentIndex pendingIndex;   // 新段的索引（由工作线程填写）
+  bool segmentReady;                  // 新段已写盘，等待移除预约
+
+  void applyPending();  // 启用新段并从预约数据中移除已归档的预约
+  bool pendingStillCurrent();  // 快照是否仍与预约数据一致
+};
+
+#endif
@@ -0,0 +1,51 @@
+#include "sseParser.h"
+
+SseParser::SseParser() : hasData(false), done(false) {}
+
+QStringList SseParser::feed(const QByteArray& bytes) {
+  QStringList events;
+  buffer += bytes;
+
+  int start = 0;
+  int newline = 0;
+  while ((newline = buffer.indexOf('\n', start)) >= 0) {
+    QByteArray line = buffer.mid(start, newline - start);
+    start = newline + 1;
+    if (line.endsWith('\r')) line.chop(1);
+
+    // 空行结束一个事件
+    if (line.isEmpty()) {
+      if (hasData) {
+        if (eventData == "[DONE]") {
+          done = true;
+        } else {
+          events.append(QString::fromUtf8(eventData));
+        }
+      }
+      eventData.clear();
+      hasData = false;
+      continue;
+    }
+    if (line.startsWith(':')) continue;  // 注释（心跳）
+
+    // 只关心 data 字段，event/id/retry 忽略
+    if (line.startsWith("data:")) {
+      QByteArray value = line.mid(5);
+      if (value.startsWith(' ')) value.remove(0, 1);
+      if (hasData) eventData += '\n';
+      eventData += value;
+      hasData = true;
+    }
+  }
+  buffer.remove(0, start);
+  return events;
+}
+
+bool SseParser::isDone() const { return done; }
+
+void SseParser::reset() {
+  buffer.clear();
+  eventData.clear();
+  hasData = false;
+  done = false;
+}
@@ -0,0 +1,25 @@
+#ifndef SSEPARSER_H
+#define SSEPARSER_H
+
+#include <QByteArray>
+#include <QStringList>
+
+// 服务器推送事件（text/event-stream）的增量解析器：字节可按任意边界
+// 分批喂入，返回已完整的事件的 data 字段（多行 data 以换行拼接）。
+// 收到 OpenAI 兼容接口的结束标记 "[DONE]" 后 isDone() 为 true
+class SseParser {
+ public:
+  SseParser();
+
+  QStringList feed(const QByteArray& bytes);
+  bool isDone() const;
+  void reset();
+
+ private:
+  QByteArray buffer;     // 尚未读到换行的残余字节
+  QByteArray eventData;  // 当前事件已读到的 data
+  bool hasData;
+  bool done;
+};
+
+#endif
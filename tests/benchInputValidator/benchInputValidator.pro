@@ -0,0 +1,11 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = benchInputValidator
+
+SOURCES += tst_benchInputValidator.cpp
+
+include(../../inputValidator.pri)
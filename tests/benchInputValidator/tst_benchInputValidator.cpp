@@ -0,0 +1,115 @@
+#include <QtTest>
+
+#include "inputValidator.h"
+
+// 批量校验吞吐量：同一批数据分别走批量内核与逐条校验，
+// 先确认结果一致，再用 QBENCHMARK 比较耗时。
+class BenchInputValidator : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void idNumbersMatchScalar();
+  void phonesMatchScalar();
+  void idNumbersBatch();
+  void idNumbersPerRecord();
+  void phonesBatch();
+  void phonesPerRecord();
+
+ private:
+  static QString makeIdNumber(int seed);
+  static QString makePhone(int seed);
+
+  QStringList idNumbers;
+  QStringList phones;
+};
+
+static const int kRecordCount = 100000;
+
+QString BenchInputValidator::makeIdNumber(int seed) {
+  static const int kWeights[17] = {7, 9,  10, 5, 8, 4, 2, 1, 6,
+                                   3, 7, 9, 10, 5, 8, 4, 2};
+  static const char kCheckCodes[] = "10X98765432";
+
+  QDate birth = QDate(1950, 1, 1).addDays(seed % 20000);
+  QString body = QString("%1%2%3")
+                     .arg(110100 + seed % 900)
+                     .arg(birth.toString("yyyyMMdd"))
+                     .arg(seed % 1000, 3, 10, QChar('0'));
+  int sum = 0;
+  for (int i = 0; i < 17; ++i) sum += body[i].digitValue() * kWeights[i];
+  QString id = body + QChar(kCheckCodes[sum % 11]);
+
+  // 约十分之一的记录故意改坏，覆盖失败分支
+  if (seed % 10 == 3) id[17] = id[17] == '0' ? '1' : '0';
+  if (seed % 10 == 7) id[5] = 'A';
+  if (seed % 10 == 9) id.chop(1);
+  return id;
+}
+
+QString BenchInputValidator::makePhone(int seed) {
+  switch (seed % 5) {
+    case 0:
+      return QString("13%1").arg(seed % 1000000000, 9, 10, QChar('0'));
+    case 1:
+      return QString("010-%1").arg(seed % 100000000, 8, 10, QChar('0'));
+    case 2:
+      return QString("400%1").arg(seed % 10000000, 7, 10, QChar('0'));
+    case 3:
+      return QString("12%1").arg(seed % 1000000000, 9, 10, QChar('0'));
+    default:
+      return QString("0571-12a4567");
+  }
+}
+
+void BenchInputValidator::initTestCase() {
+  idNumbers.reserve(kRecordCount);
+  phones.reserve(kRecordCount);
+  for (int i = 0; i < kRecordCount; ++i) {
+    idNumbers.append(makeIdNumber(i));
+    phones.append(makePhone(i));
+  }
+  qDebug() << "批量内核：" << InputValidator::batchKernelName();
+}
+
+void BenchInputValidator::idNumbersMatchScalar() {
+  QVector<bool> batch = InputValidator::validateIdNumbers(idNumbers);
+  QCOMPARE(batch.size(), idNumbers.size());
+  for (int i = 0; i < idNumbers.size(); ++i) {
+    QCOMPARE(batch[i], InputValidator::isValidIdNumber(idNumbers[i]));
+  }
+}
+
+void BenchInputValidator::phonesMatchScalar() {
+  QVector<bool> batch = InputValidator::validatePhoneNumbers(phones);
+  QCOMPARE(batch.size(), phones.size());
+  for (int i = 0; i < phones.size(); ++i) {
+    QCOMPARE(batch[i], InputValidator::isValidPhoneNumber(phones[i]));
+  }
+}
+
+void BenchInputValidator::idNumbersBatch() {
+  QBENCHMARK { InputValidator::validateIdNumbers(idNumbers); }
+}
+
+void BenchInputValidator::idNumbersPerRecord() {
+  QBENCHMARK {
+    for (const QString& id : idNumbers) InputValidator::isValidIdNumber(id);
+  }
+}
+
+void BenchInputValidator::phonesBatch() {
+  QBENCHMARK { InputValidator::validatePhoneNumbers(phones); }
+}
+
+void BenchInputValidator::phonesPerRecord() {
+  QBENCHMARK {
+    for (const QString& phone : phones) {
+      InputValidator::isValidPhoneNumber(phone);
+    }
+  }
+}
+
+QTEST_APPLESS_MAIN(BenchInputValidator)
+
+#include "tst_benchInputValidator.moc"
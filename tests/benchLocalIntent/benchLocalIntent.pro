@@ -0,0 +1,38 @@
+QT       += core network concurrent testlib
+QT       -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = benchLocalIntent
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_benchLocalIntent.cpp \
+    ../../aiContextBuilder.cpp \
+    ../../appointment.cpp \
+    ../../appointmentArchive.cpp \
+    ../../appointmentManager.cpp \
+    ../../availabilityIndex.cpp \
+    ../../bloomFilter.cpp \
+    ../../departmentRecommender.cpp \
+    ../../expert.cpp \
+    ../../expertManager.cpp \
+    ../../jsonImport.cpp \
+    ../../localIntentMatcher.cpp
+
+HEADERS += \
+    ../../aiContextBuilder.h \
+    ../../appointment.h \
+    ../../appointmentArchive.h \
+    ../../appointmentManager.h \
+    ../../availabilityIndex.h \
+    ../../bloomFilter.h \
+    ../../departmentRecommender.h \
+    ../../expert.h \
+    ../../expertManager.h \
+    ../../jsonImport.h \
+    ../../localIntentMatcher.h
+
+include(../common/mockAiServer.pri)
@@ -0,0 +1,172 @@
+#include <QtTest>
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+#include "aiContextBuilder.h"
+#include "availabilityIndex.h"
+#include "localIntentMatcher.h"
+#include "mockAiServer.h"
+
+// 本地意图匹配：哪些问题在本地作答、科室余号走余号索引与逐个专家计算
+// 的耗时，以及与（本机模拟的）远程回答往返耗时的对比
+class BenchLocalIntent : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void routesQuestions_data();
+  void routesQuestions();
+  void indexMatchesScan();
+  void departmentSlots_data();
+  void departmentSlots();
+  void mockRemoteRoundTrip();
+
+ private:
+  ExpertManager expertManager;
+  AppointmentManager appointmentManager;
+  AvailabilityIndex* availabilityIndex = nullptr;
+  AIContextBuilder* contextBuilder = nullptr;
+};
+
+static const QStringList kDepartments = {"内科", "外科",   "儿科",
+                                         "眼科", "骨科",   "皮肤科",
+                                         "口腔科", "耳鼻喉科"};
+static const int kExpertsPerDepartment = 40;
+static const int kCapacity = 5;
+
+void BenchLocalIntent::initTestCase() {
+  static const QStringList kWeekSlots = {
+      "周一：08:00-12:00", "周二：08:00-12:00", "周三：14:00-17:00",
+      "周四：08:00-12:00", "周五：14:00-17:00", "周六：08:00-12:00",
+      "周日：08:00-12:00"};
+  for (int d = 0; d < kDepartments.size(); ++d) {
+    for (int i = 0; i < kExpertsPerDepartment; ++i) {
+      Expert expert;
+      expert.name = QString("陈%1").arg(d * 100 + i, 3, 10, QChar('0'));
+      expert.subject = kDepartments[d];
+      expert.title = "主任医师";
+      // 每位专家每周出诊 3 天
+      for (int day = 0; day < 7; ++day) {
+        if ((day + i) % 7 < 3) {
+          expert.serviceTimes.append(kWeekSlots[day]);
+          expert.setTimeSlotCapacity(kWeekSlots[day], kCapacity);
+        }
+      }
+      expertManager.experts.append(expert);
+    }
+  }
+  expertManager.markChanged();
+
+  // 明天约满一半出诊专家的号
+  QDate tomorrow = QDate::currentDate().addDays(1);
+  int expertIndex = 0;
+  for (const Expert& expert : expertManager.experts) {
+    if (!expert.isAvailableOnDate(tomorrow) || expertIndex++ % 2) continue;
+    QString slot = expert.getAvailableTimeSlotsForDate(tomorrow).first();
+    for (int n = 0; n < kCapacity; ++n) {
+      Appointment appointment;
+      appointment.patientName = QString("患者%1").arg(n);
+      appointment.idNumber = expert.name + QString::number(n);
+      appointment.expertName = expert.name;
+      appointment.expertSubject = expert.subject;
+      appointment.serviceTime = slot;
+      appointment.queueNumber = n + 1;
+      appointment.appointmentDate = tomorrow;
+      appointmentManager.addAppointment(appointment);
+    }
+  }
+
+  availabilityIndex = new AvailabilityIndex(&expertManager,
+                                            &appointmentManager, 60, this);
+  contextBuilder = new AIContextBuilder(&expertManager, &appointmentManager);
+}
+
+void BenchLocalIntent::cleanupTestCase() { delete contextBuilder; }
+
+void BenchLocalIntent::routesQuestions_data() {
+  QTest::addColumn<QString>("query");
+  QTest::addColumn<QString>("intent");  // 为空表示交给远程模型
+
+  QTest::newRow("slots") << "明天内科还有号吗" << "remainingSlots";
+  QTest::newRow("slot count") << "明天外科还有几个号" << "remainingSlots";
+  QTest::newRow("quota") << "明天儿科还有名额吗" << "remainingSlots";
+  QTest::newRow("expert duty") << "陈001明天出诊吗" << "expertOnDuty";
+  QTest::newRow("expert slots") << "陈001明天能约吗" << "remainingSlots";
+  QTest::newRow("fee") << "明天内科挂号费多少钱" << "";
+  QTest::newRow("location") << "明天眼科门诊在几楼" << "";
+  QTest::newRow("clinic only") << "明天内科门诊" << "";
+  QTest::newRow("how many people") << "明天内科多少人" << "";
+  QTest::newRow("advice") << "明天内科哪个专家好" << "";
+}
+
+void BenchLocalIntent::routesQuestions() {
+  QFETCH(QString, query);
+  QFETCH(QString, intent);
+
+  LocalIntentMatcher matcher(&expertManager, &appointmentManager, nullptr,
+                             availabilityIndex);
+  QueryEntities entities =
+      contextBuilder->extractEntities(query, QDate::currentDate());
+  LocalAnswer answer = matcher.answer(query, entities);
+  QCOMPARE(answer.matched, !intent.isEmpty());
+  if (answer.matched) QCOMPARE(answer.intent, intent);
+}
+
+// 余号索引与逐个专家计算给出的剩余号数一致
+void BenchLocalIntent::indexMatchesScan() {
+  LocalIntentMatcher indexed(&expertManager, &appointmentManager, nullptr,
+                             availabilityIndex);
+  LocalIntentMatcher scanning(&expertManager, &appointmentManager);
+  QRegularExpression total("剩余 (\\d+) 个号：");
+
+  for (const QString& department : kDepartments) {
+    QString query = "明天" + department + "还有号吗";
+    QueryEntities entities =
+        contextBuilder->extractEntities(query, QDate::currentDate());
+    QString fromIndex = indexed.answer(query, entities).text;
+    QString fromScan = scanning.answer(query, entities).text;
+    QCOMPARE(total.match(fromIndex).captured(1),
+             total.match(fromScan).captured(1));
+  }
+}
+
+void BenchLocalIntent::departmentSlots_data() {
+  QTest::addColumn<bool>("useIndex");
+  QTest::newRow("availabilityIndex") << true;
+  QTest::newRow("scan") << false;
+}
+
+void BenchLocalIntent::departmentSlots() {
+  QFETCH(bool, useIndex);
+  LocalIntentMatcher matcher(&expertManager, &appointmentManager, nullptr,
+                             useIndex ? availabilityIndex : nullptr);
+  QString query = "下周内科还有号吗";
+  QueryEntities entities =
+      contextBuilder->extractEntities(query, QDate::currentDate());
+
+  QBENCHMARK { QVERIFY(matcher.answer(query, entities).matched); }
+}
+
+// 远程回答的下限：本机模拟接口的一次请求往返（不含模型生成时间）
+void BenchLocalIntent::mockRemoteRoundTrip() {
+  MockAiServer server;
+  QVERIFY(server.listen());
+  QNetworkAccessManager network;
+  QNetworkRequest request(server.url());
+  request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+  QBENCHMARK {
+    QNetworkReply* reply = network.post(request, QByteArray("{}"));
+    QSignalSpy finished(reply, &QNetworkReply::finished);
+    QVERIFY(finished.wait(5000));
+    QVERIFY(reply->readAll().contains("[DONE]"));
+    reply->deleteLater();
+  }
+}
+
+QTEST_GUILESS_MAIN(BenchLocalIntent)
+
+#include "tst_benchLocalIntent.moc"
@@ -0,0 +1,30 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = benchVisitHistory
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_benchVisitHistory.cpp \
+    ../../appointment.cpp \
+    ../../appointmentArchive.cpp \
+    ../../appointmentManager.cpp \
+    ../../bloomFilter.cpp \
+    ../../expert.cpp \
+    ../../expertManager.cpp \
+    ../../jsonImport.cpp \
+    ../../visitHistory.cpp
+
+HEADERS += \
+    ../../appointment.h \
+    ../../appointmentArchive.h \
+    ../../appointmentManager.h \
+    ../../bloomFilter.h \
+    ../../expert.h \
+    ../../expertManager.h \
+    ../../jsonImport.h \
+    ../../visitHistory.h
@@ -0,0 +1,154 @@
+#include <QtTest>
+
+#include "appointmentArchive.h"
+#include "appointmentManager.h"
+#include "visitHistory.h"
+
+// 就诊历史查询延迟：24 个月的分区（只载入最近一个月）加 12 个月的归档，
+// 分别测量首次查询（需读取分区与解压归档段）与缓存命中后的查询耗时；
+// 只在一个分区中就诊过的患者，其余分区应由布隆过滤器跳过
+class BenchVisitHistory : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void coldLookupFindsAllVisits();
+  void coldLookupSkipsOtherPartitions();
+  void warmLookupLatency();
+  void warmLookup();
+
+ private:
+  QTemporaryDir dataDir;
+  AppointmentManager* manager = nullptr;
+  AppointmentArchive archive;
+  QDate firstMonth;
+  QDate currentMonth;
+  QString partitionDir;
+};
+
+static const int kPartitionMonths = 24;
+static const int kArchiveMonths = 12;
+static const int kPerMonth = 2000;
+static const int kPatients = 500;  // 每位患者每月约 4 次就诊
+static const double kMaxWarmLookupMs = 5.0;
+static const double kMaxColdLookupMs = 10.0;  // 只需读取一个分区时
+
+static QString patientId(int patient) {
+  return QString("110101199001%1").arg(patient, 6, 10, QChar('0'));
+}
+
+// 只在第 m 个未载入分区中就诊一次的患者
+static QString singleVisitId(int m) {
+  return QString("110101198001%1").arg(m, 6, 10, QChar('0'));
+}
+
+static Appointment makeVisit(const QDate& month, int i) {
+  Appointment visit;
+  visit.patientName = QString("患者%1").arg(i % kPatients);
+  visit.idNumber = patientId(i % kPatients);
+  visit.expertName = QString("专家%1").arg(i % 20);
+  visit.expertSubject = "内科";
+  visit.serviceTime = i % 2 ? "08:00-12:00" : "14:00-17:00";
+  visit.queueNumber = i / 40 + 1;
+  visit.appointmentDate = month.addDays(i / kPatients * 7);  // 同一患者不同日
+  return visit;
+}
+
+void BenchVisitHistory::initTestCase() {
+  QVERIFY(dataDir.isValid());
+  partitionDir = dataDir.filePath("appointments");
+  QDate today = QDate::currentDate();
+  currentMonth = QDate(today.year(), today.month(), 1);
+  firstMonth = currentMonth.addMonths(-(kArchiveMonths + kPartitionMonths) + 1);
+
+  // 较早的 12 个月写入归档段，其后 24 个月写入分区
+  QVERIFY(archive.open(dataDir.filePath("archive")));
+  for (int m = 0; m < kArchiveMonths; ++m) {
+    QDate month = firstMonth.addMonths(m);
+    QList<Appointment> records;
+    for (int i = 0; i < kPerMonth; ++i) records.append(makeVisit(month, i));
+    ArchiveSegmentIndex index;
+    QString key = AppointmentManager::partitionKey(month);
+    QVERIFY(archive.writeSegment(key, records, &index));
+    QVERIFY(archive.installSegment(index));
+  }
+
+  AppointmentManager writer;
+  for (int m = kArchiveMonths; m < kArchiveMonths + kPartitionMonths; ++m) {
+    QDate month = firstMonth.addMonths(m);
+    for (int i = 0; i < kPerMonth; ++i) {
+      writer.addAppointment(makeVisit(month, i));
+    }
+    if (month != currentMonth) {
+      Appointment visit = makeVisit(month, 0);
+      visit.patientName = "单次就诊";
+      visit.idNumber = singleVisitId(m - kArchiveMonths);
+      writer.addAppointment(visit);
+    }
+  }
+  QVERIFY(writer.savePartitions(partitionDir));
+
+  manager = new AppointmentManager(this);
+  QVERIFY(manager->loadPartitions(partitionDir, currentMonth));
+  QVERIFY(manager->hasUnloadedPartitions());
+}
+
+void BenchVisitHistory::coldLookupFindsAllVisits() {
+  VisitHistory history(manager, &archive);
+  qint64 elapsedMs = 0;
+  QList<Appointment> visits = history.lookup(patientId(7), &elapsedMs);
+  QCOMPARE(visits.size(),
+           (kArchiveMonths + kPartitionMonths) * kPerMonth / kPatients);
+  qDebug() << "首次查询耗时" << elapsedMs << "ms";
+}
+
+// 每次查询只读取患者所在的那一个分区（过滤器排除其余分区），首次查询
+// 的平均耗时应在 kMaxColdLookupMs 以内。使用单独的管理器，分区缓存为空
+void BenchVisitHistory::coldLookupSkipsOtherPartitions() {
+  AppointmentManager cold;
+  QVERIFY(cold.loadPartitions(partitionDir, currentMonth));
+  VisitHistory history(&cold, &archive);
+
+  const int lookups = kPartitionMonths - 1;  // 当前月已载入
+  qint64 totalNs = 0;
+  for (int m = 0; m < lookups; ++m) {
+    int readsBefore = cold.partitionFileReads();
+    QElapsedTimer timer;
+    timer.start();
+    QList<Appointment> visits = history.lookup(singleVisitId(m));
+    totalNs += timer.nsecsElapsed();
+    QCOMPARE(visits.size(), 1);
+    QCOMPARE(cold.partitionFileReads() - readsBefore, 1);
+  }
+  double averageMs = totalNs / 1e6 / lookups;
+  qDebug() << "只读一个分区的首次查询平均耗时" << averageMs << "ms";
+  QVERIFY2(averageMs < kMaxColdLookupMs,
+           qPrintable(QString("平均 %1 ms").arg(averageMs)));
+}
+
+// 缓存命中后逐个患者查询的平均耗时应远低于一次分区读取
+void BenchVisitHistory::warmLookupLatency() {
+  VisitHistory history(manager, &archive);
+  history.lookup(patientId(0));  // 预热：读取并缓存全部分区与归档段
+
+  QElapsedTimer timer;
+  timer.start();
+  const int lookups = 200;
+  for (int i = 0; i < lookups; ++i) {
+    QVERIFY(!history.lookup(patientId(i % kPatients)).isEmpty());
+  }
+  double averageMs = timer.nsecsElapsed() / 1e6 / lookups;
+  qDebug() << "缓存命中后平均查询耗时" << averageMs << "ms";
+  QVERIFY2(averageMs < kMaxWarmLookupMs,
+           qPrintable(QString("平均 %1 ms").arg(averageMs)));
+}
+
+void BenchVisitHistory::warmLookup() {
+  VisitHistory history(manager, &archive);
+  int patient = 0;
+  QBENCHMARK { history.lookup(patientId(patient++ % kPatients)); }
+}
+
+QTEST_GUILESS_MAIN(BenchVisitHistory)
+
+#include "tst_benchVisitHistory.moc"
@@ -0,0 +1,161 @@
+#include "mockAiServer.h"
+
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QTimer>
+
+MockResponse MockResponse::stream(const QStringList& pieces, int intervalMs) {
+  MockResponse response;
+  response.intervalMs = intervalMs;
+  for (const QString& piece : pieces) {
+    QJsonObject delta;
+    delta["content"] = piece;
+    QJsonObject choice;
+    choice["delta"] = delta;
+    QJsonObject chunk;
+    chunk["object"] = "chat.completion.chunk";
+    chunk["choices"] = QJsonArray{choice};
+    response.events.append(
+        QJsonDocument(chunk).toJson(QJsonDocument::Compact));
+  }
+  response.events.append("[DONE]");
+  return response;
+}
+
+MockResponse MockResponse::json(const QString& content) {
+  QJsonObject message;
+  message["role"] = "assistant";
+  message["content"] = content;
+  QJsonObject choice;
+  choice["message"] = message;
+  QJsonObject completion;
+  completion["choices"] = QJsonArray{choice};
+
+  MockResponse response;
+  response.body = QJsonDocument(completion).toJson(QJsonDocument::Compact);
+  return response;
+}
+
+MockResponse MockResponse::error(int status, const QByteArray& retryAfter) {
+  MockResponse response;
+  response.status = status;
+  response.retryAfter = retryAfter;
+  return response;
+}
+
+MockResponse MockResponse::stalled() {
+  MockResponse response;
+  response.stall = true;
+  return response;
+}
+
+MockAiServer::MockAiServer(QObject* parent) : QObject(parent) {
+  connect(&server, &QTcpServer::newConnection, this,
+          &MockAiServer::onNewConnection);
+}
+
+bool MockAiServer::listen() {
+  clock.start();
+  return server.listen(QHostAddress::LocalHost, 0);
+}
+
+QUrl MockAiServer::url() const {
+  return QUrl(QString("http://127.0.0.1:%1/v1/chat/completions")
+                  .arg(server.serverPort()));
+}
+
+void MockAiServer::enqueue(const MockResponse& response) {
+  queue.append(response);
+}
+
+QList<QByteArray> MockAiServer::requests() const { return received; }
+
+QList<qint64> MockAiServer::requestTimes() const { return receivedAt; }
+
+int MockAiServer::openConnections() const { return buffers.size(); }
+
+void MockAiServer::onNewConnection() {
+  while (QTcpSocket* socket = server.nextPendingConnection()) {
+    buffers.insert(socket, QByteArray());
+    connect(socket, &QTcpSocket::readyRead, this,
+            [this, socket]() { onReadyRead(socket); });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+      buffers.remove(socket);
+      socket->deleteLater();
+    });
+  }
+}
+
+void MockAiServer::onReadyRead(QTcpSocket* socket) {
+  QByteArray& buffer = buffers[socket];
+  buffer += socket->readAll();
+
+  // 请求头以空行结束，请求体长度由 Content-Length 给出
+  int headerEnd = buffer.indexOf("\r\n\r\n");
+  if (headerEnd < 0) return;
+  int contentLength = 0;
+  for (const QByteArray& line : buffer.left(headerEnd).split('\n')) {
+    if (line.toLower().startsWith("content-length:")) {
+      contentLength = line.mid(15).trimmed().toInt();
+    }
+  }
+  if (buffer.size() < headerEnd + 4 + contentLength) return;
+
+  received.append(buffer.mid(headerEnd + 4, contentLength));
+  receivedAt.append(clock.elapsed());
+  buffer.clear();
+  respond(socket, queue.isEmpty() ? MockResponse::stream({"默认回答"})
+                                  : queue.takeFirst());
+}
+
+void MockAiServer::respond(QTcpSocket* socket, const MockResponse& response) {
+  QByteArray head = "HTTP/1.1 " + QByteArray::number(response.status) +
+                    (response.status == 200 ? " OK" : " Error") + "\r\n";
+  if (!response.retryAfter.isEmpty()) {
+    head += "Retry-After: " + response.retryAfter + "\r\n";
+  }
+
+  // 每个回答后关闭连接，流式回答以连接关闭表示结束
+  head += "Connection: close\r\n";
+  if (response.status != 200) {
+    head += "Content-Length: 0\r\n\r\n";
+    socket->write(head);
+    socket->disconnectFromHost();
+    return;
+  }
+  if (response.events.isEmpty() && !response.stall) {
+    head += "Content-Type: application/json\r\nContent-Length: " +
+            QByteArray::number(response.body.size()) + "\r\n\r\n";
+    socket->write(head + response.body);
+    socket->disconnectFromHost();
+    return;
+  }
+
+  head += "Content-Type: text/event-stream\r\nCache-Control: no-cache\r\n\r\n";
+  socket->write(head);
+  if (!response.stall) sendEvents(socket, response, 0);
+}
+
+void MockAiServer::sendEvents(QTcpSocket* socket, const MockResponse& response,
+                              int next) {
+  if (next >= response.events.size()) {
+    socket->disconnectFromHost();
+    return;
+  }
+  socket->write("data: " + response.events[next] + "\n\n");
+  socket->flush();
+
+  // 按间隔发送下一个事件；客户端提前断开时停止
+  QPointer<QTcpSocket> guard(socket);
+  QTimer::singleShot(response.intervalMs, this,
+                     [this, guard, response, next]() {
+                       if (guard &&
+                           guard->state() == QAbstractSocket::ConnectedState) {
+                         sendEvents(guard, response, next + 1);
+                       }
+                     });
+}
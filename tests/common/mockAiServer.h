@@ -0,0 +1,65 @@
+#ifndef MOCKAISERVER_H
+#define MOCKAISERVER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTcpServer>
+#include <QUrl>
+
+class QTcpSocket;
+
+// 模拟服务的一次回答
+struct MockResponse {
+  int status = 200;
+  QList<QByteArray> events;  // SSE 事件的 data（逐个发送）
+  QByteArray body;           // 非流式回答的响应体（events 为空时使用）
+  int intervalMs = 0;        // 相邻两个事件之间的间隔
+  bool stall = false;        // 发送响应头后不再发送数据、不关闭连接
+  QByteArray retryAfter;     // Retry-After 响应头（为空时不发送）
+
+  // 流式回答：每段为一个 chat.completion.chunk，最后发送 [DONE]
+  static MockResponse stream(const QStringList& pieces, int intervalMs = 0);
+  // 非流式回答（application/json）
+  static MockResponse json(const QString& content);
+  // retryAfter 为空时不发送 Retry-After，由客户端自行退避
+  static MockResponse error(int status, const QByteArray& retryAfter = "0");
+  static MockResponse stalled();
+};
+
+// 本地的 OpenAI 兼容聊天接口（HTTP/1.1 + SSE）：按到达顺序依次使用
+// enqueue 的回答，队列为空时回答“默认回答”。记录每个请求的请求体与
+// 到达时间
+class MockAiServer : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit MockAiServer(QObject* parent = nullptr);
+
+  bool listen();
+  QUrl url() const;  // http://127.0.0.1:<端口>/v1/chat/completions
+  void enqueue(const MockResponse& response);
+  QList<QByteArray> requests() const;  // 已收到的请求体（按到达顺序）
+  QList<qint64> requestTimes() const;  // 各请求的到达时间（listen 起的毫秒数）
+  int openConnections() const;
+
+ private slots:
+  void onNewConnection();
+
+ private:
+  QTcpServer server;
+  QList<MockResponse> queue;
+  QList<QByteArray> received;
+  QList<qint64> receivedAt;
+  QElapsedTimer clock;
+  QHash<QTcpSocket*, QByteArray> buffers;  // 连接 -> 尚未处理的请求字节
+
+  void onReadyRead(QTcpSocket* socket);
+  void respond(QTcpSocket* socket, const MockResponse& response);
+  void sendEvents(QTcpSocket* socket, const MockResponse& response, int next);
+};
+
+#endif
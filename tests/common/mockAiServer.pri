@@ -0,0 +1,7 @@
+# 本地模拟的 AI 聊天接口（SSE），供 AI 助手相关测试共用
+QT += network
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/mockAiServer.cpp
+HEADERS += $$PWD/mockAiServer.h
@@ -0,0 +1,10 @@
+# 独立的测试与基准子项目，不参与主程序构建：
+#   qmake tests/tests.pro && make && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    benchInputValidator \
+    benchLocalIntent \
+    benchVisitHistory \
+    tst_aiChatDialog \
+    tst_sseParser
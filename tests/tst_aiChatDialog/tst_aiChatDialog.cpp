@@ -0,0 +1,278 @@
+#include <QtTest>
+
+#include <QApplication>
+#include <QLineEdit>
+#include <QListView>
+#include <QNetworkAccessManager>
+#include <QPushButton>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+#include "aiChatDialog.h"
+#include "chatMessageModel.h"
+#include "mockAiServer.h"
+
+// AI 助手与本地模拟接口的端到端测试：流式显示、429/5xx/超时重试与退避、
+// 取消与并发提问。对话框从配置读取接口地址；配置写入临时目录（见 main），
+// 不改动本机真实的应用配置
+class TestAiChatDialog : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void init();
+  void cleanup();
+
+  void streamsAnswerIncrementally();
+  void sendsStreamingRequest();
+  void parsesNonStreamingAnswer();
+  void retriesServerErrors_data();
+  void retriesServerErrors();
+  void givesUpAfterMaxRetries();
+  void backsOffWithoutRetryAfter();
+  void retriesAfterTimeout();
+  void cancelsWaitingQuery();
+  void cancelKeepsPartialAnswer();
+  void concurrentQueriesFillOwnBubbles();
+  void rejectsOversizedQuestion();
+
+ private:
+  void openDialog();
+  void ask(const QString& question);
+  QStringList answers() const;  // 助手气泡（不含欢迎语）
+  QString lastAnswer() const;
+  QPushButton* cancelButton() const;
+
+  ExpertManager expertManager;
+  AppointmentManager appointmentManager;
+  QNetworkAccessManager networkManager;
+  MockAiServer* server = nullptr;
+  AIChatDialog* dialog = nullptr;
+};
+
+// 退避间隔允许的额外延迟（请求往返与事件循环调度）
+static const qint64 kBackoffSlackMs = 300;
+
+void TestAiChatDialog::init() {
+  server = new MockAiServer(this);
+  QVERIFY(server->listen());
+
+  QSettings settings("HospitalApp", "AppointmentSystem");
+  settings.setValue("aiApiUrl", server->url().toString());
+  settings.setValue("aiStreaming", true);
+  settings.setValue("aiTimeoutSeconds", 1);
+  settings.setValue("aiMaxRetries", 2);
+  settings.remove("aiMaxRequestTokens");
+}
+
+void TestAiChatDialog::cleanup() {
+  delete dialog;
+  dialog = nullptr;
+  delete server;
+  server = nullptr;
+}
+
+void TestAiChatDialog::openDialog() {
+  dialog = new AIChatDialog(&expertManager, &appointmentManager,
+                            &networkManager, nullptr, nullptr, nullptr);
+  dialog->show();
+}
+
+void TestAiChatDialog::ask(const QString& question) {
+  dialog->findChild<QLineEdit*>("messageInput")->setText(question);
+  dialog->findChild<QPushButton*>("sendButton")->click();
+}
+
+QStringList TestAiChatDialog::answers() const {
+  QAbstractItemModel* model = dialog->findChild<QListView*>("chatHistory")
+                                  ->model();
+  QStringList texts;
+  for (int row = 1; row < model->rowCount(); ++row) {
+    QModelIndex index = model->index(row, 0);
+    if (!index.data(ChatMessageModel::IsUserRole).toBool()) {
+      texts.append(index.data().toString());
+    }
+  }
+  return texts;
+}
+
+QString TestAiChatDialog::lastAnswer() const {
+  QStringList texts = answers();
+  return texts.isEmpty() ? QString() : texts.last();
+}
+
+QPushButton* TestAiChatDialog::cancelButton() const {
+  return dialog->findChild<QPushButton*>("cancelButton");
+}
+
+// 回答分段到达时，气泡先显示已收到的部分
+void TestAiChatDialog::streamsAnswerIncrementally() {
+  server->enqueue(MockResponse::stream({"您好", "，这是", "流式回答"}, 300));
+  openDialog();
+  ask("介绍一下医院");
+
+  QTRY_COMPARE(lastAnswer(), QString("您好"));
+  QVERIFY(cancelButton()->isEnabled());
+  QTRY_COMPARE(lastAnswer(), QString("您好，这是流式回答"));
+  QTRY_VERIFY(!cancelButton()->isEnabled());
+}
+
+void TestAiChatDialog::sendsStreamingRequest() {
+  openDialog();
+  ask("介绍一下医院");
+  QTRY_COMPARE(lastAnswer(), QString("默认回答"));
+
+  QCOMPARE(server->requests().size(), 1);
+  QJsonObject body = QJsonDocument::fromJson(server->requests().first())
+                         .object();
+  QVERIFY(body["stream"].toBool());
+  QJsonArray messages = body["messages"].toArray();
+  QCOMPARE(messages.first().toObject()["role"].toString(), QString("system"));
+  QCOMPARE(messages.last().toObject()["content"].toString(),
+           QString("介绍一下医院"));
+}
+
+void TestAiChatDialog::parsesNonStreamingAnswer() {
+  QSettings("HospitalApp", "AppointmentSystem").setValue("aiStreaming", false);
+  server->enqueue(MockResponse::json("非流式回答"));
+  openDialog();
+  ask("介绍一下医院");
+
+  QTRY_COMPARE(lastAnswer(), QString("非流式回答"));
+  QJsonObject body = QJsonDocument::fromJson(server->requests().first())
+                         .object();
+  QVERIFY(!body["stream"].toBool());
+}
+
+void TestAiChatDialog::retriesServerErrors_data() {
+  QTest::addColumn<int>("status");
+  QTest::newRow("429") << 429;
+  QTest::newRow("500") << 500;
+  QTest::newRow("503") << 503;
+}
+
+// 尚未显示内容时 429/5xx 重试，重发的请求体与第一次相同
+void TestAiChatDialog::retriesServerErrors() {
+  QFETCH(int, status);
+  server->enqueue(MockResponse::error(status));
+  server->enqueue(MockResponse::stream({"重试成功"}));
+  openDialog();
+  ask("介绍一下医院");
+
+  QTRY_COMPARE(lastAnswer(), QString("重试成功"));
+  QCOMPARE(server->requests().size(), 2);
+  QCOMPARE(server->requests().at(1), server->requests().at(0));
+}
+
+void TestAiChatDialog::givesUpAfterMaxRetries() {
+  for (int i = 0; i < 3; ++i) server->enqueue(MockResponse::error(503));
+  openDialog();
+  ask("介绍一下医院");
+
+  QTRY_VERIFY(lastAnswer().startsWith("抱歉，发生了错误"));
+  QCOMPARE(server->requests().size(), 3);  // 首次 + 2 次重试
+  QVERIFY(!cancelButton()->isEnabled());
+}
+
+// 服务器没有给出 Retry-After 时按指数退避加随机抖动：第 n 次重试等待
+// [base/2, base]，base 从 500 ms 起每次翻倍
+void TestAiChatDialog::backsOffWithoutRetryAfter() {
+  server->enqueue(MockResponse::error(503, QByteArray()));
+  server->enqueue(MockResponse::error(503, QByteArray()));
+  server->enqueue(MockResponse::stream({"退避后成功"}));
+  openDialog();
+  ask("介绍一下医院");
+
+  QTRY_COMPARE_WITH_TIMEOUT(lastAnswer(), QString("退避后成功"), 5000);
+  QList<qint64> times = server->requestTimes();
+  QCOMPARE(times.size(), 3);
+  qint64 firstDelay = times[1] - times[0];
+  qint64 secondDelay = times[2] - times[1];
+  qDebug() << "退避间隔" << firstDelay << "ms，" << secondDelay << "ms";
+  QVERIFY2(firstDelay >= 250 && firstDelay <= 500 + kBackoffSlackMs,
+           qPrintable(QString("第一次重试间隔 %1 ms").arg(firstDelay)));
+  QVERIFY2(secondDelay >= 500 && secondDelay <= 1000 + kBackoffSlackMs,
+           qPrintable(QString("第二次重试间隔 %1 ms").arg(secondDelay)));
+}
+
+// 1 秒内没有收到数据即超时，按退避间隔重试
+void TestAiChatDialog::retriesAfterTimeout() {
+  server->enqueue(MockResponse::stalled());
+  server->enqueue(MockResponse::stream({"超时后成功"}));
+  openDialog();
+  ask("介绍一下医院");
+
+  QTRY_COMPARE_WITH_TIMEOUT(lastAnswer(), QString("超时后成功"), 5000);
+  QCOMPARE(server->requests().size(), 2);
+}
+
+void TestAiChatDialog::cancelsWaitingQuery() {
+  server->enqueue(MockResponse::stalled());
+  openDialog();
+  ask("介绍一下医院");
+  QTRY_COMPARE(server->requests().size(), 1);
+  QCOMPARE(lastAnswer(), QString("正在思考..."));
+
+  cancelButton()->click();
+  QTRY_COMPARE(lastAnswer(), QString("已取消。"));
+  QVERIFY(!cancelButton()->isEnabled());
+  QCOMPARE(server->requests().size(), 1);  // 取消不触发重试
+}
+
+void TestAiChatDialog::cancelKeepsPartialAnswer() {
+  server->enqueue(MockResponse::stream({"部分", "回答", "不会显示"}, 1000));
+  openDialog();
+  ask("介绍一下医院");
+  QTRY_COMPARE(lastAnswer(), QString("部分"));
+
+  cancelButton()->click();
+  QTRY_COMPARE(lastAnswer(), QString("部分\n（已取消）"));
+}
+
+// 两个提问同时进行，各自的回答写入各自的气泡
+void TestAiChatDialog::concurrentQueriesFillOwnBubbles() {
+  server->enqueue(MockResponse::stream({"回答", "一"}, 300));
+  server->enqueue(MockResponse::stream({"回答二"}));
+  openDialog();
+  ask("第一个问题");
+  ask("第二个问题");
+
+  QTRY_COMPARE(server->requests().size(), 2);
+  QTRY_VERIFY(!cancelButton()->isEnabled());
+  QStringList texts = answers();
+  texts.sort();
+  QCOMPARE(texts, QStringList() << QString("回答一") << QString("回答二"));
+}
+
+// 问题本身超出单次请求上限时不发送请求
+void TestAiChatDialog::rejectsOversizedQuestion() {
+  QSettings("HospitalApp", "AppointmentSystem")
+      .setValue("aiMaxRequestTokens", 500);
+  openDialog();
+  ask(QString(600, QChar(0x75BC)));  // 600 个“疼”
+
+  QVERIFY(lastAnswer().startsWith("问题过长"));
+  QTest::qWait(100);
+  QVERIFY(server->requests().isEmpty());
+}
+
+int main(int argc, char* argv[]) {
+  // 无显示环境（持续集成）下使用 offscreen 平台
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  // 测试模式下标准路径指向测试专用目录；应用配置（QSettings）再指定到
+  // 临时目录，测试结束即删除
+  QStandardPaths::setTestModeEnabled(true);
+  QTemporaryDir settingsDir;
+  QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope,
+                     settingsDir.path());
+  QSettings::setPath(QSettings::IniFormat, QSettings::UserScope,
+                     settingsDir.path());
+
+  QApplication app(argc, argv);
+  TestAiChatDialog test;
+  return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_aiChatDialog.moc"
@@ -0,0 +1,51 @@
+QT       += core gui widgets network concurrent testlib
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_aiChatDialog
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_aiChatDialog.cpp \
+    ../../aiChatDialog.cpp \
+    ../../aiContextBuilder.cpp \
+    ../../aiResponseCache.cpp \
+    ../../appointment.cpp \
+    ../../appointmentArchive.cpp \
+    ../../appointmentManager.cpp \
+    ../../availabilityIndex.cpp \
+    ../../bloomFilter.cpp \
+    ../../chatBubbleDelegate.cpp \
+    ../../chatMessageModel.cpp \
+    ../../conversationMemory.cpp \
+    ../../departmentRecommender.cpp \
+    ../../expert.cpp \
+    ../../expertManager.cpp \
+    ../../jsonImport.cpp \
+    ../../localIntentMatcher.cpp \
+    ../../sseParser.cpp
+
+HEADERS += \
+    ../../aiChatDialog.h \
+    ../../aiContextBuilder.h \
+    ../../aiResponseCache.h \
+    ../../appointment.h \
+    ../../appointmentArchive.h \
+    ../../appointmentManager.h \
+    ../../availabilityIndex.h \
+    ../../bloomFilter.h \
+    ../../chatBubbleDelegate.h \
+    ../../chatMessageModel.h \
+    ../../conversationMemory.h \
+    ../../departmentRecommender.h \
+    ../../expert.h \
+    ../../expertManager.h \
+    ../../jsonImport.h \
+    ../../localIntentMatcher.h \
+    ../../sseParser.h
+
+FORMS += ../../aiChatDialog.ui
+
+include(../common/mockAiServer.pri)
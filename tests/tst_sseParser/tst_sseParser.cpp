@@ -0,0 +1,82 @@
+#include <QtTest>
+
+#include "sseParser.h"
+
+class TestSseParser : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void parsesEvents();
+  void splitsAtAnyByte();
+  void joinsMultiLineData();
+  void ignoresCommentsAndOtherFields();
+  void stopsAtDone();
+  void resetClearsState();
+};
+
+static const QByteArray kStream =
+    "data: {\"n\":1}\r\n\r\n"
+    ": keep-alive\n\n"
+    "event: message\nid: 7\ndata: {\"n\":2}\n\n"
+    "data: 中文\n\n"
+    "data: [DONE]\n\n";
+
+void TestSseParser::parsesEvents() {
+  SseParser parser;
+  QStringList events = parser.feed(kStream);
+  QCOMPARE(events,
+           QStringList() << "{\"n\":1}" << "{\"n\":2}" << QString("中文"));
+  QVERIFY(parser.isDone());
+}
+
+// 网络分包可落在任意位置（包括 UTF-8 多字节字符与 \r\n 中间）
+void TestSseParser::splitsAtAnyByte() {
+  for (int split = 1; split < kStream.size(); ++split) {
+    SseParser parser;
+    QStringList events = parser.feed(kStream.left(split));
+    events += parser.feed(kStream.mid(split));
+    QCOMPARE(events.size(), 3);
+    QCOMPARE(events.last(), QString("中文"));
+    QVERIFY(parser.isDone());
+  }
+
+  SseParser parser;
+  QStringList events;
+  for (char byte : kStream) events += parser.feed(QByteArray(1, byte));
+  QCOMPARE(events.size(), 3);
+}
+
+void TestSseParser::joinsMultiLineData() {
+  SseParser parser;
+  QStringList events = parser.feed("data: 第一行\ndata:第二行\n\n");
+  QCOMPARE(events, QStringList() << QString("第一行\n第二行"));
+}
+
+void TestSseParser::ignoresCommentsAndOtherFields() {
+  SseParser parser;
+  QVERIFY(parser.feed(": ping\n\nretry: 1000\n\nevent: x\n\n").isEmpty());
+  QVERIFY(!parser.isDone());
+
+  // 未以空行结束的事件暂不返回
+  QVERIFY(parser.feed("data: 未完").isEmpty());
+  QCOMPARE(parser.feed("\n\n"), QStringList() << QString("未完"));
+}
+
+void TestSseParser::stopsAtDone() {
+  SseParser parser;
+  QVERIFY(parser.feed("data: [DONE]\n\n").isEmpty());
+  QVERIFY(parser.isDone());
+}
+
+void TestSseParser::resetClearsState() {
+  SseParser parser;
+  parser.feed("data: [DONE]\n\ndata: 残留");
+  QVERIFY(parser.isDone());
+  parser.reset();
+  QVERIFY(!parser.isDone());
+  QCOMPARE(parser.feed("data: 新的\n\n"), QStringList() << QString("新的"));
+}
+
+QTEST_APPLESS_MAIN(TestSseParser)
+
+#include "tst_sseParser.moc"
@@ -0,0 +1,15 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_sseParser
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_sseParser.cpp \
+    ../../sseParser.cpp
+
+HEADERS += ../../sseParser.h
@@ -0,0 +1,139 @@
+#include "timeSlotIndex.h"
+
+#include <QTime>
+#include <algorithm>
+
+static bool rangeStartsBefore(const TimeSlotRange& a, const TimeSlotRange& b) {
+  if (a.startMinute != b.startMinute) return a.startMinute < b.startMinute;
+  return a.endMinute < b.endMinute;
+}
+
+bool TimeSlotRange::parse(const QString& text, TimeSlotRange* out) {
+  QStringList parts = text.split("：");
+  if (parts.size() != 2) return false;
+
+  QStringList timeParts = parts[1].trimmed().split("-");
+  if (timeParts.size() != 2) return false;
+
+  QTime start = QTime::fromString(timeParts[0].trimmed(), "HH:mm");
+  QTime end = QTime::fromString(timeParts[1].trimmed(), "HH:mm");
+  if (!start.isValid() || !end.isValid()) return false;
+
+  out->dayKey = parts[0].trimmed();
+  out->startMinute = start.hour() * 60 + start.minute();
+  out->endMinute = end.hour() * 60 + end.minute();
+  out->text = text;
+  return true;
+}
+
+QString TimeSlotRange::format(const QString& dayKey, int startMinute,
+                              int endMinute) {
+  return QString("%1：%2-%3")
+      .arg(dayKey)
+      .arg(QTime(startMinute / 60, startMinute % 60).toString("HH:mm"))
+      .arg(QTime(endMinute / 60, endMinute % 60).toString("HH:mm"));
+}
+
+TimeSlotIndex::TimeSlotIndex() : builtGeneration(0) {}
+
+void TimeSlotIndex::build(const QStringList& serviceTimes) {
+  trees.clear();
+  for (const QString& slot : serviceTimes) {
+    TimeSlotRange range;
+    if (TimeSlotRange::parse(slot, &range)) {
+      trees[range.dayKey].ranges.append(range);
+    }
+  }
+
+  for (auto it = trees.begin(); it != trees.end(); ++it) {
+    DayTree& tree = it.value();
+    std::sort(tree.ranges.begin(), tree.ranges.end(), rangeStartsBefore);
+    tree.maxEnd.fill(0, tree.ranges.size());
+    buildMaxEnd(tree, 0, tree.ranges.size());
+  }
+  builtGeneration = 0;
+}
+
+void TimeSlotIndex::ensureBuilt(const Expert& expert) {
+  if (builtGeneration == expert.scheduleGeneration) return;
+  build(expert.serviceTimes);
+  builtGeneration = expert.scheduleGeneration;
+}
+
+QStringList TimeSlotIndex::findOverlaps(const TimeSlotRange& range) const {
+  QStringList result;
+  auto it = trees.constFind(range.dayKey);
+  if (it != trees.constEnd()) {
+    query(it.value(), 0, it.value().ranges.size(), range.startMinute,
+          range.endMinute, &result);
+  }
+  return result;
+}
+
+QList<TimeSlotIndex::MergeGroup> TimeSlotIndex::planMerges(
+    const QStringList& serviceTimes) {
+  QHash<QString, QVector<TimeSlotRange>> byDay;
+  for (const QString& slot : serviceTimes) {
+    TimeSlotRange range;
+    if (TimeSlotRange::parse(slot, &range)) {
+      byDay[range.dayKey].append(range);
+    }
+  }
+
+  // 每天按起点排序后扫描一遍，重叠（不含首尾相接）的时间段归为一组
+  QList<MergeGroup> groups;
+  for (auto it = byDay.begin(); it != byDay.end(); ++it) {
+    QVector<TimeSlotRange>& ranges = it.value();
+    std::sort(ranges.begin(), ranges.end(), rangeStartsBefore);
+
+    int i = 0;
+    while (i < ranges.size()) {
+      MergeGroup group;
+      group.sources.append(ranges[i].text);
+      int groupStart = ranges[i].startMinute;
+      int groupEnd = ranges[i].endMinute;
+
+      int j = i + 1;
+      while (j < ranges.size() && ranges[j].startMinute < groupEnd) {
+        group.sources.append(ranges[j].text);
+        groupEnd = qMax(groupEnd, ranges[j].endMinute);
+        ++j;
+      }
+
+      if (group.sources.size() > 1) {
+        group.merged = TimeSlotRange::format(it.key(), groupStart, groupEnd);
+        groups.append(group);
+      }
+      i = j;
+    }
+  }
+  return groups;
+}
+
+int TimeSlotIndex::buildMaxEnd(DayTree& tree, int lo, int hi) {
+  if (lo >= hi) return -1;
+  int mid = (lo + hi) / 2;
+  int maxEnd = tree.ranges[mid].endMinute;
+  maxEnd = qMax(maxEnd, buildMaxEnd(tree, lo, mid));
+  maxEnd = qMax(maxEnd, buildMaxEnd(tree, mid + 1, hi));
+  tree.maxEnd[mid] = maxEnd;
+  return maxEnd;
+}
+
+void TimeSlotIndex::query(const DayTree& tree, int lo, int hi, int start,
+                          int end, QStringList* out) {
+  if (lo >= hi) return;
+  int mid = (lo + hi) / 2;
+
+  // 子树中所有时间段都在 start 之前结束，不可能重叠
+  if (tree.maxEnd[mid] <= start) return;
+
+  query(tree, lo, mid, start, end, out);
+
+  // 中点及右子树的起点均不早于 end，不可能重叠
+  const TimeSlotRange& range = tree.ranges[mid];
+  if (range.startMinute >= end) return;
+
+  if (range.endMinute > start) out->append(range.text);
+  query(tree, mid + 1, hi, start, end, out);
+}
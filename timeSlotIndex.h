@@ -0,0 +1,59 @@
+#ifndef TIMESLOTINDEX_H
+#define TIMESLOTINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "expert.h"
+
+// 解析后的服务时间段，如 "周一：09:00-12:00" 或 "05-01：14:00-17:00"
+struct TimeSlotRange {
+  QString dayKey;       // 冒号前的部分："周一" 或 "MM-dd"
+  int startMinute = 0;  // 自零点起的分钟数
+  int endMinute = 0;
+  QString text;  // 原始时间段字符串
+
+  static bool parse(const QString& text, TimeSlotRange* out);
+  static QString format(const QString& dayKey, int startMinute,
+                        int endMinute);
+};
+
+// 时间段区间索引：按星期/日期分组，每组为按起点排序的隐式平衡区间树
+// （每个节点记录子树最大终点），重叠查询为 O(log n + k)。
+class TimeSlotIndex {
+ public:
+  // 一组互相重叠、需要合并为一个时间段的原时间段
+  struct MergeGroup {
+    QStringList sources;
+    QString merged;
+  };
+
+  TimeSlotIndex();
+
+  void build(const QStringList& serviceTimes);
+  // 专家排班代号变化时才重建
+  void ensureBuilt(const Expert& expert);
+  // 返回与给定时间段（同一星期/日期）重叠的已有时间段
+  QStringList findOverlaps(const TimeSlotRange& range) const;
+
+  // 计算将每天内互相重叠的时间段合并为并集的方案
+  static QList<MergeGroup> planMerges(const QStringList& serviceTimes);
+
+ private:
+  struct DayTree {
+    QVector<TimeSlotRange> ranges;  // 按起点排序
+    QVector<int> maxEnd;            // 以该下标为根的子树最大终点
+  };
+
+  QHash<QString, DayTree> trees;
+  quint64 builtGeneration;
+
+  static int buildMaxEnd(DayTree& tree, int lo, int hi);
+  static void query(const DayTree& tree, int lo, int hi, int start, int end,
+                    QStringList* out);
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "visitHistory.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSet>
+#include <algorithm>
+
+#include "appointmentArchive.h"
+#include "appointmentManager.h"
+
+VisitHistory::VisitHistory(const AppointmentManager* appointmentMgr,
+                           const AppointmentArchive* archive)
+    : appointmentManager(appointmentMgr), archive(archive) {}
+
+QList<Appointment> VisitHistory::lookup(const QString& idNumber,
+                                        qint64* elapsedMs) const {
+  QElapsedTimer timer;
+  timer.start();
+
+  QList<Appointment> visits;
+  if (!idNumber.isEmpty()) {
+    // 预约数据在前：归档与分区重叠（归档后尚未移除）时以预约数据为准
+    QList<Appointment> candidates;
+    if (appointmentManager) {
+      candidates = appointmentManager->visitsByIdNumber(idNumber);
+    }
+    if (archive) candidates.append(archive->visitsByIdNumber(idNumber));
+
+    QSet<QString> seen;
+    for (const Appointment& candidate : candidates) {
+      QString key = AppointmentManager::naturalKey(candidate);
+      if (seen.contains(key)) continue;
+      seen.insert(key);
+      visits.append(candidate);
+    }
+    std::stable_sort(visits.begin(), visits.end(),
+                     [](const Appointment& a, const Appointment& b) {
+                       return a.appointmentDate > b.appointmentDate;
+                     });
+  }
+
+  if (elapsedMs) *elapsedMs = timer.elapsed();
+  qDebug() << "查询就诊历史" << visits.size() << "条，耗时" << timer.elapsed()
+           << "ms";
+  return visits;
+}
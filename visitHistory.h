@@ -0,0 +1,29 @@
+#ifndef VISITHISTORY_H
+#define VISITHISTORY_H
+
+#include <QList>
+#include <QString>
+
+#include "appointment.h"
+
+class AppointmentArchive;
+class AppointmentManager;
+
+// 患者就诊历史：按身份证号合并预约数据（内存 + 未载入的历史分区）与
+// 归档中的记录。分区与归档段各自带身份证号过滤器/索引，不含该患者的
+// 段不做任何磁盘读取
+class VisitHistory {
+ public:
+  VisitHistory(const AppointmentManager* appointmentMgr,
+               const AppointmentArchive* archive);
+
+  // 全部就诊记录（按自然键去重，日期由近及远）；elapsedMs 返回查询耗时
+  QList<Appointment> lookup(const QString& idNumber,
+                            qint64* elapsedMs = nullptr) const;
+
+ private:
+  const AppointmentManager* appointmentManager;
+  const AppointmentArchive* archive;  // 可为空（未启用归档）
+};
+
+#endif